@@ -0,0 +1,245 @@
+#include "arena.h"
+#include "stdlib.h"
+#include "string.h"
+
+#define ARENA_DEFAULT_CHUNK_SIZE (64 * 1024)
+#define ARENA_ALIGNMENT 16
+#define ARENA_SIZE_CLASSES 16
+// Larger blocks are recycled only when their size is a power of two, as the bucket arrays of growing tables are
+#define ARENA_LARGE_CLASSES 24
+
+typedef struct ArenaChunk_t
+{
+	struct ArenaChunk_t* next;
+	size_t size;
+	size_t used;
+} *ArenaChunk;
+
+typedef struct ArenaFreeBlock_t
+{
+	struct ArenaFreeBlock_t* next;
+} *ArenaFreeBlock;
+
+struct Arena_t
+{
+	ArenaChunk chunks;
+	size_t chunkSize;
+	// freeBlocks[i] holds released blocks of (i + 1) * ARENA_ALIGNMENT bytes
+	ArenaFreeBlock freeBlocks[ARENA_SIZE_CLASSES];
+	// largeFreeBlocks[i] holds released blocks of (ARENA_SIZE_CLASSES * ARENA_ALIGNMENT) << (i + 1) bytes
+	ArenaFreeBlock largeFreeBlocks[ARENA_LARGE_CLASSES];
+};
+
+static size_t alignSize(size_t size)
+{
+	return (size + ARENA_ALIGNMENT - 1) & ~((size_t)ARENA_ALIGNMENT - 1);
+}
+
+// The free list of an aligned size, or NULL if blocks of that size are not recycled
+static ArenaFreeBlock* arenaGetFreeList(Arena arena, size_t size)
+{
+	size_t sizeClass = size / ARENA_ALIGNMENT - 1;
+	if (sizeClass < ARENA_SIZE_CLASSES)
+	{
+		return &arena->freeBlocks[sizeClass];
+	}
+
+	if ((size & (size - 1)) != 0)
+	{
+		return NULL;
+	}
+	size_t largeSize = (size_t)ARENA_SIZE_CLASSES * ARENA_ALIGNMENT * 2;
+	for (int i = 0; i < ARENA_LARGE_CLASSES; i++, largeSize *= 2)
+	{
+		if (largeSize == size)
+		{
+			return &arena->largeFreeBlocks[i];
+		}
+	}
+
+	return NULL;
+}
+
+static char* chunkGetData(ArenaChunk chunk)
+{
+	return (char*)chunk + alignSize(sizeof(*chunk));
+}
+
+static ArenaChunk arenaAddChunk(Arena arena, size_t minimal_size)
+{
+	size_t size = arena->chunkSize;
+	if (size < minimal_size)
+	{
+		size = minimal_size;
+	}
+
+	ArenaChunk chunk = malloc(alignSize(sizeof(*chunk)) + size);
+	if (chunk == NULL)
+	{
+		return NULL;
+	}
+
+	chunk->size = size;
+	chunk->used = 0;
+	chunk->next = arena->chunks;
+	arena->chunks = chunk;
+
+	return chunk;
+}
+
+Arena arenaCreate(size_t chunk_size)
+{
+	Arena arena = malloc(sizeof(*arena));
+	if (arena == NULL)
+	{
+		return NULL;
+	}
+
+	arena->chunks = NULL;
+	arena->chunkSize = chunk_size == 0 ? ARENA_DEFAULT_CHUNK_SIZE : alignSize(chunk_size);
+	for (int i = 0; i < ARENA_SIZE_CLASSES; i++)
+	{
+		arena->freeBlocks[i] = NULL;
+	}
+	for (int i = 0; i < ARENA_LARGE_CLASSES; i++)
+	{
+		arena->largeFreeBlocks[i] = NULL;
+	}
+
+	return arena;
+}
+
+void arenaDestroy(Arena arena)
+{
+	if (arena == NULL)
+	{
+		return;
+	}
+
+	ArenaChunk chunk = arena->chunks;
+	while (chunk != NULL)
+	{
+		ArenaChunk next = chunk->next;
+		free(chunk);
+		chunk = next;
+	}
+
+	free(arena);
+}
+
+void* arenaAlloc(Arena arena, size_t size)
+{
+	if (arena == NULL)
+	{
+		return malloc(size);
+	}
+
+	size = alignSize(size == 0 ? 1 : size);
+
+	ArenaFreeBlock* freeList = arenaGetFreeList(arena, size);
+	if (freeList != NULL && *freeList != NULL)
+	{
+		ArenaFreeBlock block = *freeList;
+		*freeList = block->next;
+		return block;
+	}
+
+	ArenaChunk chunk = arena->chunks;
+	if (chunk == NULL || chunk->size - chunk->used < size)
+	{
+		chunk = arenaAddChunk(arena, size);
+		if (chunk == NULL)
+		{
+			return NULL;
+		}
+	}
+
+	void* block = chunkGetData(chunk) + chunk->used;
+	chunk->used += size;
+
+	return block;
+}
+
+void arenaRelease(Arena arena, void* block, size_t size)
+{
+	if (arena == NULL)
+	{
+		free(block);
+		return;
+	}
+
+	if (block == NULL)
+	{
+		return;
+	}
+
+	// Blocks of sizes which are not recycled are simply kept until the arena is destroyed
+	ArenaFreeBlock* freeList = arenaGetFreeList(arena, alignSize(size == 0 ? 1 : size));
+	if (freeList != NULL)
+	{
+		ArenaFreeBlock freeBlock = block;
+		freeBlock->next = *freeList;
+		*freeList = freeBlock;
+	}
+}
+
+bool arenaReserveRoom(Arena arena, size_t size, int count)
+{
+	if (arena == NULL || count <= 0)
+	{
+		return true;
+	}
+
+	// Every block may take up to ARENA_ALIGNMENT - 1 bytes more than asked for
+	size_t room = alignSize(size) + (size_t)count * (ARENA_ALIGNMENT - 1);
+	ArenaChunk chunk = arena->chunks;
+	if (chunk == NULL || chunk->size - chunk->used < room)
+	{
+		chunk = arenaAddChunk(arena, room);
+		if (chunk == NULL)
+		{
+			return false;
+		}
+	}
+
+	// Written once, so the allocations it is reserved for do not fault its pages in
+	memset(chunkGetData(chunk) + chunk->used, 0, room);
+	return true;
+}
+
+bool arenaReserve(Arena arena, size_t size, int count)
+{
+	if (arena == NULL || count <= 0)
+	{
+		return true;
+	}
+
+	size = alignSize(size == 0 ? 1 : size);
+	ArenaFreeBlock* freeList = arenaGetFreeList(arena, size);
+	if (freeList == NULL)
+	{
+		return arenaReserveRoom(arena, size * count, count);
+	}
+
+	ArenaChunk chunk = arena->chunks;
+	if (chunk == NULL || chunk->size - chunk->used < size * count)
+	{
+		chunk = arenaAddChunk(arena, size * count);
+		if (chunk == NULL)
+		{
+			return false;
+		}
+	}
+
+	// Carved from the end of the run, so the free list hands the blocks out in address order
+	char* data = chunkGetData(chunk) + chunk->used;
+	chunk->used += size * count;
+	for (int i = count - 1; i >= 0; i--)
+	{
+		ArenaFreeBlock block = (ArenaFreeBlock)(data + i * size);
+		block->next = *freeList;
+		*freeList = block;
+	}
+
+	return true;
+}
@@ -0,0 +1,94 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+* Bump Arena
+*
+* Hands out memory from large region chunks grabbed from the heap. Blocks are never returned
+* to the heap individually; a released block is kept on a free list and recycled by a later
+* allocation of the same size, and all of the memory is released at once by arenaDestroy.
+* Blocks of up to 256 bytes are always recycled, larger ones only when their size is a power of two.
+*
+* Every allocation function accepts a NULL arena, in which case the block is taken from
+* (and released to) the heap. This lets containers support both modes with one code path.
+*
+* The following functions are available:
+*   arenaCreate		- Creates a new empty arena
+*   arenaDestroy	- Releases every region chunk of the arena
+*   arenaAlloc		- Allocates a block of memory inside the arena
+*   arenaRelease	- Returns a block to the arena for recycling
+*   arenaReserve	- Sets blocks of one size aside for later allocations
+*   arenaReserveRoom	- Makes room for later allocations of any size
+*/
+
+/** Type for defining the arena */
+typedef struct Arena_t* Arena;
+
+/**
+* arenaCreate: Allocates a new empty arena.
+*
+* @param chunk_size - The minimal size in bytes of every region chunk the arena takes from the heap.
+*		If 0 is sent a default size is used.
+* @return
+* 	NULL - if allocation failed.
+* 	A new Arena in case of success.
+*/
+Arena arenaCreate(size_t chunk_size);
+
+/**
+* arenaDestroy: Deallocates an existing arena and every block that was allocated inside it.
+*
+* @param arena - Target arena to be deallocated. If arena is NULL nothing will be done
+*/
+void arenaDestroy(Arena arena);
+
+/**
+* arenaAlloc: Allocates a block of memory inside the arena.
+* The block is aligned for any object type and stays valid until it is released or the arena is destroyed.
+*
+* @param arena - The arena to allocate from. If arena is NULL the block is allocated with malloc.
+* @param size - The size of the block in bytes.
+* @return
+* 	NULL if a memory allocation failed.
+* 	The new block otherwise.
+*/
+void* arenaAlloc(Arena arena, size_t size);
+
+/**
+* arenaRelease: Returns a block allocated by arenaAlloc to the arena, so that a later
+* allocation of the same size can reuse it. The memory itself is only given back to the heap
+* when the arena is destroyed.
+*
+* @param arena - The arena the block was allocated from. If arena is NULL the block is freed with free.
+* @param block - The block to release. If block is NULL nothing will be done.
+* @param size - The size that was requested when the block was allocated.
+*/
+void arenaRelease(Arena arena, void* block, size_t size);
+
+/**
+* arenaReserve: Makes sure the next count allocations of size bytes are served without taking memory from the heap.
+* Blocks of a recycled size are carved right away and kept for allocations of their size, so allocations of other
+* sizes cannot use them up; other sizes get room as in arenaReserveRoom.
+*
+* @param arena - The arena to reserve in. If arena is NULL nothing will be done.
+* @return
+* 	false if a memory allocation failed, in which case nothing is reserved.
+* 	true otherwise.
+*/
+bool arenaReserve(Arena arena, size_t size, int count);
+
+/**
+* arenaReserveRoom: Makes sure count allocations whose sizes add up to size bytes are served without taking memory
+* from the heap, as long as no other allocation is made in between. Blocks released to the arena do not count.
+*
+* @param arena - The arena to reserve in. If arena is NULL nothing will be done.
+* @return
+* 	false if a memory allocation failed, in which case nothing is reserved.
+* 	true otherwise.
+*/
+bool arenaReserveRoom(Arena arena, size_t size, int count);
+
+#endif /* ARENA_H */
@@ -0,0 +1,337 @@
+#include "async_event_manager.h"
+#include "command_ring.h"
+#include "stdlib.h"
+#include "string.h"
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#endif
+
+// Names shorter than this are copied into the command itself, longer ones are copied to the heap
+#define AEM_INLINE_NAME_SIZE 32
+// The owner pops this many commands at a time
+#define AEM_BATCH_SIZE 256
+// Times the owner looks at an empty ring again before it goes to sleep
+#define AEM_IDLE_SPINS 64
+
+typedef enum AsyncCommandType_t {
+	AEM_ADD_EVENT,
+	AEM_ADD_MEMBER_TO_EVENT
+} AsyncCommandType;
+
+/** A submitted call, copied into the ring */
+typedef struct AsyncCommand_t
+{
+	AsyncCommandType type;
+	int first;
+	int second;
+	int day;
+	int month;
+	int year;
+	// NULL when the name fits in name
+	char* longName;
+	char name[AEM_INLINE_NAME_SIZE];
+	AsyncEventManagerDone done;
+	void* context;
+} AsyncCommand;
+
+struct AsyncEventManager_t
+{
+	// NULL once a command ran out of memory and the event manager destroyed itself
+	EventManager em;
+	CommandRing ring;
+#ifndef _WIN32
+	pthread_t owner;
+	pthread_mutex_t mutex;
+	// Signalled by producers when the owner sleeps, and by destroyAsyncEventManager
+	pthread_cond_t wake;
+	// Broadcast by the owner after every batch, for aemFlush
+	pthread_cond_t applied;
+	atomic_bool sleeping;
+	bool stopping;
+	// Number of commands applied, guarded by mutex
+	unsigned long long appliedCount;
+#endif
+};
+
+static void aemApplyCommand(AsyncEventManager aem, AsyncCommand* command)
+{
+	EventManagerResult result = EM_NULL_ARGUMENT;
+	if (aem->em != NULL && command->type == AEM_ADD_EVENT)
+	{
+		Date date = dateCreate(command->day, command->month, command->year);
+		char* name = command->longName != NULL ? command->longName : command->name;
+		result = date == NULL ? EM_OUT_OF_MEMORY : emAddEventByDate(aem->em, name, date, command->first);
+		dateDestroy(date);
+		if (date != NULL && result == EM_OUT_OF_MEMORY)
+		{
+			aem->em = NULL;
+		}
+	}
+	else if (aem->em != NULL && command->type == AEM_ADD_MEMBER_TO_EVENT)
+	{
+		result = emAddMemberToEvent(aem->em, command->first, command->second);
+		if (result == EM_OUT_OF_MEMORY)
+		{
+			aem->em = NULL;
+		}
+	}
+	free(command->longName);
+
+	if (command->done != NULL)
+	{
+		command->done(result, command->context);
+	}
+}
+
+#ifdef _WIN32
+
+AsyncEventManager createAsyncEventManager(EventManager em, int capacity)
+{
+	if (em == NULL || capacity <= 0)
+	{
+		return NULL;
+	}
+
+	AsyncEventManager aem = malloc(sizeof(*aem));
+	if (aem == NULL)
+	{
+		return NULL;
+	}
+
+	aem->em = em;
+	aem->ring = NULL;
+	return aem;
+}
+
+void destroyAsyncEventManager(AsyncEventManager aem)
+{
+	free(aem);
+}
+
+static EventManagerResult aemSubmit(AsyncEventManager aem, AsyncCommand* command)
+{
+	// Without an owner thread the command is applied right away
+	aemApplyCommand(aem, command);
+	return EM_SUCCESS;
+}
+
+EventManagerResult aemFlush(AsyncEventManager aem)
+{
+	return aem == NULL ? EM_NULL_ARGUMENT : EM_SUCCESS;
+}
+
+#else
+
+static void aemFinishBatch(AsyncEventManager aem, int count)
+{
+	pthread_mutex_lock(&aem->mutex);
+	aem->appliedCount += count;
+	pthread_cond_broadcast(&aem->applied);
+	pthread_mutex_unlock(&aem->mutex);
+}
+
+static void* aemOwner(void* argument)
+{
+	AsyncEventManager aem = argument;
+	AsyncCommand batch[AEM_BATCH_SIZE];
+	int idleSpins = 0;
+	while (true)
+	{
+		int count = commandRingPopMany(aem->ring, batch, AEM_BATCH_SIZE);
+		if (count == 0 && idleSpins < AEM_IDLE_SPINS)
+		{
+			idleSpins++;
+			sched_yield();
+			continue;
+		}
+
+		if (count == 0)
+		{
+			// A producer which pushes after this store sees it and signals the owner awake.
+			// The element of one which pushed before it is found by the pop
+			pthread_mutex_lock(&aem->mutex);
+			atomic_store(&aem->sleeping, true);
+			atomic_thread_fence(memory_order_seq_cst);
+			count = commandRingPopMany(aem->ring, batch, AEM_BATCH_SIZE);
+			bool stop = count == 0 && aem->stopping;
+			if (count == 0 && !stop)
+			{
+				pthread_cond_wait(&aem->wake, &aem->mutex);
+			}
+			atomic_store(&aem->sleeping, false);
+			pthread_mutex_unlock(&aem->mutex);
+			if (stop)
+			{
+				break;
+			}
+		}
+
+		idleSpins = 0;
+		for (int i = 0; i < count; i++)
+		{
+			aemApplyCommand(aem, &batch[i]);
+		}
+		if (count > 0)
+		{
+			aemFinishBatch(aem, count);
+		}
+	}
+
+	return NULL;
+}
+
+AsyncEventManager createAsyncEventManager(EventManager em, int capacity)
+{
+	if (em == NULL || capacity <= 0)
+	{
+		return NULL;
+	}
+
+	AsyncEventManager aem = malloc(sizeof(*aem));
+	CommandRing ring = commandRingCreate(capacity, sizeof(AsyncCommand));
+	if (aem == NULL || ring == NULL)
+	{
+		free(aem);
+		commandRingDestroy(ring);
+		return NULL;
+	}
+
+	aem->em = em;
+	aem->ring = ring;
+	aem->stopping = false;
+	aem->appliedCount = 0;
+	atomic_init(&aem->sleeping, false);
+	pthread_mutex_init(&aem->mutex, NULL);
+	pthread_cond_init(&aem->wake, NULL);
+	pthread_cond_init(&aem->applied, NULL);
+
+	if (pthread_create(&aem->owner, NULL, aemOwner, aem) != 0)
+	{
+		pthread_cond_destroy(&aem->applied);
+		pthread_cond_destroy(&aem->wake);
+		pthread_mutex_destroy(&aem->mutex);
+		commandRingDestroy(ring);
+		free(aem);
+		return NULL;
+	}
+
+	return aem;
+}
+
+void destroyAsyncEventManager(AsyncEventManager aem)
+{
+	if (aem == NULL)
+	{
+		return;
+	}
+
+	// The owner only stops once the ring is empty, so every submitted command is applied
+	pthread_mutex_lock(&aem->mutex);
+	aem->stopping = true;
+	pthread_cond_signal(&aem->wake);
+	pthread_mutex_unlock(&aem->mutex);
+	pthread_join(aem->owner, NULL);
+
+	pthread_cond_destroy(&aem->applied);
+	pthread_cond_destroy(&aem->wake);
+	pthread_mutex_destroy(&aem->mutex);
+	commandRingDestroy(aem->ring);
+	free(aem);
+}
+
+static EventManagerResult aemSubmit(AsyncEventManager aem, AsyncCommand* command)
+{
+	if (!commandRingPush(aem->ring, command))
+	{
+		free(command->longName);
+		return EM_ERROR;
+	}
+
+	atomic_thread_fence(memory_order_seq_cst);
+	if (atomic_load(&aem->sleeping))
+	{
+		pthread_mutex_lock(&aem->mutex);
+		pthread_cond_signal(&aem->wake);
+		pthread_mutex_unlock(&aem->mutex);
+	}
+
+	return EM_SUCCESS;
+}
+
+EventManagerResult aemFlush(AsyncEventManager aem)
+{
+	if (aem == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	unsigned long long submitted = commandRingGetPushed(aem->ring);
+	pthread_mutex_lock(&aem->mutex);
+	while (aem->appliedCount < submitted)
+	{
+		pthread_cond_wait(&aem->applied, &aem->mutex);
+	}
+	pthread_mutex_unlock(&aem->mutex);
+
+	return EM_SUCCESS;
+}
+
+#endif
+
+EventManagerResult aemAddEventByDate(AsyncEventManager aem, const char* event_name, Date date, int event_id,
+	AsyncEventManagerDone done, void* context)
+{
+	if (aem == NULL || event_name == NULL || date == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	AsyncCommand command;
+	command.type = AEM_ADD_EVENT;
+	command.first = event_id;
+	command.second = 0;
+	dateGet(date, &command.day, &command.month, &command.year);
+	command.done = done;
+	command.context = context;
+
+	size_t length = strlen(event_name);
+	command.longName = NULL;
+	if (length < AEM_INLINE_NAME_SIZE)
+	{
+		memcpy(command.name, event_name, length + 1);
+	}
+	else
+	{
+		command.longName = malloc(length + 1);
+		if (command.longName == NULL)
+		{
+			return EM_OUT_OF_MEMORY;
+		}
+		memcpy(command.longName, event_name, length + 1);
+	}
+
+	return aemSubmit(aem, &command);
+}
+
+EventManagerResult aemAddMemberToEvent(AsyncEventManager aem, int member_id, int event_id,
+	AsyncEventManagerDone done, void* context)
+{
+	if (aem == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	AsyncCommand command;
+	command.type = AEM_ADD_MEMBER_TO_EVENT;
+	command.first = member_id;
+	command.second = event_id;
+	command.longName = NULL;
+	command.name[0] = '\0';
+	command.done = done;
+	command.context = context;
+
+	return aemSubmit(aem, &command);
+}
@@ -0,0 +1,87 @@
+#ifndef ASYNC_EVENT_MANAGER_H
+#define ASYNC_EVENT_MANAGER_H
+
+#include "event_manager.h"
+
+/**
+* Asynchronous Event Manager Front-End
+*
+* Lets any number of threads submit changes to an event manager without waiting for them and without taking a lock.
+* Every submitted change is copied as a command into a bounded lock-free ring, and one owner thread drains the ring
+* in batches and applies the commands to the event manager in the order they were submitted.
+* Once a command is applied, its done function is called on the owner thread with the result of the change.
+*
+* While the front-end runs, the owner thread is the only one changing the event manager. Other threads may still
+* call the event manager directly if it was created with EM_OPTION_THREAD_SAFE.
+* Where POSIX threads are not available there is no owner thread, and every command is applied by the submitting
+* thread before the submit returns.
+*
+* The following functions are available:
+*   createAsyncEventManager	- Starts a front-end with its owner thread for an event manager
+*   destroyAsyncEventManager	- Applies the remaining commands and stops the owner thread
+*   aemAddEventByDate		- Submits an emAddEventByDate call
+*   aemAddMemberToEvent		- Submits an emAddMemberToEvent call
+*   aemFlush			- Waits until every command submitted so far is applied
+*/
+
+/** Type for defining the asynchronous front-end */
+typedef struct AsyncEventManager_t* AsyncEventManager;
+
+/**
+* Called on the owner thread once a command is applied, with the result of the event manager call and the context
+* given when the command was submitted. It must not submit commands or call aemFlush.
+*/
+typedef void (*AsyncEventManagerDone)(EventManagerResult result, void* context);
+
+/**
+* createAsyncEventManager: Starts a front-end for an event manager. The event manager is not owned by the front-end,
+* and must outlive it.
+*
+* @param capacity - The number of commands which can wait in the ring. Rounded up to a power of 2.
+* @return
+* 	NULL - if em is NULL, capacity is not positive, an allocation failed or the owner thread could not be started.
+* 	A new AsyncEventManager in case of success.
+*/
+AsyncEventManager createAsyncEventManager(EventManager em, int capacity);
+
+/**
+* destroyAsyncEventManager: Applies the commands still in the ring, stops the owner thread and deallocates the
+* front-end. No submit may be running or made afterwards.
+*
+* @param aem - Target front-end to be deallocated. If aem is NULL nothing will be done
+*/
+void destroyAsyncEventManager(AsyncEventManager aem);
+
+/**
+* aemAddEventByDate: Submits emAddEventByDate(em, event_name, date, event_id). The name and the date are copied,
+* so they may be freed once this returns.
+*
+* @param done - Called with the result of emAddEventByDate once it was applied, with context. May be NULL.
+* 		If emAddEventByDate runs out of memory the event manager is destroyed, as usual, and every later command
+* 		gets EM_NULL_ARGUMENT.
+* @return
+* 	EM_NULL_ARGUMENT if aem, event_name or date is NULL.
+* 	EM_OUT_OF_MEMORY if a long name could not be copied. Nothing is submitted.
+* 	EM_ERROR if the ring is full. Nothing is submitted, and the call can be repeated once the owner caught up.
+* 	EM_SUCCESS if the command was submitted.
+*/
+EventManagerResult aemAddEventByDate(AsyncEventManager aem, const char* event_name, Date date, int event_id,
+    AsyncEventManagerDone done, void* context);
+
+/**
+* aemAddMemberToEvent: Submits emAddMemberToEvent(em, member_id, event_id). Same results as aemAddEventByDate,
+* except for EM_OUT_OF_MEMORY.
+*/
+EventManagerResult aemAddMemberToEvent(AsyncEventManager aem, int member_id, int event_id,
+    AsyncEventManagerDone done, void* context);
+
+/**
+* aemFlush: Returns once every command submitted before the call was applied and its done function returned.
+*
+* @return
+* 	EM_NULL_ARGUMENT if aem is NULL.
+* 	EM_SUCCESS otherwise.
+*/
+EventManagerResult aemFlush(AsyncEventManager aem);
+
+#endif /* ASYNC_EVENT_MANAGER_H */
@@ -0,0 +1,528 @@
+#include "avl_tree.h"
+#include "stdbool.h"
+#include "stdlib.h"
+
+struct AvlNode_t
+{
+	AvlElement element;
+	AvlNode left;
+	AvlNode right;
+	AvlNode parent;
+	int height;
+	// Number of nodes in the subtree rooted at this node
+	int size;
+};
+
+struct AvlTree_t
+{
+	AvlNode root;
+	Arena arena;
+	CompareAvlElements compareElements;
+};
+
+static int nodeHeight(AvlNode node)
+{
+	return node == NULL ? 0 : node->height;
+}
+
+static int nodeSize(AvlNode node)
+{
+	return node == NULL ? 0 : node->size;
+}
+
+static void nodeUpdate(AvlNode node)
+{
+	int leftHeight = nodeHeight(node->left);
+	int rightHeight = nodeHeight(node->right);
+	node->height = (leftHeight > rightHeight ? leftHeight : rightHeight) + 1;
+	node->size = nodeSize(node->left) + nodeSize(node->right) + 1;
+}
+
+static void replaceChild(AvlTree tree, AvlNode parent, AvlNode oldChild, AvlNode newChild)
+{
+	if (parent == NULL)
+	{
+		tree->root = newChild;
+	}
+	else if (parent->left == oldChild)
+	{
+		parent->left = newChild;
+	}
+	else
+	{
+		parent->right = newChild;
+	}
+
+	if (newChild != NULL)
+	{
+		newChild->parent = parent;
+	}
+}
+
+static AvlNode rotateLeft(AvlTree tree, AvlNode node)
+{
+	AvlNode pivot = node->right;
+	replaceChild(tree, node->parent, node, pivot);
+
+	node->right = pivot->left;
+	if (pivot->left != NULL)
+	{
+		pivot->left->parent = node;
+	}
+
+	pivot->left = node;
+	node->parent = pivot;
+
+	nodeUpdate(node);
+	nodeUpdate(pivot);
+	return pivot;
+}
+
+static AvlNode rotateRight(AvlTree tree, AvlNode node)
+{
+	AvlNode pivot = node->left;
+	replaceChild(tree, node->parent, node, pivot);
+
+	node->left = pivot->right;
+	if (pivot->right != NULL)
+	{
+		pivot->right->parent = node;
+	}
+
+	pivot->right = node;
+	node->parent = pivot;
+
+	nodeUpdate(node);
+	nodeUpdate(pivot);
+	return pivot;
+}
+
+static void rebalanceUpwards(AvlTree tree, AvlNode node)
+{
+	while (node != NULL)
+	{
+		nodeUpdate(node);
+		int balance = nodeHeight(node->left) - nodeHeight(node->right);
+		if (balance > 1)
+		{
+			if (nodeHeight(node->left->left) < nodeHeight(node->left->right))
+			{
+				rotateLeft(tree, node->left);
+			}
+			node = rotateRight(tree, node);
+		}
+		else if (balance < -1)
+		{
+			if (nodeHeight(node->right->right) < nodeHeight(node->right->left))
+			{
+				rotateRight(tree, node->right);
+			}
+			node = rotateLeft(tree, node);
+		}
+		node = node->parent;
+	}
+}
+
+static AvlNode findNode(AvlTree tree, AvlElement key)
+{
+	AvlNode node = tree->root;
+	while (node != NULL)
+	{
+		int comparison = tree->compareElements(key, node->element);
+		if (comparison == 0)
+		{
+			return node;
+		}
+		node = comparison < 0 ? node->left : node->right;
+	}
+
+	return NULL;
+}
+
+static AvlNode leftmostNode(AvlNode node)
+{
+	while (node != NULL && node->left != NULL)
+	{
+		node = node->left;
+	}
+
+	return node;
+}
+
+static void destroySubtree(AvlTree tree, AvlNode node)
+{
+	while (node != NULL)
+	{
+		destroySubtree(tree, node->left);
+		AvlNode right = node->right;
+		arenaRelease(tree->arena, node, sizeof(*node));
+		node = right;
+	}
+}
+
+AvlTree avlTreeCreate(CompareAvlElements compare_elements)
+{
+	return avlTreeCreateInArena(NULL, compare_elements);
+}
+
+AvlTree avlTreeCreateInArena(Arena arena, CompareAvlElements compare_elements)
+{
+	if (compare_elements == NULL)
+	{
+		return NULL;
+	}
+
+	AvlTree tree = arenaAlloc(arena, sizeof(*tree));
+	if (tree == NULL)
+	{
+		return NULL;
+	}
+
+	tree->root = NULL;
+	tree->arena = arena;
+	tree->compareElements = compare_elements;
+
+	return tree;
+}
+
+void avlTreeDestroy(AvlTree tree)
+{
+	if (tree == NULL)
+	{
+		return;
+	}
+
+	destroySubtree(tree, tree->root);
+	arenaRelease(tree->arena, tree, sizeof(*tree));
+}
+
+int avlTreeGetSize(AvlTree tree)
+{
+	if (tree == NULL)
+	{
+		return -1;
+	}
+
+	return nodeSize(tree->root);
+}
+
+AvlTreeResult avlTreeReserve(AvlTree tree, int count)
+{
+	if (tree == NULL)
+	{
+		return AVL_NULL_ARGUMENT;
+	}
+
+	return arenaReserve(tree->arena, sizeof(struct AvlNode_t), count) ? AVL_SUCCESS : AVL_OUT_OF_MEMORY;
+}
+
+// Finds the parent under which element would be linked, or returns false if an equal element is in the tree
+static bool findInsertionPoint(AvlTree tree, AvlElement element, AvlNode* parent, int* comparison)
+{
+	*parent = NULL;
+	*comparison = 0;
+	AvlNode current = tree->root;
+	while (current != NULL)
+	{
+		*comparison = tree->compareElements(element, current->element);
+		if (*comparison == 0)
+		{
+			return false;
+		}
+		*parent = current;
+		current = *comparison < 0 ? current->left : current->right;
+	}
+
+	return true;
+}
+
+// Links a node holding element as a leaf at the point findInsertionPoint found
+static void linkNode(AvlTree tree, AvlNode node, AvlElement element, AvlNode parent, int comparison)
+{
+	node->element = element;
+	node->left = NULL;
+	node->right = NULL;
+	node->parent = parent;
+	node->height = 1;
+	node->size = 1;
+
+	if (parent == NULL)
+	{
+		tree->root = node;
+	}
+	else if (comparison < 0)
+	{
+		parent->left = node;
+	}
+	else
+	{
+		parent->right = node;
+	}
+
+	rebalanceUpwards(tree, parent);
+}
+
+// Takes the element of node out of the tree and returns the node which was unlinked, which may be another one
+static AvlNode unlinkNode(AvlTree tree, AvlNode node)
+{
+	// A node with two children takes its successor's element, and the successor node is unlinked instead
+	if (node->left != NULL && node->right != NULL)
+	{
+		AvlNode successor = leftmostNode(node->right);
+		node->element = successor->element;
+		node = successor;
+	}
+
+	AvlNode child = node->left != NULL ? node->left : node->right;
+	AvlNode parent = node->parent;
+	replaceChild(tree, parent, node, child);
+	rebalanceUpwards(tree, parent);
+	return node;
+}
+
+AvlTreeResult avlTreeInsert(AvlTree tree, AvlElement element)
+{
+	if (tree == NULL || element == NULL)
+	{
+		return AVL_NULL_ARGUMENT;
+	}
+
+	AvlNode parent;
+	int comparison;
+	if (!findInsertionPoint(tree, element, &parent, &comparison))
+	{
+		return AVL_ELEMENT_ALREADY_EXISTS;
+	}
+
+	AvlNode node = arenaAlloc(tree->arena, sizeof(*node));
+	if (node == NULL)
+	{
+		return AVL_OUT_OF_MEMORY;
+	}
+
+	linkNode(tree, node, element, parent, comparison);
+	return AVL_SUCCESS;
+}
+
+// Links nodes[first..last], which hold the elements in order, into a balanced subtree and returns its root
+static AvlNode buildBalancedSubtree(AvlNode* nodes, int first, int last, AvlNode parent)
+{
+	if (first > last)
+	{
+		return NULL;
+	}
+
+	int middle = first + (last - first) / 2;
+	AvlNode node = nodes[middle];
+	node->parent = parent;
+	node->left = buildBalancedSubtree(nodes, first, middle - 1, node);
+	node->right = buildBalancedSubtree(nodes, middle + 1, last, node);
+	nodeUpdate(node);
+	return node;
+}
+
+static bool isIncreasing(AvlTree tree, AvlElement* elements, int count)
+{
+	for (int i = 1; i < count; i++)
+	{
+		if (tree->compareElements(elements[i - 1], elements[i]) >= 0)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+AvlTreeResult avlTreeInsertAll(AvlTree tree, AvlElement* elements, int count)
+{
+	if (tree == NULL || elements == NULL)
+	{
+		return AVL_NULL_ARGUMENT;
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		if (elements[i] == NULL)
+		{
+			return AVL_NULL_ARGUMENT;
+		}
+	}
+
+	if (tree->root != NULL || count <= 1 || !isIncreasing(tree, elements, count))
+	{
+		for (int i = 0; i < count; i++)
+		{
+			AvlTreeResult result = avlTreeInsert(tree, elements[i]);
+			if (result != AVL_SUCCESS)
+			{
+				return result;
+			}
+		}
+		return AVL_SUCCESS;
+	}
+
+	AvlNode* nodes = malloc(count * sizeof(*nodes));
+	if (nodes == NULL)
+	{
+		return AVL_OUT_OF_MEMORY;
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		nodes[i] = arenaAlloc(tree->arena, sizeof(*nodes[i]));
+		if (nodes[i] == NULL)
+		{
+			while (i > 0)
+			{
+				arenaRelease(tree->arena, nodes[--i], sizeof(*nodes[i]));
+			}
+			free(nodes);
+			return AVL_OUT_OF_MEMORY;
+		}
+		nodes[i]->element = elements[i];
+	}
+
+	tree->root = buildBalancedSubtree(nodes, 0, count - 1, NULL);
+	free(nodes);
+	return AVL_SUCCESS;
+}
+
+AvlTreeResult avlTreeRemove(AvlTree tree, AvlElement key)
+{
+	if (tree == NULL || key == NULL)
+	{
+		return AVL_NULL_ARGUMENT;
+	}
+
+	AvlNode node = findNode(tree, key);
+	if (node == NULL)
+	{
+		return AVL_ELEMENT_DOES_NOT_EXIST;
+	}
+
+	arenaRelease(tree->arena, unlinkNode(tree, node), sizeof(*node));
+	return AVL_SUCCESS;
+}
+
+AvlTreeResult avlTreeReplace(AvlTree tree, AvlElement key, AvlElement element)
+{
+	if (tree == NULL || key == NULL || element == NULL)
+	{
+		return AVL_NULL_ARGUMENT;
+	}
+
+	AvlNode node = findNode(tree, key);
+	if (node == NULL)
+	{
+		return AVL_ELEMENT_DOES_NOT_EXIST;
+	}
+	AvlNode equalNode = findNode(tree, element);
+	if (equalNode != NULL && equalNode != node)
+	{
+		return AVL_ELEMENT_ALREADY_EXISTS;
+	}
+
+	// The unlinked node is linked again where element belongs, so nothing is allocated or released
+	AvlNode unlinked = unlinkNode(tree, node);
+	AvlNode parent;
+	int comparison;
+	findInsertionPoint(tree, element, &parent, &comparison);
+	linkNode(tree, unlinked, element, parent, comparison);
+	return AVL_SUCCESS;
+}
+
+AvlNode avlTreeGetFirstNode(AvlTree tree)
+{
+	if (tree == NULL)
+	{
+		return NULL;
+	}
+
+	return leftmostNode(tree->root);
+}
+
+AvlNode avlTreeGetNextNode(AvlNode node)
+{
+	if (node == NULL)
+	{
+		return NULL;
+	}
+
+	if (node->right != NULL)
+	{
+		return leftmostNode(node->right);
+	}
+
+	while (node->parent != NULL && node->parent->right == node)
+	{
+		node = node->parent;
+	}
+
+	return node->parent;
+}
+
+AvlNode avlTreeGetNodeAt(AvlTree tree, int index)
+{
+	if (tree == NULL || index < 0 || index >= nodeSize(tree->root))
+	{
+		return NULL;
+	}
+
+	AvlNode node = tree->root;
+	while (node != NULL)
+	{
+		int leftSize = nodeSize(node->left);
+		if (index == leftSize)
+		{
+			return node;
+		}
+
+		if (index < leftSize)
+		{
+			node = node->left;
+		}
+		else
+		{
+			index -= leftSize + 1;
+			node = node->right;
+		}
+	}
+
+	return NULL;
+}
+
+AvlNode avlTreeLowerBound(AvlTree tree, AvlElement key)
+{
+	if (tree == NULL || key == NULL)
+	{
+		return NULL;
+	}
+
+	AvlNode result = NULL;
+	AvlNode node = tree->root;
+	while (node != NULL)
+	{
+		if (tree->compareElements(node->element, key) >= 0)
+		{
+			result = node;
+			node = node->left;
+		}
+		else
+		{
+			node = node->right;
+		}
+	}
+
+	return result;
+}
+
+AvlElement avlNodeGetElement(AvlNode node)
+{
+	if (node == NULL)
+	{
+		return NULL;
+	}
+
+	return node->element;
+}
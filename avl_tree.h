@@ -0,0 +1,214 @@
+#ifndef AVL_TREE_H
+#define AVL_TREE_H
+
+#include "arena.h"
+
+/**
+* Generic Ordered Set
+*
+* Implements a balanced binary search tree (AVL) of elements ordered by a user supplied compare function.
+* Every node also keeps the size of its subtree, so the k-th element can be found in logarithmic time.
+* The tree only stores references to the elements: elements are neither copied nor freed by it.
+* Elements must be unique according to the compare function, and an element's ordering fields must not change
+* while it is inside the tree (remove it, change it and insert it again instead).
+*
+* Traversal is done with node handles instead of an internal iterator, so several traversals can run at once.
+* Node handles are invalidated by any insert or remove.
+*
+* The following functions are available:
+*   avlTreeCreate		    - Creates a new empty tree
+*   avlTreeCreateInArena	    - Creates a new empty tree whose nodes are allocated in an arena
+*   avlTreeDestroy		    - Deletes an existing tree and frees its nodes
+*   avlTreeGetSize		    - Returns the number of elements in the tree
+*   avlTreeReserve		    - Sets nodes aside for later inserts to a tree in an arena
+*   avlTreeInsert		    - Inserts an element to the tree
+*   avlTreeInsertAll	    - Inserts many elements to the tree, in linear time when they are sorted
+*   avlTreeRemove		    - Removes the element equal to a key element
+*   avlTreeReplace		    - Replaces the element equal to a key element by another one, without allocating
+*   avlTreeGetFirstNode	    - Returns the node of the smallest element
+*   avlTreeGetNextNode	    - Returns the node of the next element in order
+*   avlTreeGetNodeAt	    - Returns the node of the element at a given position in order
+*   avlTreeLowerBound	    - Returns the node of the first element which is not smaller than a key element
+*   avlNodeGetElement	    - Returns the element of a node
+*   AVL_FOREACH		    - A macro for iterating over the nodes of the tree in order
+*/
+
+/** Type for defining the tree */
+typedef struct AvlTree_t* AvlTree;
+
+/** Type for defining a node of the tree */
+typedef struct AvlNode_t* AvlNode;
+
+/** Data element data type for tree container */
+typedef void* AvlElement;
+
+/** Type used for returning error codes from tree functions */
+typedef enum AvlTreeResult_t {
+    AVL_SUCCESS,
+    AVL_OUT_OF_MEMORY,
+    AVL_NULL_ARGUMENT,
+    AVL_ELEMENT_ALREADY_EXISTS,
+    AVL_ELEMENT_DOES_NOT_EXIST
+} AvlTreeResult;
+
+/**
+* Type of function used by the tree to order elements.
+* This function should return:
+* 		A negative integer if the first element comes first;
+* 		0 if they're equal;
+*		A positive integer if the second element comes first.
+*/
+typedef int(*CompareAvlElements)(AvlElement, AvlElement);
+
+/**
+* avlTreeCreate: Allocates a new empty tree.
+*
+* @param compare_elements - Function pointer to be used for ordering the elements.
+* @return
+* 	NULL - if the parameter is NULL or allocations failed.
+* 	A new tree in case of success.
+*/
+AvlTree avlTreeCreate(CompareAvlElements compare_elements);
+
+/**
+* avlTreeCreateInArena: Allocates a new empty tree, exactly like avlTreeCreate, except that
+* the tree and its nodes are allocated in the given arena.
+*
+* @param arena - The arena to allocate from. If arena is NULL the heap is used, as in avlTreeCreate.
+* @return
+* 	NULL - if compare_elements is NULL or allocations failed.
+* 	A new tree in case of success.
+*/
+AvlTree avlTreeCreateInArena(Arena arena, CompareAvlElements compare_elements);
+
+/**
+* avlTreeDestroy: Deallocates an existing tree and its nodes. The elements are not freed.
+*
+* @param tree - Target tree to be deallocated. If tree is NULL nothing will be done
+*/
+void avlTreeDestroy(AvlTree tree);
+
+/**
+* avlTreeGetSize: Returns the number of elements in a tree
+*
+* @return
+* 	-1 if a NULL pointer was sent.
+* 	Otherwise the number of elements in the tree.
+*/
+int avlTreeGetSize(AvlTree tree);
+
+/**
+* avlTreeReserve: Makes sure count more elements can be inserted without taking memory from the heap, by setting
+* nodes aside in the arena of the tree. Other trees of the same arena share the nodes.
+*
+* @return
+* 	AVL_NULL_ARGUMENT if a NULL was sent
+* 	AVL_OUT_OF_MEMORY if an allocation failed
+* 	AVL_SUCCESS otherwise, also when the tree is not in an arena and nothing was reserved
+*/
+AvlTreeResult avlTreeReserve(AvlTree tree, int count);
+
+/**
+* avlTreeInsert: Inserts an element to the tree. The element itself is stored, not a copy.
+*
+* @return
+* 	AVL_NULL_ARGUMENT if a NULL was sent as one of the parameters
+* 	AVL_ELEMENT_ALREADY_EXISTS if an equal element is already in the tree
+* 	AVL_OUT_OF_MEMORY if an allocation failed
+* 	AVL_SUCCESS the element had been inserted successfully
+*/
+AvlTreeResult avlTreeInsert(AvlTree tree, AvlElement element);
+
+/**
+* avlTreeInsertAll: Inserts count elements to the tree, as if avlTreeInsert was called for each of them in order.
+* When the tree is empty and the elements are in increasing order, the balanced tree is built directly in O(count)
+* instead of O(count * log count).
+*
+* @return
+* 	AVL_NULL_ARGUMENT if a NULL was sent as one of the parameters
+* 	AVL_ELEMENT_ALREADY_EXISTS if an element is equal to another one. The elements before it were inserted.
+* 	AVL_OUT_OF_MEMORY if an allocation failed. The elements before the failure were inserted, or none when built directly.
+* 	AVL_SUCCESS all the elements had been inserted successfully
+*/
+AvlTreeResult avlTreeInsertAll(AvlTree tree, AvlElement* elements, int count);
+
+/**
+* avlTreeRemove: Removes the element which is equal to the key element from the tree.
+*
+* @return
+* 	AVL_NULL_ARGUMENT if a NULL was sent as one of the parameters
+* 	AVL_ELEMENT_DOES_NOT_EXIST if no equal element is in the tree
+* 	AVL_SUCCESS the element had been removed successfully
+*/
+AvlTreeResult avlTreeRemove(AvlTree tree, AvlElement key);
+
+/**
+* avlTreeReplace: Replaces the element which is equal to the key element by element, which is put where it belongs
+* in order. The node of the replaced element is reused, so this never allocates.
+* Elements in the tree must not change their order, so an element whose order is about to change can first be
+* replaced by a copy of itself, and the copy replaced by the element once it changed.
+*
+* @return
+* 	AVL_NULL_ARGUMENT if a NULL was sent as one of the parameters
+* 	AVL_ELEMENT_DOES_NOT_EXIST if no element is equal to key. The tree is not changed.
+* 	AVL_ELEMENT_ALREADY_EXISTS if another element than the replaced one is equal to element. The tree is not changed.
+* 	AVL_SUCCESS the element had been replaced successfully
+*/
+AvlTreeResult avlTreeReplace(AvlTree tree, AvlElement key, AvlElement element);
+
+/**
+* avlTreeGetFirstNode: Returns the node of the smallest element of the tree.
+*
+* @return
+* 	NULL if a NULL pointer was sent or the tree is empty.
+* 	The first node otherwise.
+*/
+AvlNode avlTreeGetFirstNode(AvlTree tree);
+
+/**
+* avlTreeGetNextNode: Returns the node of the element which comes right after the node's element.
+*
+* @return
+* 	NULL if a NULL pointer was sent or node is the last node.
+* 	The next node otherwise.
+*/
+AvlNode avlTreeGetNextNode(AvlNode node);
+
+/**
+* avlTreeGetNodeAt: Returns the node of the element at the given position of the order, starting from 0.
+*
+* @return
+* 	NULL if a NULL pointer was sent or index is out of range.
+* 	The node at the given position otherwise.
+*/
+AvlNode avlTreeGetNodeAt(AvlTree tree, int index);
+
+/**
+* avlTreeLowerBound: Returns the node of the first element which is not smaller than the key element.
+*
+* @param key - The key element. Only needs the fields used by the compare function.
+* @return
+* 	NULL if a NULL pointer was sent or all elements are smaller than key.
+* 	The matching node otherwise.
+*/
+AvlNode avlTreeLowerBound(AvlTree tree, AvlElement key);
+
+/**
+* avlNodeGetElement: Returns the element stored in a node.
+*
+* @return
+* 	NULL if a NULL pointer was sent.
+* 	The element of the node otherwise.
+*/
+AvlElement avlNodeGetElement(AvlNode node);
+
+/*!
+* Macro for iterating over the nodes of a tree in order.
+* Declares a new node iterator for the loop.
+*/
+#define AVL_FOREACH(type, iterator, tree) \
+    for(type iterator = avlTreeGetFirstNode(tree) ; \
+        iterator ;\
+        iterator = avlTreeGetNextNode(iterator))
+
+#endif /* AVL_TREE_H */
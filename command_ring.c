@@ -0,0 +1,154 @@
+#include "command_ring.h"
+#include "stdlib.h"
+#include "string.h"
+#include "stdint.h"
+#include <stdatomic.h>
+
+// Keeps the positions of the producers and of the consumer on different cache lines
+#define COMMAND_RING_CACHE_LINE 64
+
+struct CommandRing_t
+{
+	size_t mask;
+	size_t elementSize;
+	// Slot i is free for position p when its sequence is p, and holds the element of position p when it is p + 1
+	atomic_size_t* sequences;
+	char* elements;
+	char producerPadding[COMMAND_RING_CACHE_LINE];
+	atomic_size_t pushPosition;
+	char consumerPadding[COMMAND_RING_CACHE_LINE];
+	// Only the consumer moves the pop position
+	size_t popPosition;
+};
+
+CommandRing commandRingCreate(int capacity, int element_size)
+{
+	if (capacity <= 0 || element_size <= 0)
+	{
+		return NULL;
+	}
+
+	size_t size = 1;
+	while (size < (size_t)capacity)
+	{
+		size *= 2;
+	}
+
+	CommandRing ring = malloc(sizeof(*ring));
+	atomic_size_t* sequences = malloc(size * sizeof(*sequences));
+	char* elements = malloc(size * element_size);
+	if (ring == NULL || sequences == NULL || elements == NULL)
+	{
+		free(ring);
+		free(sequences);
+		free(elements);
+		return NULL;
+	}
+
+	for (size_t i = 0; i < size; i++)
+	{
+		atomic_init(&sequences[i], i);
+	}
+	ring->mask = size - 1;
+	ring->elementSize = element_size;
+	ring->sequences = sequences;
+	ring->elements = elements;
+	atomic_init(&ring->pushPosition, 0);
+	ring->popPosition = 0;
+
+	return ring;
+}
+
+void commandRingDestroy(CommandRing ring)
+{
+	if (ring == NULL)
+	{
+		return;
+	}
+
+	free(ring->sequences);
+	free(ring->elements);
+	free(ring);
+}
+
+bool commandRingPush(CommandRing ring, const void* element)
+{
+	if (ring == NULL || element == NULL)
+	{
+		return false;
+	}
+
+	size_t position = atomic_load_explicit(&ring->pushPosition, memory_order_relaxed);
+	while (true)
+	{
+		size_t sequence = atomic_load_explicit(&ring->sequences[position & ring->mask], memory_order_acquire);
+		intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+		if (difference == 0)
+		{
+			// The slot is free for this position, claim it unless another producer was faster
+			if (atomic_compare_exchange_weak_explicit(&ring->pushPosition, &position, position + 1,
+				memory_order_relaxed, memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else if (difference < 0)
+		{
+			// The slot still holds the element of the previous lap, which was not popped yet
+			return false;
+		}
+		else
+		{
+			position = atomic_load_explicit(&ring->pushPosition, memory_order_relaxed);
+		}
+	}
+
+	size_t slot = position & ring->mask;
+	memcpy(ring->elements + slot * ring->elementSize, element, ring->elementSize);
+	atomic_store_explicit(&ring->sequences[slot], position + 1, memory_order_release);
+
+	return true;
+}
+
+bool commandRingPop(CommandRing ring, void* element)
+{
+	return commandRingPopMany(ring, element, 1) == 1;
+}
+
+int commandRingPopMany(CommandRing ring, void* elements, int count)
+{
+	if (ring == NULL || elements == NULL)
+	{
+		return -1;
+	}
+
+	int popped = 0;
+	while (popped < count)
+	{
+		size_t position = ring->popPosition;
+		size_t slot = position & ring->mask;
+		if (atomic_load_explicit(&ring->sequences[slot], memory_order_acquire) != position + 1)
+		{
+			break;
+		}
+
+		memcpy((char*)elements + popped * ring->elementSize, ring->elements + slot * ring->elementSize,
+			ring->elementSize);
+		// Frees the slot for the position one lap ahead
+		atomic_store_explicit(&ring->sequences[slot], position + ring->mask + 1, memory_order_release);
+		ring->popPosition = position + 1;
+		popped++;
+	}
+
+	return popped;
+}
+
+unsigned long long commandRingGetPushed(CommandRing ring)
+{
+	if (ring == NULL)
+	{
+		return 0;
+	}
+
+	return atomic_load(&ring->pushPosition);
+}
@@ -0,0 +1,83 @@
+#ifndef COMMAND_RING_H
+#define COMMAND_RING_H
+
+#include <stdbool.h>
+
+/**
+* Bounded Multi-Producer Single-Consumer Ring
+*
+* A fixed size ring buffer of fixed size elements, which any number of threads push to and one thread pops from,
+* without locks. Elements are copied in and out, so pushing never allocates.
+* Every slot carries a sequence number which tells whether it is free or holds a published element: a producer
+* claims a slot with a single compare and swap and publishes it once the element is copied, so producers only
+* contend on the claim. Elements are popped in the order their slots were claimed.
+*
+* The following functions are available:
+*   commandRingCreate		- Creates a new empty ring
+*   commandRingDestroy		- Deletes an existing ring
+*   commandRingPush		- Copies an element into the ring, from any thread
+*   commandRingPop		- Copies the oldest element out of the ring, from the consumer thread
+*   commandRingPopMany		- Copies up to a number of the oldest elements out of the ring, from the consumer thread
+*   commandRingGetPushed	- Returns the number of elements claimed by producers so far
+*/
+
+/** Type for defining the ring */
+typedef struct CommandRing_t* CommandRing;
+
+/**
+* commandRingCreate: Allocates a new empty ring.
+*
+* @param capacity - The number of elements the ring holds. Rounded up to a power of 2.
+* @param element_size - The size of every element in bytes.
+* @return
+* 	NULL - if capacity or element_size is not positive, or allocations failed.
+* 	A new CommandRing in case of success.
+*/
+CommandRing commandRingCreate(int capacity, int element_size);
+
+/**
+* commandRingDestroy: Deallocates an existing ring. Elements still in it are lost.
+*
+* @param ring - Target ring to be deallocated. If ring is NULL nothing will be done
+*/
+void commandRingDestroy(CommandRing ring);
+
+/**
+* commandRingPush: Copies element_size bytes of element into the ring. Safe to call from any number of threads.
+*
+* @return
+* 	false if a NULL was sent or the ring is full.
+* 	true otherwise.
+*/
+bool commandRingPush(CommandRing ring, const void* element);
+
+/**
+* commandRingPop: Copies the oldest element of the ring into element and removes it. Only one thread may pop.
+*
+* @return
+* 	false if a NULL was sent or no element is published yet.
+* 	true otherwise.
+*/
+bool commandRingPop(CommandRing ring, void* element);
+
+/**
+* commandRingPopMany: Pops up to count elements into the array elements, oldest first. Only one thread may pop.
+*
+* @return
+* 	-1 if a NULL was sent.
+* 	The number of elements popped otherwise, 0 if none is published yet.
+*/
+int commandRingPopMany(CommandRing ring, void* elements, int count);
+
+/**
+* commandRingGetPushed: Returns the number of elements producers claimed slots for since the ring was created,
+* including those which are still being copied in. Once that many elements were popped, every push which returned
+* before the call was popped.
+*
+* @return
+* 	0 if a NULL was sent.
+* 	The number of claimed slots otherwise.
+*/
+unsigned long long commandRingGetPushed(CommandRing ring);
+
+#endif /* COMMAND_RING_H */
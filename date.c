@@ -27,13 +27,18 @@ static bool monthIsValid(int month)
 }
 
 Date dateCreate(int day, int month, int year)
+{
+	return dateCreateInArena(NULL, day, month, year);
+}
+
+Date dateCreateInArena(Arena arena, int day, int month, int year)
 {
 	if (!dayIsValid(day) || !monthIsValid(month))
 	{
 		return NULL;
 	}
 
-	Date date = malloc(sizeof(*date));
+	Date date = arenaAlloc(arena, sizeof(*date));
 	if (date == NULL)
 	{
 		return NULL;
@@ -51,14 +56,29 @@ void dateDestroy(Date date)
 	free(date);
 }
 
+void dateDestroyInArena(Arena arena, Date date)
+{
+	arenaRelease(arena, date, sizeof(*date));
+}
+
 Date dateCopy(Date date)
+{
+	return dateCopyInArena(NULL, date);
+}
+
+Date dateCopyInArena(Arena arena, Date date)
 {
 	if (date == NULL)
 	{
 		return NULL;
 	}
 
-	return dateCreate(date->day, date->month, date->year);
+	return dateCreateInArena(arena, date->day, date->month, date->year);
+}
+
+bool dateReserveInArena(Arena arena, int count)
+{
+	return arenaReserve(arena, sizeof(struct Date_t), count);
 }
 
 bool dateGet(Date date, int* day, int* month, int* year)
@@ -77,31 +97,27 @@ bool dateGet(Date date, int* day, int* month, int* year)
 
 int dateCompare(Date date1, Date date2)
 {
-	if (date1 == NULL || date2 == NULL || (date1->day == date2->day && date1->month == date2->month && date1->year == date2->year))
+	if (date1 == NULL || date2 == NULL)
 	{
 		return 0;
 	}
 
-	if (date1->year < date2->year)
+	if (date1->year != date2->year)
 	{
-		return -1;
+		return date1->year < date2->year ? -1 : 1;
 	}
-	else if (date1->year == date2->year)
+
+	if (date1->month != date2->month)
+	{
+		return date1->month < date2->month ? -1 : 1;
+	}
+
+	if (date1->day != date2->day)
 	{
-		if (date1->month < date2->month)
-		{
-			return -1;
-		}
-		else if (date1->month == date2->month)
-		{
-			if (date1->day < date2->day)
-			{
-				return -1;
-			}
-		}
+		return date1->day < date2->day ? -1 : 1;
 	}
 
-	return 1;
+	return 0;
 }
 
 void dateTick(Date date)
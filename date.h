@@ -2,6 +2,7 @@
 #define DATE_H
 
 #include <stdbool.h>
+#include "arena.h"
 
 /** Type for defining the date */
 typedef struct Date_t* Date;
@@ -18,6 +19,19 @@ typedef struct Date_t* Date;
 */
 Date dateCreate(int day, int month, int year);
 
+/**
+* dateCreateInArena: Allocates a new date inside an arena.
+*
+* @param arena - the arena to allocate from. If arena is NULL the date is allocated as in dateCreate.
+* @param day - the day of the date.
+* @param month - the month of the date.
+* @param year - the year of the date.
+* @return
+* 	NULL - if allocation failed or date is illegal.
+* 	A new Date in case of success.
+*/
+Date dateCreateInArena(Arena arena, int day, int month, int year);
+
 /**
 * dateDestroy: Deallocates an existing Date.
 *
@@ -25,6 +39,14 @@ Date dateCreate(int day, int month, int year);
 */
 void dateDestroy(Date date);
 
+/**
+* dateDestroyInArena: Releases a date that was allocated inside an arena.
+*
+* @param arena - the arena the date was allocated from.
+* @param date - Target date to be released. If date is NULL nothing will be done
+*/
+void dateDestroyInArena(Arena arena, Date date);
+
 /**
 * dateCopy: Creates a copy of target Date.
 *
@@ -35,6 +57,27 @@ void dateDestroy(Date date);
 */
 Date dateCopy(Date date);
 
+/**
+* dateCopyInArena: Creates a copy of target Date inside an arena.
+*
+* @param arena - the arena to allocate the copy from. If arena is NULL the copy is allocated as in dateCopy.
+* @param date - Target Date.
+* @return
+* 	NULL if a NULL was sent or a memory allocation failed.
+* 	A Date containing the same elements as date otherwise.
+*/
+Date dateCopyInArena(Arena arena, Date date);
+
+/**
+* dateReserveInArena: Makes sure count more dates can be created inside an arena without taking memory from the heap.
+*
+* @param arena - the arena to reserve in. If arena is NULL nothing is reserved.
+* @return
+* 	false if a memory allocation failed.
+* 	Otherwise true.
+*/
+bool dateReserveInArena(Arena arena, int count);
+
 /**
 * dateGet: Returns the day, month and year of a date
 *
@@ -0,0 +1,236 @@
+#include "epoch.h"
+#include "stdlib.h"
+#include <stdatomic.h>
+
+// Readers are spread over this many counters, so threads rarely share one
+#define EPOCH_SLOTS 64
+#define EPOCH_CACHE_LINE 64
+#define EPOCH_INITIAL_CAPACITY 64
+
+/** The readers of one group of threads, by the parity of the epoch they entered in */
+typedef struct EpochSlot_t
+{
+	atomic_long readers[2];
+	char padding[EPOCH_CACHE_LINE - 2 * sizeof(atomic_long)];
+} EpochSlot;
+
+/** A retired object and the function that frees it */
+typedef struct RetiredObject_t
+{
+	void* object;
+	EpochFreeFunction freeObject;
+} RetiredObject;
+
+/** The objects retired during the epochs of one parity */
+typedef struct RetiredList_t
+{
+	RetiredObject* objects;
+	int count;
+	int capacity;
+} RetiredList;
+
+struct EpochDomain_t
+{
+	EpochSlot slots[EPOCH_SLOTS];
+	atomic_ulong epoch;
+	EpochFreeFunction freeObject;
+	void* context;
+	RetiredList retired[2];
+};
+
+// Every thread uses the same slot in every domain, handed out in turn the first time it reads
+static atomic_int epochNextSlot;
+static _Thread_local int epochThreadSlot = -1;
+
+static int epochGetThreadSlot()
+{
+	if (epochThreadSlot < 0)
+	{
+		epochThreadSlot = atomic_fetch_add(&epochNextSlot, 1) % EPOCH_SLOTS;
+	}
+
+	return epochThreadSlot;
+}
+
+static long epochCountReaders(EpochDomain domain, int parity)
+{
+	long readers = 0;
+	for (int i = 0; i < EPOCH_SLOTS; i++)
+	{
+		readers += atomic_load(&domain->slots[i].readers[parity]);
+	}
+
+	return readers;
+}
+
+static void epochFreeList(EpochDomain domain, RetiredList* list)
+{
+	for (int i = 0; i < list->count; i++)
+	{
+		list->objects[i].freeObject(domain->context, list->objects[i].object);
+	}
+	list->count = 0;
+}
+
+EpochDomain epochDomainCreate(EpochFreeFunction free_object, void* context)
+{
+	if (free_object == NULL)
+	{
+		return NULL;
+	}
+
+	EpochDomain domain = malloc(sizeof(*domain));
+	if (domain == NULL)
+	{
+		return NULL;
+	}
+
+	for (int i = 0; i < EPOCH_SLOTS; i++)
+	{
+		atomic_init(&domain->slots[i].readers[0], 0);
+		atomic_init(&domain->slots[i].readers[1], 0);
+	}
+	atomic_init(&domain->epoch, 0);
+	domain->freeObject = free_object;
+	domain->context = context;
+	for (int i = 0; i < 2; i++)
+	{
+		domain->retired[i].objects = NULL;
+		domain->retired[i].count = 0;
+		domain->retired[i].capacity = 0;
+	}
+
+	return domain;
+}
+
+void epochDomainDestroy(EpochDomain domain)
+{
+	if (domain == NULL)
+	{
+		return;
+	}
+
+	for (int i = 0; i < 2; i++)
+	{
+		epochFreeList(domain, &domain->retired[i]);
+		free(domain->retired[i].objects);
+	}
+	free(domain);
+}
+
+int epochEnter(EpochDomain domain)
+{
+	if (domain == NULL)
+	{
+		return -1;
+	}
+
+	int slot = epochGetThreadSlot();
+	while (true)
+	{
+		unsigned long epoch = atomic_load(&domain->epoch);
+		int parity = epoch & 1;
+		atomic_fetch_add(&domain->slots[slot].readers[parity], 1);
+		// Announced in time only if the epoch did not move meanwhile, otherwise the collector may have missed it
+		if (atomic_load(&domain->epoch) == epoch)
+		{
+			return slot * 2 + parity;
+		}
+		atomic_fetch_sub(&domain->slots[slot].readers[parity], 1);
+	}
+}
+
+void epochExit(EpochDomain domain, int token)
+{
+	if (domain == NULL || token < 0)
+	{
+		return;
+	}
+
+	atomic_fetch_sub(&domain->slots[token / 2].readers[token % 2], 1);
+}
+
+bool epochReserve(EpochDomain domain, int count)
+{
+	if (domain == NULL || count < 0)
+	{
+		return false;
+	}
+
+	// Only epochCollect moves the epoch, so the objects retired until then all go to the list of the current one
+	RetiredList* list = &domain->retired[atomic_load(&domain->epoch) & 1];
+	if (count <= list->capacity - list->count)
+	{
+		return true;
+	}
+
+	int capacity = list->capacity == 0 ? EPOCH_INITIAL_CAPACITY : 2 * list->capacity;
+	if (capacity < list->count + count)
+	{
+		capacity = list->count + count;
+	}
+	RetiredObject* objects = realloc(list->objects, capacity * sizeof(*objects));
+	if (objects == NULL)
+	{
+		return false;
+	}
+	list->objects = objects;
+	list->capacity = capacity;
+	return true;
+}
+
+bool epochRetire(EpochDomain domain, void* object)
+{
+	if (domain == NULL)
+	{
+		return false;
+	}
+
+	return epochRetireWith(domain, object, domain->freeObject);
+}
+
+bool epochRetireWith(EpochDomain domain, void* object, EpochFreeFunction free_object)
+{
+	if (domain == NULL || object == NULL || free_object == NULL || !epochReserve(domain, 1))
+	{
+		return false;
+	}
+
+	RetiredList* list = &domain->retired[atomic_load(&domain->epoch) & 1];
+	list->objects[list->count].object = object;
+	list->objects[list->count].freeObject = free_object;
+	list->count++;
+	return true;
+}
+
+void epochCollect(EpochDomain domain)
+{
+	if (domain == NULL || domain->retired[0].count + domain->retired[1].count == 0)
+	{
+		return;
+	}
+
+	/*
+	* Readers of the previous epoch may still hold what was retired during it. Once they left, nothing retired then
+	* can be reached, and since readers of the current epoch use the other counter the epoch can move on
+	*/
+	unsigned long epoch = atomic_load(&domain->epoch);
+	int previous = (epoch + 1) & 1;
+	if (epochCountReaders(domain, previous) != 0)
+	{
+		return;
+	}
+
+	epochFreeList(domain, &domain->retired[previous]);
+	atomic_store(&domain->epoch, epoch + 1);
+}
+
+int epochGetRetiredCount(EpochDomain domain)
+{
+	if (domain == NULL)
+	{
+		return -1;
+	}
+
+	return domain->retired[0].count + domain->retired[1].count;
+}
@@ -0,0 +1,114 @@
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include <stdbool.h>
+
+/**
+* Epoch-Based Reclamation
+*
+* Lets readers use shared objects without locks while a writer removes them, by deferring the free of every removed
+* object until no reader can still hold it. Readers announce themselves for the current epoch on entering and leave
+* when done; an object retired during an epoch is freed once every reader of that epoch left, which a later
+* epochCollect notices before moving on to the next epoch.
+*
+* Entering and leaving cost two atomic increments on a counter shared by few threads, and never wait for the writer.
+* Retiring and collecting must be serialized by the caller, normally by the writer's own lock.
+*
+* The following functions are available:
+*   epochDomainCreate	- Creates a new domain with the function that frees its objects
+*   epochDomainDestroy	- Frees every retired object and deletes a domain
+*   epochEnter		- Starts a read of the shared objects
+*   epochExit		- Ends a read started by epochEnter
+*   epochReserve	- Makes room for objects to be retired later without allocating
+*   epochRetire		- Hands an object which readers can no longer reach to the domain
+*   epochRetireWith	- Same as epochRetire, for an object freed by another function than the domain's
+*   epochCollect	- Frees the retired objects no reader can hold anymore
+*   epochGetRetiredCount	- Returns the number of retired objects waiting to be freed
+*/
+
+/** Type for defining the reclamation domain */
+typedef struct EpochDomain_t* EpochDomain;
+
+/** Type of function used to free a retired object, with the context given to epochDomainCreate */
+typedef void(*EpochFreeFunction)(void* context, void* object);
+
+/**
+* epochDomainCreate: Allocates a new domain.
+*
+* @param free_object - Called for every retired object once it can be freed.
+* @return
+* 	NULL - if free_object is NULL or allocations failed.
+* 	A new EpochDomain in case of success.
+*/
+EpochDomain epochDomainCreate(EpochFreeFunction free_object, void* context);
+
+/**
+* epochDomainDestroy: Frees every retired object and deallocates the domain. No reader may be inside.
+*
+* @param domain - Target domain to be deallocated. If domain is NULL nothing will be done
+*/
+void epochDomainDestroy(EpochDomain domain);
+
+/**
+* epochEnter: Starts a read. Objects reached until the matching epochExit are not freed meanwhile, even if they
+* are retired. Reads may be nested and may run on any number of threads.
+*
+* @return
+* 	-1 if a NULL was sent.
+* 	A token to pass to epochExit otherwise.
+*/
+int epochEnter(EpochDomain domain);
+
+/**
+* epochExit: Ends the read which epochEnter returned token for.
+*/
+void epochExit(EpochDomain domain, int token);
+
+/**
+* epochReserve: Makes room for count more objects to be retired before the next epochCollect, so that retiring
+* them cannot fail. Meant to be called before the change that makes the objects unreachable.
+*
+* @return
+* 	false if a NULL was sent or allocations failed.
+* 	true otherwise.
+*/
+bool epochReserve(EpochDomain domain, int count);
+
+/**
+* epochRetire: Frees object once every read that may have reached it ended. The object must already be unreachable
+* for reads that start from now on. Never frees the object itself, since the caller may not have published yet
+* that the object is unreachable.
+*
+* @return
+* 	false if a NULL was sent or there was no room for the object, which was not taken. Cannot happen for objects
+* 	room was made for with epochReserve.
+* 	true otherwise.
+*/
+bool epochRetire(EpochDomain domain, void* object);
+
+/**
+* epochRetireWith: Same as epochRetire, but free_object frees the object instead of the function given to
+* epochDomainCreate, so one domain can reclaim objects of several types. free_object gets the domain's context.
+*
+* @return
+* 	false if a NULL was sent or there was no room for the object, which was not taken.
+* 	true otherwise.
+*/
+bool epochRetireWith(EpochDomain domain, void* object, EpochFreeFunction free_object);
+
+/**
+* epochCollect: Frees the objects retired before the current epoch if no read of that epoch is still running,
+* and starts a new epoch. Does not wait for readers: objects that cannot be freed yet are left for a later call.
+*/
+void epochCollect(EpochDomain domain);
+
+/**
+* epochGetRetiredCount: Returns the number of retired objects which were not freed yet.
+*
+* @return
+* 	-1 if a NULL was sent.
+* 	The number of retired objects otherwise.
+*/
+int epochGetRetiredCount(EpochDomain domain);
+
+#endif /* EPOCH_H */
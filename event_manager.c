@@ -1,8 +1,52 @@
 #include "event_manager.h"
 #include "priority_queue.h"
+#include "avl_tree.h"
+#include "hash_table.h"
+#include "string_table.h"
+#include "text_writer.h"
+#include "file_map.h"
+#include "journal.h"
+#include "thread_pool.h"
+#include "epoch.h"
+#include "stdint.h"
 #include "stdlib.h"
-#include "stdio.h"
 #include "string.h"
+#include "limits.h"
+#include <stdatomic.h>
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <time.h>
+#include <errno.h>
+#endif
+
+#define EM_ARENA_CHUNK_SIZE (1024 * 1024)
+#define EM_EXPORT_BUFFER_SIZE (256 * 1024)
+// Parallel exports format the events in chunks of this many events
+#define EM_EXPORT_CHUNK_EVENTS 4096
+#define EM_EXPORT_CHUNK_BUFFER_SIZE (16 * 1024)
+// "EMSS" when read in little endian byte order
+#define EM_SNAPSHOT_MAGIC 0x53534D45u
+#define EM_SNAPSHOT_VERSION 2
+#define EM_DAYS_IN_MONTH 30
+#define EM_MONTHS_IN_YEAR 12
+#define EM_NANOSECONDS_IN_SECOND 1000000000LL
+#define EM_NANOSECONDS_IN_MILLISECOND 1000000LL
+// Day number the scheduler timer is armed for when it is disarmed, or has to be armed again
+#define EM_SCHEDULER_NOT_ARMED INT_MIN
+
+struct EventManagerContext_t
+{
+	Arena arena;
+	StringTable names;
+};
 
 typedef struct EventManager_t
 {
@@ -10,208 +54,527 @@ typedef struct EventManager_t
 	PriorityQueue members;
 	Date createdDate;
 	Date currentDate;
+	StringTable names;
+	HashTable eventsById;
+	HashTable eventsByNameAndDate;
+	HashTable membersById;
+	// Members linked to at least one event, from the most responsible one
+	AvlTree responsibleMembers;
+	// The events in the order of the events queue, for range queries
+	AvlTree eventsByDate;
+	// The position given to the last event that entered the events queue
+	uint64_t lastQueueOrder;
+	// Reusable output buffer of the exports, NULL until the first export
+	TextWriter writer;
+	// NULL unless emSetExportThreads asked for more than one thread
+	ThreadPool exportPool;
+	// Two sets of exportThreads chunks, one formatted while the other is written
+	struct ExportChunk_t* exportChunks;
+	int exportThreads;
+	// Runs the asynchronous exports, NULL until the first one
+	ThreadPool exportWorker;
+	// The last export queued behind the running one, NULL once the worker has nothing left to run
+	struct ExportJob_t* lastExportJob;
+	// NULL unless the manager was created with EM_OPTION_ARENA or in a context
+	Arena arena;
+	// NULL unless the manager was created in a context, which then owns the arena and the names
+	EventManagerContext context;
+	// Number of successful mutations since the manager was first created, saved in snapshots
+	uint64_t sequence;
+	// NULL unless a journal was opened with emOpenJournal
+	Journal journal;
+	// The records of the open transaction, which reach the journal when it is committed, and the sequence it began at.
+	// Set from emBegin until the transaction ended
+	JournalRecord* pendingRecords;
+	int pendingCount;
+	int pendingCapacity;
+	uint64_t beginSequence;
+	bool deferringRecords;
+	// Live events ordered by the version of their last change, for emExportChangesSince
+	struct Event_t* firstChange;
+	struct Event_t* lastChange;
+	// Events removed since changesStart, ordered by version
+	struct EventRemoval_t* removals;
+	int removalsCount;
+	int removalsCapacity;
+	// Oldest version from which every change is still known
+	uint64_t changesStart;
+	// NULL unless emSetExpirationHandler set one
+	EventManagerExpirationHandler expirationHandler;
+	void* expirationContext;
+	// The events expired by the running tick and all their member ids, reused by every tick
+	EventManagerExpiredEvent* expiredEvents;
+	int expiredCount;
+	int expiredCapacity;
+	int* expiredMembers;
+	int expiredMembersCount;
+	int expiredMembersCapacity;
+	// The timer and the stop signal of the scheduler, -1 unless one was started
+	int schedulerTimer;
+	int schedulerStop;
+	// Set while emRunScheduler waits on the timer, which then has to close it by itself
+	bool schedulerLooping;
+	int64_t schedulerDayLength;
+	// The monotonic time in nanoseconds at which the day schedulerOriginDay began
+	int64_t schedulerOrigin;
+	int schedulerOriginDay;
+	int schedulerArmedDay;
+	// The thread of the open transaction by the address of its emThreadToken, 0 if there is none
+	atomic_uintptr_t transactionOwner;
+	// What undoes every change made since emBegin, in the order of the changes. Kept between transactions
+	struct UndoRecord_t* undo;
+	int undoCount;
+	int undoCapacity;
+	// What is left of the reservations of emReserve, taken by every add once the first one was made
+	bool reserving;
+	int reservedEvents;
+	int reservedMembers;
+	int reservedLinks;
+	int reservedNameBytes;
+	// Set by EM_OPTION_THREAD_SAFE, which makes every call take the lock
+	bool threadSafe;
+	// True while a writer holds the lock, so a manager destroyed by a failed allocation can release it
+	bool lockedForWriting;
+#ifndef _WIN32
+	pthread_rwlock_t lock;
+	// Taken by the readers that use the export buffers, the export threads or the journal of the manager
+	pthread_mutex_t exportLock;
+	// Guards lastExportJob and the links of the queued exports, in every mode since the worker is a thread of its own
+	pthread_mutex_t exportQueueLock;
+#endif
+	/*
+	* Also only with EM_OPTION_THREAD_SAFE: what emGetNextEvent and emGetEventsAmount return, published by every
+	* writer before it unlocks, so they are read without the lock. Removed events and members are retired to the
+	* epoch domain instead of being freed, since a reader may still be reading what it loaded. Names need no
+	* retiring: they are interned in every mode and never freed while the manager lives
+	*/
+	EpochDomain epoch;
+	_Atomic(struct Event_t*) publishedNextEvent;
+	atomic_int publishedEventsAmount;
 };
 
+/** Types of the journal records, one for every kind of mutation */
+typedef enum JournalRecordType_t {
+	EM_JOURNAL_ADD_EVENT,
+	EM_JOURNAL_REMOVE_EVENT,
+	EM_JOURNAL_CHANGE_DATE,
+	EM_JOURNAL_ADD_MEMBER,
+	EM_JOURNAL_LINK,
+	EM_JOURNAL_UNLINK,
+	EM_JOURNAL_TICK,
+	// Only made when a rollback undoes an emAddMember. Rollbacks are journaled as EM_JOURNAL_ROLLBACK, but older
+	// journals may hold it
+	EM_JOURNAL_REMOVE_MEMBER,
+	// Stands for the mutations of a rolled back transaction, which were not journaled, by their number
+	EM_JOURNAL_ROLLBACK
+} JournalRecordType;
+
 typedef struct Event_t
 {
 	int id;
-	char* name;
+	const char* name;
 	Date date;
 	PriorityQueue members;
+	// Increases with every event that enters the events queue, so it orders the events of the same date like the queue
+	uint64_t queueOrder;
+	// The versions the event was added and last changed at, and its neighbours in the changes list
+	uint64_t addedVersion;
+	uint64_t changedVersion;
+	struct Event_t* previousChange;
+	struct Event_t* nextChange;
 } *Event;
 
+/** A part of a parallel export: a run of consecutive events and the text they were formatted to */
+typedef struct ExportChunk_t
+{
+	Event* events;
+	int count;
+	TextWriter writer;
+	char* data;
+	int length;
+	int capacity;
+	bool failed;
+} *ExportChunk;
+
+typedef struct EventRemoval_t
+{
+	uint64_t version;
+	int id;
+	bool expired;
+} *EventRemoval;
+
+/** A change made inside a transaction, described by the journal record which repeats it */
+typedef struct UndoRecord_t
+{
+	JournalRecordType type;
+	int first;
+	int second;
+	const char* name;
+	// EM_JOURNAL_CHANGE_DATE and EM_JOURNAL_REMOVE_EVENT: the date the event had before, as a day number, and its
+	// place in the queue, behind the event with id previousEventId or first if it is -1
+	int previousDay;
+	int previousEventId;
+	uint64_t queueOrder;
+	// EM_JOURNAL_REMOVE_EVENT: the ids of the members the event was linked to
+	int* members;
+	int membersCount;
+} *UndoRecord;
+
 typedef struct Member_t
 {
 	int id;
-	char* name;
+	const char* name;
 	int countEvents;
 } *Member;
 
-static char* copyString(char* target, const char* source)
-{
-	if (target == NULL || source == NULL)
-	{
-		return NULL;
-	}
-	int i;
-	for (i = 0; source[i] != '\0'; i++)
-	{
-		target[i] = source[i];
-	}
+/*
+* Events and members are owned by the event manager, and every queue only holds references to them:
+* the same Member is linked into each event's member queue, and the priorities point into the
+* element itself (the event's date or the member's id). The queues therefore never copy or free.
+*/
+static PQElement copyReferenceGeneric(PQElement n) {
+	return n;
+}
 
-	target[i] = '\0';
+static void freeReferenceGeneric(PQElement n) {
+	(void)n;
+}
 
-	return target;
+static int compareDatesGeneric(PQElementPriority n1, PQElementPriority n2) {
+	return dateCompare((Date)n1, (Date)n2) * (-1);
 }
 
-static PQElement copyEventGeneric(PQElement n) {
-	if (!n) {
-		return NULL;
-	}
-	Event copy = malloc(sizeof(*copy));
-	if (!copy) {
-		return NULL;
-	}
-	copy->name = malloc(strlen(((Event)n)->name) + 1);
-	if (copy->name == NULL) {
-		free(copy);
-		return NULL;
-	}
-	Date copyDate = dateCopy(((Event)n)->date);
-	if (!copyDate) {
-		free(copy->name);
-		free(copy);
-		return NULL;
+static bool equalEventsGeneric(PQElement n1, PQElement n2) {
+	return ((Event)n1)->id == ((Event)n2)->id;
+}
+
+static int compareIntsGeneric(PQElementPriority n1, PQElementPriority n2) {
+	return (*(int*)n2 - *(int*)n1);
+}
+
+static int compareMembersByResponsibilityGeneric(AvlElement n1, AvlElement n2) {
+	Member member1 = n1;
+	Member member2 = n2;
+	if (member1->countEvents != member2->countEvents)
+	{
+		return member1->countEvents > member2->countEvents ? -1 : 1;
 	}
-	PriorityQueue copyMembers = pqCopy(((Event)n)->members);
-	if (!copyMembers) {
-		free(copy->name);
-		dateDestroy(copyDate);
-		free(copy);
-		return NULL;
+	return member1->id < member2->id ? -1 : (member1->id > member2->id);
+}
+
+static int compareEventsByDateGeneric(AvlElement n1, AvlElement n2) {
+	Event event1 = n1;
+	Event event2 = n2;
+	int comparison = dateCompare(event1->date, event2->date);
+	if (comparison != 0)
+	{
+		return comparison;
 	}
+	return event1->queueOrder < event2->queueOrder ? -1 : (event1->queueOrder > event2->queueOrder);
+}
 
-	copyString(copy->name, ((Event)n)->name);
-	copy->date = copyDate;
-	copy->id = ((Event)n)->id;
-	copy->members = copyMembers;
+static bool equalMembersGeneric(PQElement n1, PQElement n2) {
+	return ((Member)n1)->id == ((Member)n2)->id;
+}
 
-	return copy;
+static unsigned int hashInt(unsigned int n)
+{
+	return n * 2654435761u;
 }
 
-static PQElementPriority copyDateGeneric(PQElementPriority n) {
-	return dateCopy(n);
+static unsigned int hashEventByIdGeneric(HashElement n) {
+	return hashInt(((Event)n)->id);
 }
 
-static void freeEventGeneric(PQElement n) {
-	
-	dateDestroy(((Event)n)->date);
-	free(((Event)n)->name);
-	pqDestroy(((Event)n)->members);
-	free(n);
+static unsigned int hashEventByNameAndDateGeneric(HashElement n) {
+	int day, month, year;
+	dateGet(((Event)n)->date, &day, &month, &year);
+	// Names are interned, so the name's handle identifies it
+	unsigned int nameHash = hashInt((unsigned int)((uintptr_t)((Event)n)->name >> 4));
+	return nameHash ^ hashInt((year * 12 + month) * 31 + day);
 }
 
-static void freeDateGeneric(PQElementPriority n) {
-	dateDestroy(n);
+static bool equalEventsByNameAndDateGeneric(HashElement n1, HashElement n2) {
+	return ((Event)n1)->name == ((Event)n2)->name && dateCompare(((Event)n1)->date, ((Event)n2)->date) == 0;
 }
 
-static int compareDatesGeneric(PQElementPriority n1, PQElementPriority n2) {
-	return dateCompare((Date)n1, (Date)n2) * (-1);
+static unsigned int hashMemberByIdGeneric(HashElement n) {
+	return hashInt(((Member)n)->id);
 }
 
-static bool equalEventsGeneric(PQElement n1, PQElement n2) {
-	return ((Event)n1)->id == ((Event)n2)->id;
+static PriorityQueue emCreateMemberQueue(Arena arena)
+{
+	return pqCreateInArena(arena, copyReferenceGeneric, freeReferenceGeneric, equalMembersGeneric,
+		copyReferenceGeneric, freeReferenceGeneric, compareIntsGeneric);
 }
 
-static PQElement copyMemberGeneric(PQElement n) {
-	if (!n) {
-		return NULL;
-	}
-	Member copy = malloc(sizeof(*copy));
-	if (!copy) {
+// Creates an event which takes ownership of date, a date allocated in the manager's arena
+static Event emCreateEventWithDate(EventManager em, const char* name, int id, Date date)
+{
+	Event event = arenaAlloc(em->arena, sizeof(*event));
+	if (!event)
+	{
 		return NULL;
 	}
-	copy->name = malloc(strlen(((Member)n)->name) + 1);
-	if (copy->name == NULL) {
-		free(copy);
+
+	PriorityQueue memberQueue = emCreateMemberQueue(em->arena);
+	if (!memberQueue)
+	{
+		arenaRelease(em->arena, event, sizeof(*event));
 		return NULL;
 	}
 
-	copyString(copy->name, ((Member)n)->name);
-	copy->id = ((Member)n)->id;
-	copy->countEvents = ((Member)n)->countEvents;
+	event->name = name;
+	event->id = id;
+	event->members = memberQueue;
+	event->date = date;
+	event->queueOrder = 0;
+	event->addedVersion = 0;
+	event->changedVersion = 0;
+	event->previousChange = NULL;
+	event->nextChange = NULL;
 
-	return copy;
+	return event;
 }
 
-static PQElementPriority copyIntGeneric(PQElementPriority n) {
-	if (!n) {
+static Event emCreateEvent(EventManager em, const char* name, int id, Date date)
+{
+	if (name == NULL || id < 0)
+	{
+		return NULL;
+	}
+
+	Date newDate = dateCopyInArena(em->arena, date);
+	if (!newDate)
+	{
 		return NULL;
 	}
-	int* copy = malloc(sizeof(*copy));
-	if (!copy) {
+
+	Event event = emCreateEventWithDate(em, name, id, newDate);
+	if (!event)
+	{
+		dateDestroyInArena(em->arena, newDate);
 		return NULL;
 	}
-	*copy = *(int*)n;
-	return copy;
+
+	return event;
 }
 
-static void freeMemberGeneric(PQElement n) {
-	free(((Member)n)->name);
-	free(n);
+static void emDestroyEvent(EventManager em, Event event)
+{
+	pqDestroy(event->members);
+	dateDestroyInArena(em->arena, event->date);
+	arenaRelease(em->arena, event, sizeof(*event));
 }
 
-static void freeIntGeneric(PQElementPriority n) {
-	free(n);
+static bool emEventWithNameAndDateExists(EventManager em, const char* name, Date date)
+{
+	// Names are interned, so a name that was never interned cannot belong to any event
+	const char* internedName = stringTableFind(em->names, name);
+	if (internedName == NULL)
+	{
+		return false;
+	}
+
+	struct Event_t key;
+	key.name = internedName;
+	key.date = date;
+	return hashTableFind(em->eventsByNameAndDate, &key) != NULL;
 }
 
-static int compareIntsGeneric(PQElementPriority n1, PQElementPriority n2) {
-	return (*(int*)n2 - *(int*)n1);
+static bool emIndexEvent(EventManager em, Event event)
+{
+	if (hashTableInsert(em->eventsById, event) != HT_SUCCESS)
+	{
+		return false;
+	}
+	if (hashTableInsert(em->eventsByNameAndDate, event) != HT_SUCCESS)
+	{
+		hashTableRemove(em->eventsById, event);
+		return false;
+	}
+	return true;
 }
 
-static int compareIntsLargerHasHigherPriorityGeneric(PQElementPriority n1, PQElementPriority n2) {
-	return (*(int*)n1 - *(int*)n2);
+static void emUnindexEvent(EventManager em, Event event)
+{
+	hashTableRemove(em->eventsById, event);
+	hashTableRemove(em->eventsByNameAndDate, event);
 }
 
-static bool equalMembersGeneric(PQElement n1, PQElement n2) {
-	return ((Member)n1)->id == ((Member)n2)->id;
+// Called right after the event entered the events queue, so it gets the same place in the date index
+static bool emIndexEventByDate(EventManager em, Event event)
+{
+	event->queueOrder = ++em->lastQueueOrder;
+	return avlTreeInsert(em->eventsByDate, event) == AVL_SUCCESS;
 }
 
-static Event emCreateEvent(char* name, int id, Date date)
+// Gives an event of the date index a new date and queue order. The event moves within the index by its own node,
+// so this cannot fail
+static void emReorderEventByDate(EventManager em, Event event, Date date, uint64_t queueOrder)
 {
-	if (name == NULL || id < 0)
+	struct Event_t previous = *event;
+	avlTreeReplace(em->eventsByDate, event, &previous);
+	event->date = date;
+	event->queueOrder = queueOrder;
+	avlTreeReplace(em->eventsByDate, &previous, event);
+}
+
+/*
+* Gives a batch of events that entered the events queue together their place in the date index, in array order,
+* which is the order the queue keeps them in among events of the same date. A batch at least as large as the index
+* rebuilds it from the queue, which is already in order, instead of inserting every event on its own.
+*/
+static bool emIndexEventsByDate(EventManager em, Event* events, int count)
+{
+	if (count < avlTreeGetSize(em->eventsByDate))
 	{
-		return NULL;
+		for (int i = 0; i < count; i++)
+		{
+			if (!emIndexEventByDate(em, events[i]))
+			{
+				return false;
+			}
+		}
+		return true;
 	}
 
-	Event event = malloc(sizeof(*event));
-	if (!event)
+	for (int i = 0; i < count; i++)
 	{
-		return NULL;
+		events[i]->queueOrder = ++em->lastQueueOrder;
 	}
 
-	Date newDate = dateCopy(date);
-	if (!newDate)
+	int size = pqGetSize(em->events);
+	Event* ordered = malloc((size + 1) * sizeof(*ordered));
+	AvlTree index = avlTreeCreateInArena(em->arena, compareEventsByDateGeneric);
+	bool result = ordered != NULL && index != NULL;
+	if (result)
 	{
-		free(event);
-		return NULL;
+		int position = 0;
+		PQ_FOREACH(Event, event, em->events)
+		{
+			ordered[position++] = event;
+		}
+		result = avlTreeInsertAll(index, (AvlElement*)ordered, size) == AVL_SUCCESS;
 	}
+	free(ordered);
 
-	event->name = malloc(strlen(name) + 1);
-	if (event->name == NULL)
+	if (!result)
 	{
-		dateDestroy(newDate);
-		free(event->name);
-		return NULL;
+		avlTreeDestroy(index);
+		return false;
 	}
 
-	PriorityQueue memberQueue = pqCreate(copyMemberGeneric, freeMemberGeneric, equalMembersGeneric, copyIntGeneric, freeIntGeneric, compareIntsGeneric);
-	if (!memberQueue)
+	avlTreeDestroy(em->eventsByDate);
+	em->eventsByDate = index;
+	return true;
+}
+
+static void emUntrackEvent(EventManager em, Event event)
+{
+	if (event->previousChange != NULL)
 	{
-		dateDestroy(newDate);
-		free(event->name);
-		free(event);
-		return NULL;
+		event->previousChange->nextChange = event->nextChange;
+	}
+	else
+	{
+		em->firstChange = event->nextChange;
+	}
+	if (event->nextChange != NULL)
+	{
+		event->nextChange->previousChange = event->previousChange;
+	}
+	else
+	{
+		em->lastChange = event->previousChange;
 	}
+	event->previousChange = NULL;
+	event->nextChange = NULL;
+}
 
-	copyString(event->name, name);
-	event->id = id;
-	event->members = memberQueue;
-	event->date = newDate;
+/*
+* Stamps the event with the current version and moves it to the end of the changes list, which keeps the list
+* ordered by version. Called right after the mutation was recorded. added is true for an event that is not
+* in the list yet.
+*/
+static void emTrackEventChange(EventManager em, Event event, bool added)
+{
+	if (added)
+	{
+		event->addedVersion = em->sequence;
+	}
+	else
+	{
+		emUntrackEvent(em, event);
+	}
 
-	return event;
+	event->changedVersion = em->sequence;
+	event->previousChange = em->lastChange;
+	if (em->lastChange != NULL)
+	{
+		em->lastChange->nextChange = event;
+	}
+	else
+	{
+		em->firstChange = event;
+	}
+	em->lastChange = event;
 }
 
-static bool emEventWithNameAndDateExists(EventManager em, char* name, Date date)
+// Remembers that an event was removed at the current version
+static void emTrackRemoval(EventManager em, int event_id, bool expired)
 {
-	PQ_FOREACH(Event, event, em->events)
+	if (em->removalsCount == em->removalsCapacity)
+	{
+		int capacity = em->removalsCapacity == 0 ? 16 : em->removalsCapacity * 2;
+		EventRemoval removals = realloc(em->removals, capacity * sizeof(*removals));
+		if (removals == NULL)
+		{
+			// Only the delta exports depend on the removals, so they start over from the current version instead
+			em->removalsCount = 0;
+			em->changesStart = em->sequence;
+			return;
+		}
+		em->removals = removals;
+		em->removalsCapacity = capacity;
+	}
+
+	EventRemoval removal = &em->removals[em->removalsCount++];
+	removal->version = em->sequence;
+	removal->id = event_id;
+	removal->expired = expired;
+}
+
+/*
+* Moves the member within the ranking, which is ordered by countEvents. Only a member joining the ranking needs a new
+* node, so only a change from 0 can fail, and it then leaves the count as it was
+*/
+static bool emUpdateMemberEventsCount(EventManager em, Member member, int change)
+{
+	if (member->countEvents == 0)
 	{
-		if (strcmp(event->name, name) == 0 && dateCompare(event->date, date) == 0)
+		member->countEvents += change;
+		if (member->countEvents > 0 && avlTreeInsert(em->responsibleMembers, member) != AVL_SUCCESS)
 		{
-			return true;
+			member->countEvents -= change;
+			return false;
 		}
+		return true;
+	}
+
+	// The ranking holds a copy of the member while the count changes, so its order stays valid meanwhile
+	struct Member_t previous = *member;
+	avlTreeReplace(em->responsibleMembers, member, &previous);
+	member->countEvents += change;
+	if (member->countEvents > 0)
+	{
+		avlTreeReplace(em->responsibleMembers, &previous, member);
 	}
-	return false;
+	else
+	{
+		avlTreeRemove(em->responsibleMembers, &previous);
+	}
+	return true;
 }
 
 static void emRemoveAllMembersFromEvent(EventManager em, Event event)
@@ -220,95 +583,147 @@ static void emRemoveAllMembersFromEvent(EventManager em, Event event)
 	{
 		return;
 	}
+	// Part of removing the event, so the unlinks are not journaled on their own
 	while (pqGetSize(event->members) != 0)
 	{
-		emRemoveMemberFromEvent(em, ((Member)pqGetFirst(event->members))->id, event->id);
+		Member member = pqGetFirst(event->members);
+		pqRemove(event->members);
+		// Lowering a count cannot fail
+		emUpdateMemberEventsCount(em, member, -1);
 	}
 }
 
-static EventManagerResult emDeleteEventById(EventManager em, int event_id)
+// The id of the event queued right before event, or -1 if it is the first one
+static int emGetPreviousEventId(EventManager em, Event event)
 {
-	if (em == NULL || event_id < 0)
+	int previousId = -1;
+	PQ_FOREACH_POSITION(position, em->events)
 	{
-		return EM_ERROR;
-	}
-
-	PQ_FOREACH(Event, event, em->events)
-	{
-		if (event->id == event_id)
+		Event current = pqPositionGetElement(position);
+		if (current == event)
 		{
-			emRemoveAllMembersFromEvent(em, event);
-			pqRemoveElement(em->events, event);
-			return EM_SUCCESS;
+			break;
 		}
+		previousId = current->id;
 	}
 
-	return EM_EVENT_NOT_EXISTS;
+	return previousId;
 }
 
-static Event emGetEventById(EventManager em, int event_id)
+static void emFreeRetiredEvent(void* context, void* object)
 {
-	if (em == NULL || event_id < 0)
+	emDestroyEvent(context, object);
+}
+
+static void emFreeRetiredMember(void* context, void* object)
+{
+	EventManager em = context;
+	arenaRelease(em->arena, object, sizeof(struct Member_t));
+}
+
+/*
+* Makes room for retiring count events or members before any of them is removed. A retired object stays readable
+* until the change is published, so retiring must not fail and free it right away
+*/
+static bool emReserveRetired(EventManager em, int count)
+{
+	return em->epoch == NULL || epochReserve(em->epoch, count);
+}
+
+// The room for retiring the event was made by emReserveRetired
+static void emRemoveEventFromManager(EventManager em, Event event)
+{
+	emRemoveAllMembersFromEvent(em, event);
+	emUnindexEvent(em, event);
+	emUntrackEvent(em, event);
+	avlTreeRemove(em->eventsByDate, event);
+	pqRemoveElement(em->events, event);
+	if (em->epoch != NULL)
 	{
-		return NULL;
+		epochRetire(em->epoch, event);
+	}
+	else
+	{
+		emDestroyEvent(em, event);
 	}
+}
 
-	PQ_FOREACH(Event, event, em->events)
+static Event emGetEventById(EventManager em, int event_id)
+{
+	if (em == NULL || event_id < 0)
 	{
-		if (event->id == event_id)
-		{
-			return event;
-		}
+		return NULL;
 	}
 
-	return NULL;
+	struct Event_t key;
+	key.id = event_id;
+	return hashTableFind(em->eventsById, &key);
 }
 
-static Member emGetMemberById(PriorityQueue queue, int member_id)
+static EventManagerResult emDeleteEventById(EventManager em, int event_id)
 {
-	if (queue == NULL)
+	if (em == NULL || event_id < 0)
 	{
-		return NULL;
+		return EM_ERROR;
 	}
 
-	PQ_FOREACH(Member, member, queue)
+	Event event = emGetEventById(em, event_id);
+	if (event == NULL)
 	{
-		if (member->id == member_id)
-		{
-			return member;
-		}
+		return EM_EVENT_NOT_EXISTS;
 	}
 
-	return NULL;
+	emRemoveEventFromManager(em, event);
+	return EM_SUCCESS;
 }
 
-static Member emCreateMember(char* name, int id)
+static Member emGetMemberById(EventManager em, int member_id)
 {
-	if (name == NULL || id < 0)
+	if (em == NULL)
 	{
 		return NULL;
 	}
 
-	Member member = malloc(sizeof(*member));
-	if (member == NULL)
+	struct Member_t key;
+	key.id = member_id;
+	return hashTableFind(em->membersById, &key);
+}
+
+static Member emCreateMember(EventManager em, const char* name, int id)
+{
+	if (name == NULL || id < 0)
 	{
 		return NULL;
 	}
 
-	member->name = malloc(sizeof(char) * strlen(name) + 1);
-	if (member->name == NULL)
+	Member member = arenaAlloc(em->arena, sizeof(*member));
+	if (member == NULL)
 	{
-		free(member);
 		return NULL;
 	}
 
 	member->id = id;
-	copyString(member->name, name);
+	member->name = name;
 	member->countEvents = 0;
 
 	return member;
 }
 
+// Copies an event into the expiration buffers, which emReserveExpiredEvents made large enough
+static void emGatherExpiredEvent(EventManager em, Event event)
+{
+	EventManagerExpiredEvent* expired = &em->expiredEvents[em->expiredCount++];
+	expired->event_id = event->id;
+	expired->event_name = event->name;
+	expired->member_ids = em->expiredMembers + em->expiredMembersCount;
+	expired->member_count = pqGetSize(event->members);
+	PQ_FOREACH_POSITION(memberPosition, event->members)
+	{
+		Member member = pqPositionGetElement(memberPosition);
+		em->expiredMembers[em->expiredMembersCount++] = member->id;
+	}
+}
+
 static void emRemoveTodayEvents(EventManager em)
 {
 	if (em == NULL)
@@ -319,568 +734,4043 @@ static void emRemoveTodayEvents(EventManager em)
 	Event event = pqGetFirst(em->events);
 	while (event != NULL && dateCompare(event->date, em->currentDate) == 0)
 	{
-		emRemoveAllMembersFromEvent(em, event);
-		pqRemoveElement(em->events, event);
+		if (em->expirationHandler != NULL)
+		{
+			emGatherExpiredEvent(em, event);
+		}
+		emTrackRemoval(em, event->id, true);
+		emRemoveEventFromManager(em, event);
 		event = pqGetFirst(em->events);
 	}
 }
 
-EventManager createEventManager(Date date)
+static int emDateToDayNumber(Date date)
 {
-	if (date == NULL)
+	int day, month, year;
+	dateGet(date, &day, &month, &year);
+	return (year * EM_MONTHS_IN_YEAR + month - 1) * EM_DAYS_IN_MONTH + day - 1;
+}
+
+static int emFloorDivide(int dividend, int divisor)
+{
+	int quotient = dividend / divisor;
+	return (dividend % divisor != 0 && dividend < 0) ? quotient - 1 : quotient;
+}
+
+static Date emDateFromDayNumber(Arena arena, int dayNumber)
+{
+	int months = emFloorDivide(dayNumber, EM_DAYS_IN_MONTH);
+	int year = emFloorDivide(months, EM_MONTHS_IN_YEAR);
+	return dateCreateInArena(arena, dayNumber - months * EM_DAYS_IN_MONTH + 1,
+		months - year * EM_MONTHS_IN_YEAR + 1, year);
+}
+
+// Takes what a successful add used from the reservations of emReserve, counting its name as a new one
+static void emUseReservation(EventManager em, int events, int members, int links, const char* name)
+{
+	if (!em->reserving)
 	{
-		return NULL;
+		return;
 	}
 
-	EventManager eventManager = malloc(sizeof(*eventManager));
-	Date createdDate = dateCopy(date);
-	Date currentDate = dateCopy(date);
-	PriorityQueue eventQueue = pqCreate(copyEventGeneric, freeEventGeneric, equalEventsGeneric, copyDateGeneric, freeDateGeneric, compareDatesGeneric);
-	PriorityQueue memberQueue = pqCreate(copyMemberGeneric, freeMemberGeneric, equalMembersGeneric, copyIntGeneric, freeIntGeneric, compareIntsGeneric);
-	if (eventManager == NULL || createdDate == NULL || currentDate == NULL || eventQueue == NULL || memberQueue == NULL)
+	em->reservedEvents -= events;
+	em->reservedMembers -= members;
+	em->reservedLinks -= links;
+	if (name != NULL)
 	{
-		dateDestroy(createdDate);
-		dateDestroy(currentDate);
-		pqDestroy(eventQueue);
-		pqDestroy(memberQueue);
-		destroyEventManager(eventManager);
-		return NULL;
+		em->reservedNameBytes -= (int)strlen(name) + 1;
 	}
+}
 
-	eventManager->currentDate = currentDate;
-	eventManager->createdDate = createdDate;
-	eventManager->events = eventQueue;
-	eventManager->members = memberQueue;
+// Only the address is used, as an id of the thread that cannot be reused while the thread lives
+static _Thread_local char emThreadToken;
 
-	return eventManager;
+// Whether a transaction is open, which only the thread holding the lock for writing may ask
+static bool emInTransaction(EventManager em)
+{
+	return atomic_load(&em->transactionOwner) != 0;
 }
 
-void destroyEventManager(EventManager em)
+// Whether the calling thread opened the running transaction, and so already holds the lock for writing
+static bool emOwnsTransaction(EventManager em)
 {
-	if (em == NULL)
-	{
-		return;
-	}
-	
-	dateDestroy(em->createdDate);
-	dateDestroy(em->currentDate);
-	pqDestroy(em->events);
-	pqDestroy(em->members);
-	free(em);
+	return atomic_load(&em->transactionOwner) == (uintptr_t)&emThreadToken;
 }
 
-EventManagerResult emAddEventByDate(EventManager em, char* event_name, Date date, int event_id)
+// Makes room for count more records to wait for the end of the transaction
+static bool emReservePendingRecords(EventManager em, int count)
 {
-	if (em == NULL || event_name == NULL || date == NULL)
+	if (em->pendingCount + count <= em->pendingCapacity)
 	{
-		return EM_NULL_ARGUMENT;
+		return true;
 	}
 
-	if (dateCompare(em->currentDate, date) > 0)
+	int capacity = em->pendingCapacity == 0 ? 16 : em->pendingCapacity * 2;
+	if (capacity < em->pendingCount + count)
 	{
-		return EM_INVALID_DATE;
+		capacity = em->pendingCount + count;
 	}
-
-	if (event_id < 0)
+	JournalRecord* records = realloc(em->pendingRecords, capacity * sizeof(*records));
+	if (records == NULL)
 	{
-		return EM_INVALID_EVENT_ID;
+		return false;
 	}
+	em->pendingRecords = records;
+	em->pendingCapacity = capacity;
+	return true;
+}
 
-	if (emEventWithNameAndDateExists(em, event_name, date) == true)
+/*
+* Called after every successful mutation, with the arguments needed to repeat it. Inside a transaction the record
+* waits for emCommit in the room emReserveUndo made, so a crash before leaves nothing of the transaction in the
+* journal. The changes which undo a transaction are not journaled, since its records are dropped
+*/
+static void emRecordMutation(EventManager em, JournalRecordType type, int first, int second, const char* name)
+{
+	em->sequence++;
+	if (em->journal == NULL)
 	{
-		return EM_EVENT_ALREADY_EXISTS;
+		return;
 	}
 
-	Event newEvent = emCreateEvent(event_name, event_id, date);
-	if (newEvent == NULL)
+	JournalRecord record = { em->sequence, type, first, second, name };
+	if (!em->deferringRecords)
 	{
-		destroyEventManager(em);
-		return EM_OUT_OF_MEMORY;
+		// A failed write is remembered by the journal and reported by emSyncJournal
+		journalAppend(em->journal, &record);
 	}
-
-	if (pqContains(em->events, newEvent))
+	else if (emInTransaction(em))
 	{
-		freeEventGeneric(newEvent);
-		return EM_EVENT_ID_ALREADY_EXISTS;
+		em->pendingRecords[em->pendingCount++] = record;
 	}
+}
 
-	if (pqInsert(em->events, newEvent, newEvent->date) != PQ_SUCCESS)
+static void emWritePendingRecords(EventManager em)
+{
+	for (int i = 0; i < em->pendingCount; i++)
 	{
-		destroyEventManager(em);
-		return EM_OUT_OF_MEMORY;
+		journalAppend(em->journal, &em->pendingRecords[i]);
 	}
+	em->pendingCount = 0;
+}
 
-	freeEventGeneric(newEvent);
-
-	return EM_SUCCESS;
+/*
+* Drops the records of a rolled back transaction, which began at sequence. A single record takes their place in the
+* journal, so a replay skips their sequence numbers as well
+*/
+static void emRecordRollback(EventManager em, uint64_t sequence)
+{
+	em->pendingCount = 0;
+	if (em->journal != NULL && em->sequence != sequence)
+	{
+		JournalRecord record = { em->sequence, EM_JOURNAL_ROLLBACK, (int)(em->sequence - sequence), 0, NULL };
+		journalAppend(em->journal, &record);
+	}
 }
 
-EventManagerResult emAddEventByDiff(EventManager em, char* event_name, int days, int event_id)
+static void emFreeUndoRecords(UndoRecord undo, int count)
 {
-	if (em == NULL || event_name == NULL)
+	for (int i = 0; i < count; i++)
 	{
-		return EM_NULL_ARGUMENT;
+		free(undo[i].members);
 	}
+}
 
-	if (days < 0)
+// Makes room for count undo records before a change starts, so recording them after the change cannot fail
+static bool emReserveUndo(EventManager em, int count)
+{
+	if (!emInTransaction(em))
 	{
-		return EM_INVALID_DATE;
+		return true;
 	}
 
-	Date calculatedDate = dateCopy(em->currentDate);
-	while (days > 0)
+	// Every change of a transaction is journaled by a single record
+	if (em->journal != NULL && !emReservePendingRecords(em, count))
 	{
-		dateTick(calculatedDate);
-		days--;
+		return false;
+	}
+	if (em->undoCount + count <= em->undoCapacity)
+	{
+		return true;
 	}
 
-	EventManagerResult result = emAddEventByDate(em, event_name, calculatedDate, event_id);
-	dateDestroy(calculatedDate);
-
-	return result;
+	int capacity = em->undoCapacity == 0 ? 16 : em->undoCapacity * 2;
+	if (capacity < em->undoCount + count)
+	{
+		capacity = em->undoCount + count;
+	}
+	UndoRecord undo = realloc(em->undo, capacity * sizeof(*undo));
+	if (undo == NULL)
+	{
+		return false;
+	}
+	em->undo = undo;
+	em->undoCapacity = capacity;
+	return true;
 }
 
-EventManagerResult emRemoveEvent(EventManager em, int event_id)
+// Called after every change made inside a transaction, into the room emReserveUndo made
+static UndoRecord emRecordUndo(EventManager em, JournalRecordType type, int first, int second, const char* name)
 {
-	if (em == NULL)
+	if (!emInTransaction(em))
 	{
-		return EM_NULL_ARGUMENT;
+		return NULL;
 	}
 
-	if (event_id < 0)
+	UndoRecord record = &em->undo[em->undoCount++];
+	record->type = type;
+	record->first = first;
+	record->second = second;
+	record->name = name;
+	record->previousDay = 0;
+	record->previousEventId = -1;
+	record->queueOrder = 0;
+	record->members = NULL;
+	record->membersCount = 0;
+	return record;
+}
+
+// Defined with the other transaction functions, since undoing repeats the calls below
+static EventManagerResult emRollbackUnlocked(EventManager em);
+
+/*
+* Gives up a change whose allocation failed after it undid its own part. Inside a transaction every change since
+* emBegin is undone too and the manager is kept, otherwise the manager is destroyed
+*/
+static EventManagerResult emOutOfMemory(EventManager em)
+{
+	if (emInTransaction(em))
 	{
-		return EM_INVALID_EVENT_ID;
+		return emRollbackUnlocked(em) == EM_SUCCESS ? EM_TRANSACTION_ROLLED_BACK : EM_OUT_OF_MEMORY;
 	}
 
-	return emDeleteEventById(em, event_id);
+	destroyEventManager(em);
+	return EM_OUT_OF_MEMORY;
 }
 
-EventManagerResult emChangeEventDate(EventManager em, int event_id, Date new_date)
+static void emDestroyExportChunks(ExportChunk chunks, int count)
 {
-	if (em == NULL || new_date == NULL)
+	if (chunks == NULL)
 	{
-		return EM_NULL_ARGUMENT;
+		return;
 	}
 
-	if (dateCompare(em->currentDate, new_date) > 0)
+	for (int i = 0; i < count; i++)
 	{
-		return EM_INVALID_DATE;
+		textWriterDestroy(chunks[i].writer);
+		free(chunks[i].data);
 	}
+	free(chunks);
+}
 
-	if (event_id < 0)
+/*
+* Without EM_OPTION_THREAD_SAFE the locking functions do nothing. Readers may run together, so anything they change
+* in the manager is guarded by the export lock as well. Writers hold the lock through their Unlocked version, which
+* the functions that repeat other calls, like the journal replay, use directly.
+*/
+static void emLockForReading(EventManager em)
+{
+#ifndef _WIN32
+	if (em->threadSafe && !emOwnsTransaction(em))
 	{
-		return EM_INVALID_EVENT_ID;
+		pthread_rwlock_rdlock(&em->lock);
 	}
+#endif
+}
 
-	Event target = emGetEventById(em, event_id);
-	if (target == NULL)
+static void emUnlockAfterReading(EventManager em)
+{
+#ifndef _WIN32
+	if (em->threadSafe && !emOwnsTransaction(em))
 	{
-		return EM_EVENT_ID_NOT_EXISTS;
+		pthread_rwlock_unlock(&em->lock);
 	}
+#endif
+}
 
-	if (emEventWithNameAndDateExists(em, target->name, new_date) == true)
+static void emLockForWriting(EventManager em)
+{
+#ifndef _WIN32
+	if (em->threadSafe && !emOwnsTransaction(em))
 	{
-		return EM_EVENT_ALREADY_EXISTS;
+		pthread_rwlock_wrlock(&em->lock);
+		em->lockedForWriting = true;
 	}
+#endif
+}
 
-	Event targetCopy = copyEventGeneric(target);
-
-	if (pqChangePriority(em->events, targetCopy, targetCopy->date, new_date) == PQ_OUT_OF_MEMORY)
+// Runs while the writer still holds the lock, so the retired events are freed with the writer's exclusive access
+static void emPublishReadState(EventManager em)
+{
+	if (em->epoch == NULL)
 	{
-		destroyEventManager(em);
-		return EM_OUT_OF_MEMORY;
+		return;
 	}
 
-	freeEventGeneric(targetCopy);
-	target = emGetEventById(em, event_id);
-	dateDestroy(target->date);
-	target->date = dateCopy(new_date);
-	
-	return EM_SUCCESS;
+	atomic_store(&em->publishedNextEvent, pqPositionGetElement(pqGetFirstPosition(em->events)));
+	atomic_store(&em->publishedEventsAmount, pqGetSize(em->events));
+	epochCollect(em->epoch);
 }
 
-EventManagerResult emAddMember(EventManager em, char* member_name, int member_id)
+#ifdef __linux__
+static int64_t emSchedulerNow()
 {
-	if (em == NULL || member_name == NULL)
-	{
-		return EM_NULL_ARGUMENT;
-	}
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * EM_NANOSECONDS_IN_SECOND + now.tv_nsec;
+}
+#endif
 
-	if (member_id < 0)
+/*
+* Arms the scheduler timer for the end of the day of the next event, which is when a tick expires it, or disarms it
+* if there is no event. The timer is only set again when that day changed
+*/
+static void emArmScheduler(EventManager em)
+{
+#ifdef __linux__
+	if (em->schedulerTimer < 0)
 	{
-		return EM_INVALID_MEMBER_ID;
+		return;
 	}
 
-	Member target = emGetMemberById(em->members, member_id);
-	if (target != NULL)
+	Event next = pqPositionGetElement(pqGetFirstPosition(em->events));
+	int day = next == NULL ? EM_SCHEDULER_NOT_ARMED : emDateToDayNumber(next->date);
+	if (day == em->schedulerArmedDay)
 	{
-		return EM_MEMBER_ID_ALREADY_EXISTS;
+		return;
 	}
 
-	Member member = emCreateMember(member_name, member_id);
-	if (member == NULL)
+	// A zero time disarms the timer
+	struct itimerspec timer = { { 0, 0 }, { 0, 0 } };
+	if (next != NULL)
 	{
-		destroyEventManager(em);
-		return EM_OUT_OF_MEMORY;
+		int64_t expiry = em->schedulerOrigin + (day + 1 - em->schedulerOriginDay) * em->schedulerDayLength;
+		timer.it_value.tv_sec = expiry / EM_NANOSECONDS_IN_SECOND;
+		timer.it_value.tv_nsec = expiry % EM_NANOSECONDS_IN_SECOND;
 	}
+	timerfd_settime(em->schedulerTimer, TFD_TIMER_ABSTIME, &timer, NULL);
+	em->schedulerArmedDay = day;
+#endif
+}
 
-	if (pqInsert(em->members, member, &member_id) != PQ_SUCCESS)
+static void emCloseScheduler(EventManager em)
+{
+#ifdef __linux__
+	if (em->schedulerTimer < 0)
 	{
-		destroyEventManager(em);
-		return EM_OUT_OF_MEMORY;
+		return;
 	}
 
-	freeMemberGeneric(member);
-
-	return EM_SUCCESS;
+	close(em->schedulerTimer);
+	close(em->schedulerStop);
+	em->schedulerTimer = -1;
+	em->schedulerStop = -1;
+	em->schedulerArmedDay = EM_SCHEDULER_NOT_ARMED;
+#endif
 }
 
-EventManagerResult emAddMemberToEvent(EventManager em, int member_id, int event_id)
+static void emReleaseWriteLock(EventManager em)
 {
-	if (em == NULL)
-	{
-		return EM_NULL_ARGUMENT;
-	}
-
-	if (member_id < 0)
+	// The changes of a transaction are published together, and the lock is kept, when it ends
+	if (emOwnsTransaction(em))
 	{
-		return EM_INVALID_MEMBER_ID;
+		return;
 	}
 
-	if (event_id < 0)
+	emPublishReadState(em);
+	// Every change ends here, so the timer follows the next event
+	emArmScheduler(em);
+#ifndef _WIN32
+	if (em->threadSafe)
 	{
-		return EM_INVALID_EVENT_ID;
+		em->lockedForWriting = false;
+		pthread_rwlock_unlock(&em->lock);
 	}
+#endif
+}
 
-	Event event = emGetEventById(em, event_id);
-	if (event == NULL)
+static EventManagerResult emUnlockAfterWriting(EventManager em, EventManagerResult result)
+{
+	// After EM_OUT_OF_MEMORY the manager, lock included, was destroyed. After EM_TRANSACTION_ROLLED_BACK the
+	// transaction is over, so the lock it kept is released here
+	if (result != EM_OUT_OF_MEMORY)
 	{
-		return EM_EVENT_ID_NOT_EXISTS;
+		emReleaseWriteLock(em);
 	}
+	return result;
+}
 
-	Member member = emGetMemberById(em->members, member_id);
-	if (member == NULL)
+static void emLockExports(EventManager em)
+{
+#ifndef _WIN32
+	if (em->threadSafe)
 	{
-		return EM_MEMBER_ID_NOT_EXISTS;
+		pthread_mutex_lock(&em->exportLock);
 	}
+#endif
+}
 
-	if (pqContains(event->members, member) == true)
+static void emUnlockExports(EventManager em)
+{
+#ifndef _WIN32
+	if (em->threadSafe)
 	{
-		return EM_EVENT_AND_MEMBER_ALREADY_LINKED;
+		pthread_mutex_unlock(&em->exportLock);
 	}
+#endif
+}
 
-	if (pqInsert(event->members, member, &member_id) != PQ_SUCCESS)
-	{
-		destroyEventManager(em);
-		return EM_OUT_OF_MEMORY;
-	}
+static void emLockExportQueue(EventManager em)
+{
+#ifndef _WIN32
+	pthread_mutex_lock(&em->exportQueueLock);
+#else
+	(void)em;
+#endif
+}
 
-	member->countEvents++;
+static void emUnlockExportQueue(EventManager em)
+{
+#ifndef _WIN32
+	pthread_mutex_unlock(&em->exportQueueLock);
+#else
+	(void)em;
+#endif
+}
 
-	return EM_SUCCESS;
+EventManager createEventManager(Date date)
+{
+	return createEventManagerWithOptions(date, EM_OPTION_NONE);
 }
 
-EventManagerResult emRemoveMemberFromEvent(EventManager em, int member_id, int event_id)
+static EventManager emCreate(EventManagerContext context, Date date, int options)
 {
-	if (em == NULL)
+	if (date == NULL)
 	{
-		return EM_NULL_ARGUMENT;
+		return NULL;
 	}
 
-	if (member_id < 0)
+#ifdef _WIN32
+	if (options & EM_OPTION_THREAD_SAFE)
 	{
-		return EM_INVALID_MEMBER_ID;
+		return NULL;
 	}
+#endif
 
-	if (event_id < 0)
+	Arena arena = context != NULL ? context->arena : NULL;
+	if (context == NULL && (options & EM_OPTION_ARENA))
 	{
-		return EM_INVALID_EVENT_ID;
+		arena = arenaCreate(EM_ARENA_CHUNK_SIZE);
+		if (arena == NULL)
+		{
+			return NULL;
+		}
 	}
 
-	Member memberEventManager = emGetMemberById(em->members, member_id);
-	if (memberEventManager == NULL)
+	EventManager eventManager = malloc(sizeof(*eventManager));
+	Date createdDate = dateCopy(date);
+	Date currentDate = dateCopy(date);
+	PriorityQueue eventQueue = pqCreateInArena(arena, copyReferenceGeneric, freeReferenceGeneric, equalEventsGeneric,
+		copyReferenceGeneric, freeReferenceGeneric, compareDatesGeneric);
+	PriorityQueue memberQueue = emCreateMemberQueue(arena);
+	StringTable names = context != NULL ? context->names : stringTableCreate();
+	HashTable eventsById = hashTableCreateInArena(arena, hashEventByIdGeneric, equalEventsGeneric);
+	HashTable eventsByNameAndDate = hashTableCreateInArena(arena, hashEventByNameAndDateGeneric, equalEventsByNameAndDateGeneric);
+	HashTable membersById = hashTableCreateInArena(arena, hashMemberByIdGeneric, equalMembersGeneric);
+	AvlTree responsibleMembers = avlTreeCreateInArena(arena, compareMembersByResponsibilityGeneric);
+	AvlTree eventsByDate = avlTreeCreateInArena(arena, compareEventsByDateGeneric);
+	if (eventManager == NULL || createdDate == NULL || currentDate == NULL || eventQueue == NULL || memberQueue == NULL
+		|| names == NULL || eventsById == NULL || eventsByNameAndDate == NULL || membersById == NULL
+		|| responsibleMembers == NULL || eventsByDate == NULL)
 	{
-		return EM_MEMBER_ID_NOT_EXISTS;
+		dateDestroy(createdDate);
+		dateDestroy(currentDate);
+		pqDestroy(eventQueue);
+		pqDestroy(memberQueue);
+		hashTableDestroy(eventsById);
+		hashTableDestroy(eventsByNameAndDate);
+		hashTableDestroy(membersById);
+		avlTreeDestroy(responsibleMembers);
+		avlTreeDestroy(eventsByDate);
+		if (context == NULL)
+		{
+			stringTableDestroy(names);
+			arenaDestroy(arena);
+		}
+		free(eventManager);
+		return NULL;
 	}
 
-	Event event = emGetEventById(em, event_id);
-	if (event == NULL)
+	eventManager->currentDate = currentDate;
+	eventManager->createdDate = createdDate;
+	eventManager->events = eventQueue;
+	eventManager->members = memberQueue;
+	eventManager->names = names;
+	eventManager->eventsById = eventsById;
+	eventManager->eventsByNameAndDate = eventsByNameAndDate;
+	eventManager->membersById = membersById;
+	eventManager->responsibleMembers = responsibleMembers;
+	eventManager->eventsByDate = eventsByDate;
+	eventManager->lastQueueOrder = 0;
+	eventManager->writer = NULL;
+	eventManager->exportPool = NULL;
+	eventManager->exportChunks = NULL;
+	eventManager->exportThreads = 0;
+	eventManager->exportWorker = NULL;
+	eventManager->lastExportJob = NULL;
+	eventManager->arena = arena;
+	eventManager->context = context;
+	eventManager->sequence = 0;
+	eventManager->journal = NULL;
+	eventManager->pendingRecords = NULL;
+	eventManager->pendingCount = 0;
+	eventManager->pendingCapacity = 0;
+	eventManager->beginSequence = 0;
+	eventManager->deferringRecords = false;
+	eventManager->firstChange = NULL;
+	eventManager->lastChange = NULL;
+	eventManager->removals = NULL;
+	eventManager->removalsCount = 0;
+	eventManager->removalsCapacity = 0;
+	eventManager->changesStart = 0;
+	eventManager->expirationHandler = NULL;
+	eventManager->expirationContext = NULL;
+	eventManager->expiredEvents = NULL;
+	eventManager->expiredCount = 0;
+	eventManager->expiredCapacity = 0;
+	eventManager->expiredMembers = NULL;
+	eventManager->expiredMembersCount = 0;
+	eventManager->expiredMembersCapacity = 0;
+	eventManager->schedulerTimer = -1;
+	eventManager->schedulerStop = -1;
+	eventManager->schedulerLooping = false;
+	eventManager->schedulerDayLength = 0;
+	eventManager->schedulerOrigin = 0;
+	eventManager->schedulerOriginDay = 0;
+	eventManager->schedulerArmedDay = EM_SCHEDULER_NOT_ARMED;
+	atomic_init(&eventManager->transactionOwner, 0);
+	eventManager->undo = NULL;
+	eventManager->undoCount = 0;
+	eventManager->undoCapacity = 0;
+	eventManager->reserving = false;
+	eventManager->reservedEvents = 0;
+	eventManager->reservedMembers = 0;
+	eventManager->reservedLinks = 0;
+	eventManager->reservedNameBytes = 0;
+	eventManager->threadSafe = false;
+	eventManager->lockedForWriting = false;
+	eventManager->epoch = NULL;
+	atomic_init(&eventManager->publishedNextEvent, NULL);
+	atomic_init(&eventManager->publishedEventsAmount, 0);
+	if (options & EM_OPTION_THREAD_SAFE)
 	{
-		return EM_EVENT_ID_NOT_EXISTS;
+		eventManager->epoch = epochDomainCreate(emFreeRetiredEvent, eventManager);
+		if (eventManager->epoch == NULL)
+		{
+			destroyEventManager(eventManager);
+			return NULL;
+		}
 	}
 
-	Member memberEvent = emGetMemberById(event->members, member_id);
-	if (memberEvent == NULL)
+	eventManager->threadSafe = (options & EM_OPTION_THREAD_SAFE) != 0;
+#ifndef _WIN32
+	if (eventManager->threadSafe)
 	{
-		return EM_EVENT_AND_MEMBER_NOT_LINKED;
+		pthread_rwlock_init(&eventManager->lock, NULL);
+		pthread_mutex_init(&eventManager->exportLock, NULL);
 	}
+#endif
 
-	pqRemoveElement(event->members, memberEvent);
-	memberEventManager->countEvents--;
-
-	return EM_SUCCESS;
+	return eventManager;
 }
 
-EventManagerResult emTick(EventManager em, int days)
+EventManager createEventManagerWithOptions(Date date, int options)
 {
-	if (em == NULL)
-	{
-		return EM_NULL_ARGUMENT;
-	}
-
-	if (days <= 0)
-	{
-		return EM_INVALID_DATE;
-	}
+	return emCreate(NULL, date, options);
+}
 
-	while (days > 0)
+EventManagerContext createEventManagerContext()
+{
+	EventManagerContext context = malloc(sizeof(*context));
+	Arena arena = arenaCreate(EM_ARENA_CHUNK_SIZE);
+	StringTable names = stringTableCreate();
+	if (context == NULL || arena == NULL || names == NULL)
 	{
-		emRemoveTodayEvents(em);
-		dateTick(em->currentDate);
-		days--;
+		free(context);
+		arenaDestroy(arena);
+		stringTableDestroy(names);
+		return NULL;
 	}
 
-	return EM_SUCCESS;
+	context->arena = arena;
+	context->names = names;
+	return context;
 }
 
-int emGetEventsAmount(EventManager em)
+void destroyEventManagerContext(EventManagerContext context)
 {
-	if (em == NULL)
+	if (context == NULL)
 	{
-		return -1;
+		return;
 	}
 
-	return pqGetSize(em->events);
+	arenaDestroy(context->arena);
+	stringTableDestroy(context->names);
+	free(context);
 }
 
-char* emGetNextEvent(EventManager em)
+EventManager createEventManagerInContext(EventManagerContext context, Date date, int options)
 {
-	if (em == NULL)
-	{
-		return NULL;
-	}
-
-	Event nextEvent = pqGetFirst(em->events);
-	if (nextEvent == NULL)
+	// Nothing in the context is locked, so it cannot serve managers that are called from several threads
+	if (context == NULL || (options & EM_OPTION_THREAD_SAFE))
 	{
 		return NULL;
 	}
 
-	return nextEvent->name;
+	return emCreate(context, date, options | EM_OPTION_ARENA);
 }
 
-static int getDigitsLength(int number)
+void destroyEventManager(EventManager em)
 {
-	if (number == 0)
+	if (em == NULL)
 	{
-		return 1;
+		return;
 	}
 
-	int count = 0;
-	int negativeSign = 0;
-	if (number < 0)
+	// A running asynchronous export still reads the names, so it has to finish first
+	threadPoolDestroy(em->exportWorker);
+#ifndef _WIN32
+	if (em->exportWorker != NULL)
 	{
-		negativeSign = 1;
+		pthread_mutex_destroy(&em->exportQueueLock);
 	}
-
-	while (number != 0)
+#endif
+	epochDomainDestroy(em->epoch);
+
+	/*
+	* In arena mode every event, member and queue lives in the arena and is released with it. An arena shared through
+	* a context lives on, so everything is given back to it for the other managers
+	*/
+	if (em->arena == NULL || em->context != NULL)
 	{
-		number = number / 10;
-		count++;
+		PQ_FOREACH(Event, event, em->events)
+		{
+			emDestroyEvent(em, event);
+		}
+		PQ_FOREACH(Member, member, em->members)
+		{
+			arenaRelease(em->arena, member, sizeof(*member));
+		}
+		pqDestroy(em->events);
+		pqDestroy(em->members);
+		hashTableDestroy(em->eventsById);
+		hashTableDestroy(em->eventsByNameAndDate);
+		hashTableDestroy(em->membersById);
+		avlTreeDestroy(em->responsibleMembers);
+		avlTreeDestroy(em->eventsByDate);
 	}
-	return count + negativeSign;
-}
 
-static char* concatStrings(char* target, char* source)
-{
-	if (target == NULL || source == NULL)
+	journalClose(em->journal);
+	free(em->pendingRecords);
+	emCloseScheduler(em);
+	free(em->removals);
+	free(em->expiredEvents);
+	free(em->expiredMembers);
+	emFreeUndoRecords(em->undo, em->undoCount);
+	free(em->undo);
+	dateDestroy(em->createdDate);
+	dateDestroy(em->currentDate);
+	if (em->context == NULL)
 	{
-		return NULL;
+		stringTableDestroy(em->names);
 	}
-
-	int i = 0;
-	while (target[i] != '\0') {
-		i++;
+	textWriterDestroy(em->writer);
+	threadPoolDestroy(em->exportPool);
+	emDestroyExportChunks(em->exportChunks, 2 * em->exportThreads);
+	if (em->context == NULL)
+	{
+		arenaDestroy(em->arena);
 	}
-
-	for (int j = 0; source[j] != '\0'; ++j, ++i) {
-		target[i] = source[j];
+#ifndef _WIN32
+	if (em->threadSafe)
+	{
+		// A writer whose allocation failed destroys the manager while holding the lock
+		if (em->lockedForWriting)
+		{
+			pthread_rwlock_unlock(&em->lock);
+		}
+		pthread_rwlock_destroy(&em->lock);
+		pthread_mutex_destroy(&em->exportLock);
 	}
-
-	target[i] = '\0';
-	return target;
+#endif
+	free(em);
 }
 
-static char* dateToString(Date date)
+static EventManagerResult emValidateNewEvent(EventManager em, char* event_name, Date date, int event_id)
 {
-	int day, month, year;
-	dateGet(date, &day, &month, &year);
-	// length of: day.month.year
-	int length = getDigitsLength(day) + getDigitsLength(month) + getDigitsLength(year) + 2;
-	char* dayStr = malloc(getDigitsLength(day) + 1);
-	char* monthStr = malloc(getDigitsLength(month) + 1);
-	char* yearStr = malloc(getDigitsLength(year) + 1);
-	char* dateStr = malloc(length + 1);
-	*dateStr = '\0';
-	if (dateStr == NULL || dayStr == NULL || monthStr == NULL || yearStr == NULL)
-	{
-		free(dateStr);
-		free(dayStr);
-		free(monthStr);
-		free(yearStr);
-		return;
+	if (event_name == NULL || date == NULL)
+	{
+		return EM_NULL_ARGUMENT;
 	}
-	_itoa_s(day, dayStr, getDigitsLength(day) + 1, 10);
-	_itoa_s(month, monthStr, getDigitsLength(month) + 1, 10);
-	_itoa_s(year, yearStr, getDigitsLength(year) + 1, 10);
-
-	concatStrings(dateStr, dayStr);
-	concatStrings(dateStr, ".");
-	concatStrings(dateStr, monthStr);
-	concatStrings(dateStr, ".");
-	concatStrings(dateStr, yearStr);
 
-	free(dayStr);
-	free(monthStr);
-	free(yearStr);
-
-	return dateStr;
-}
-
-static char* emCreatePrintableLine(Event event, char* date)
-{
-	if (event == NULL || date == NULL)
+	if (dateCompare(em->currentDate, date) > 0)
 	{
-		return;
+		return EM_INVALID_DATE;
 	}
-	int countMembers = pqGetSize(event->members);
-	int memberNamesLength = 0;
-	PQ_FOREACH(Member, member, event->members)
+
+	if (event_id < 0)
 	{
-		memberNamesLength += strlen(member->name);
+		return EM_INVALID_EVENT_ID;
 	}
 
-	int lineLength = strlen(event->name) + 1 + strlen(date) + memberNamesLength + countMembers;
-
-	char* out = malloc(lineLength + 1);
-	*out = '\0';
-	if (out == NULL)
+	if (emEventWithNameAndDateExists(em, event_name, date) == true)
 	{
-		return;
+		return EM_EVENT_ALREADY_EXISTS;
 	}
 
-	concatStrings(out, event->name);
-	concatStrings(out, ",");
-	concatStrings(out, date);
-	PQ_FOREACH(Member, member, event->members)
+	if (emGetEventById(em, event_id) != NULL)
 	{
-		concatStrings(out, ",");
-		concatStrings(out, member->name);
+		return EM_EVENT_ID_ALREADY_EXISTS;
 	}
 
-	return out;
+	return EM_SUCCESS;
 }
 
-static void emPrintEvent(FILE* stream, Event event)
+static EventManagerResult emAddEventByDateUnlocked(EventManager em, char* event_name, Date date, int event_id)
 {
-	if (stream == NULL || event == NULL)
+	if (em == NULL)
 	{
-		return;
+		return EM_NULL_ARGUMENT;
 	}
 
-	char* date = dateToString(event->date);
-	if (date == NULL)
+	EventManagerResult result = emValidateNewEvent(em, event_name, date, event_id);
+	if (result != EM_SUCCESS)
 	{
-		return;
+		return result;
 	}
 
-	char* line = emCreatePrintableLine(event, date);
-	if (line == NULL)
+	if (!emReserveUndo(em, 1))
 	{
-		free(date);
-		return;
+		return emOutOfMemory(em);
 	}
 
-	fprintf(stream, line);
-	fprintf(stream, "\n");
-
-	free(date);
-	free(line);
-}
+	const char* name = stringTableIntern(em->names, event_name);
+	Event newEvent = emCreateEvent(em, name, event_id, date);
+	if (newEvent == NULL)
+	{
+		return emOutOfMemory(em);
+	}
 
-void emPrintAllEvents(EventManager em, const char* file_name)
-{
-	if (em == NULL || file_name == NULL)
+	if (!emIndexEvent(em, newEvent))
 	{
-		return;
+		emDestroyEvent(em, newEvent);
+		return emOutOfMemory(em);
 	}
 
-	FILE* stream;
-	errno_t err = fopen_s(&stream, file_name, "w");
-	if (err != 0)
+	if (pqInsert(em->events, newEvent, newEvent->date) != PQ_SUCCESS)
 	{
-		return;
+		emUnindexEvent(em, newEvent);
+		emDestroyEvent(em, newEvent);
+		return emOutOfMemory(em);
 	}
 
-	PQ_FOREACH(Event, event, em->events)
+	if (!emIndexEventByDate(em, newEvent))
 	{
-		emPrintEvent(stream, event);
+		pqRemoveElement(em->events, newEvent);
+		emUnindexEvent(em, newEvent);
+		emDestroyEvent(em, newEvent);
+		return emOutOfMemory(em);
 	}
 
-	fclose(stream);
+	emRecordMutation(em, EM_JOURNAL_ADD_EVENT, event_id, emDateToDayNumber(date), name);
+	emRecordUndo(em, EM_JOURNAL_ADD_EVENT, event_id, emDateToDayNumber(date), name);
+	emTrackEventChange(em, newEvent, true);
+	emUseReservation(em, 1, 0, 0, name);
+	return EM_SUCCESS;
 }
 
-static char* intToString(int num)
+EventManagerResult emAddEventByDate(EventManager em, char* event_name, Date date, int event_id)
 {
-	int length = getDigitsLength(num);
-	char* result = malloc(length + 1);
-	*result = '\0';
-	if (result == NULL)
+	if (em == NULL)
 	{
-		return;
+		return EM_NULL_ARGUMENT;
 	}
-	_itoa_s(num, result, getDigitsLength(num) + 1, 10);
 
-	return result;
+	emLockForWriting(em);
+	return emUnlockAfterWriting(em, emAddEventByDateUnlocked(em, event_name, date, event_id));
+}
+
+static EventManagerResult emAddEventByDiffUnlocked(EventManager em, char* event_name, int days, int event_id)
+{
+	if (em == NULL || event_name == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	if (days < 0)
+	{
+		return EM_INVALID_DATE;
+	}
+
+	Date calculatedDate = dateCopy(em->currentDate);
+	while (days > 0)
+	{
+		dateTick(calculatedDate);
+		days--;
+	}
+
+	EventManagerResult result = emAddEventByDateUnlocked(em, event_name, calculatedDate, event_id);
+	dateDestroy(calculatedDate);
+
+	return result;
+}
+
+EventManagerResult emAddEventByDiff(EventManager em, char* event_name, int days, int event_id)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	emLockForWriting(em);
+	return emUnlockAfterWriting(em, emAddEventByDiffUnlocked(em, event_name, days, event_id));
+}
+
+static EventManagerResult emRemoveEventUnlocked(EventManager em, int event_id)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	if (event_id < 0)
+	{
+		return EM_INVALID_EVENT_ID;
+	}
+
+	// Undoing the removal needs the event as it was, which is gone afterwards
+	Event event = emGetEventById(em, event_id);
+	if (event != NULL && !emReserveRetired(em, 1))
+	{
+		return emOutOfMemory(em);
+	}
+	if (event != NULL && emInTransaction(em))
+	{
+		// An event without members needs no array
+		int membersCount = pqGetSize(event->members);
+		int* members = membersCount == 0 ? NULL : malloc(membersCount * sizeof(*members));
+		if ((membersCount > 0 && members == NULL) || !emReserveUndo(em, 1))
+		{
+			free(members);
+			return emOutOfMemory(em);
+		}
+		UndoRecord record = emRecordUndo(em, EM_JOURNAL_REMOVE_EVENT, event_id, 0, event->name);
+		record->previousDay = emDateToDayNumber(event->date);
+		record->previousEventId = emGetPreviousEventId(em, event);
+		record->queueOrder = event->queueOrder;
+		record->members = members;
+		PQ_FOREACH_POSITION(memberPosition, event->members)
+		{
+			Member member = pqPositionGetElement(memberPosition);
+			members[record->membersCount++] = member->id;
+		}
+	}
+
+	EventManagerResult result = emDeleteEventById(em, event_id);
+	if (result == EM_SUCCESS)
+	{
+		emRecordMutation(em, EM_JOURNAL_REMOVE_EVENT, event_id, 0, NULL);
+		emTrackRemoval(em, event_id, false);
+	}
+
+	return result;
+}
+
+EventManagerResult emRemoveEvent(EventManager em, int event_id)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	emLockForWriting(em);
+	return emUnlockAfterWriting(em, emRemoveEventUnlocked(em, event_id));
+}
+
+static EventManagerResult emChangeEventDateUnlocked(EventManager em, int event_id, Date new_date)
+{
+	if (em == NULL || new_date == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	if (dateCompare(em->currentDate, new_date) > 0)
+	{
+		return EM_INVALID_DATE;
+	}
+
+	if (event_id < 0)
+	{
+		return EM_INVALID_EVENT_ID;
+	}
+
+	Event target = emGetEventById(em, event_id);
+	if (target == NULL)
+	{
+		return EM_EVENT_ID_NOT_EXISTS;
+	}
+
+	if (emEventWithNameAndDateExists(em, target->name, new_date) == true)
+	{
+		return EM_EVENT_ALREADY_EXISTS;
+	}
+
+	// The event gets back the slot it leaves in the name and date index, which is reserved here so it is not taken
+	// by a growth of the table after the queue changed
+	if (!emReserveUndo(em, 1)
+		|| hashTableReserve(em->eventsByNameAndDate, hashTableGetSize(em->eventsByNameAndDate)) != HT_SUCCESS)
+	{
+		return emOutOfMemory(em);
+	}
+
+	// The queue keeps a reference to the event's date, so the new date must be owned by the event
+	Date newDate = dateCopyInArena(em->arena, new_date);
+	if (newDate == NULL)
+	{
+		return emOutOfMemory(em);
+	}
+
+	int previousDay = emDateToDayNumber(target->date);
+	int previousEventId = emInTransaction(em) ? emGetPreviousEventId(em, target) : -1;
+	uint64_t queueOrder = target->queueOrder;
+	if (pqChangePriority(em->events, target, target->date, newDate) == PQ_OUT_OF_MEMORY)
+	{
+		dateDestroyInArena(em->arena, newDate);
+		// The event left the queue before the insert failed. Inside a transaction it is put back to its place
+		if (emInTransaction(em) && pqInsert(em->events, target, target->date) == PQ_SUCCESS)
+		{
+			pqMoveAfter(em->events, target, previousEventId < 0 ? NULL : emGetEventById(em, previousEventId));
+			return emOutOfMemory(em);
+		}
+		emDestroyEvent(em, target);
+		destroyEventManager(em);
+		return EM_OUT_OF_MEMORY;
+	}
+
+	// The indexes are keyed by the date, so the event is reindexed around the change, which cannot fail anymore
+	Date previousDate = target->date;
+	hashTableRemove(em->eventsByNameAndDate, target);
+	emReorderEventByDate(em, target, newDate, ++em->lastQueueOrder);
+	hashTableInsert(em->eventsByNameAndDate, target);
+	dateDestroyInArena(em->arena, previousDate);
+
+	emRecordMutation(em, EM_JOURNAL_CHANGE_DATE, event_id, emDateToDayNumber(newDate), NULL);
+	UndoRecord record = emRecordUndo(em, EM_JOURNAL_CHANGE_DATE, event_id, emDateToDayNumber(newDate), NULL);
+	if (record != NULL)
+	{
+		record->previousDay = previousDay;
+		record->previousEventId = previousEventId;
+		record->queueOrder = queueOrder;
+	}
+	emTrackEventChange(em, target, false);
+	return EM_SUCCESS;
+}
+
+EventManagerResult emChangeEventDate(EventManager em, int event_id, Date new_date)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	emLockForWriting(em);
+	return emUnlockAfterWriting(em, emChangeEventDateUnlocked(em, event_id, new_date));
+}
+
+static EventManagerResult emAddMemberUnlocked(EventManager em, char* member_name, int member_id)
+{
+	if (em == NULL || member_name == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	if (member_id < 0)
+	{
+		return EM_INVALID_MEMBER_ID;
+	}
+
+	Member target = emGetMemberById(em, member_id);
+	if (target != NULL)
+	{
+		return EM_MEMBER_ID_ALREADY_EXISTS;
+	}
+
+	if (!emReserveUndo(em, 1))
+	{
+		return emOutOfMemory(em);
+	}
+
+	const char* name = stringTableIntern(em->names, member_name);
+	Member member = emCreateMember(em, name, member_id);
+	if (member == NULL)
+	{
+		return emOutOfMemory(em);
+	}
+
+	if (hashTableInsert(em->membersById, member) != HT_SUCCESS)
+	{
+		arenaRelease(em->arena, member, sizeof(*member));
+		return emOutOfMemory(em);
+	}
+
+	if (pqInsert(em->members, member, &member->id) != PQ_SUCCESS)
+	{
+		hashTableRemove(em->membersById, member);
+		arenaRelease(em->arena, member, sizeof(*member));
+		return emOutOfMemory(em);
+	}
+
+	emRecordMutation(em, EM_JOURNAL_ADD_MEMBER, member_id, 0, name);
+	emRecordUndo(em, EM_JOURNAL_ADD_MEMBER, member_id, 0, name);
+	emUseReservation(em, 0, 1, 0, name);
+	return EM_SUCCESS;
+}
+
+EventManagerResult emAddMember(EventManager em, char* member_name, int member_id)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	emLockForWriting(em);
+	return emUnlockAfterWriting(em, emAddMemberUnlocked(em, member_name, member_id));
+}
+
+static EventManagerResult emAddEventsBulkUnlocked(EventManager em, char** event_names, Date* dates, int* event_ids, int count,
+	EventManagerResult* results)
+{
+	if (em == NULL || event_names == NULL || dates == NULL || event_ids == NULL || results == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	if (count <= 0)
+	{
+		return EM_SUCCESS;
+	}
+
+	// accepted[] holds the new events and accepted[count + i] the date each one is queued by
+	Event* accepted = malloc(2 * count * sizeof(*accepted));
+	if (accepted == NULL || !emReserveUndo(em, count))
+	{
+		free(accepted);
+		return emOutOfMemory(em);
+	}
+	Date* priorities = (Date*)(accepted + count);
+
+	// Accepted events are indexed right away, so duplicates inside the batch are detected too
+	int acceptedCount = 0;
+	bool outOfMemory = false;
+	for (int i = 0; i < count && !outOfMemory; i++)
+	{
+		results[i] = emValidateNewEvent(em, event_names[i], dates[i], event_ids[i]);
+		if (results[i] != EM_SUCCESS)
+		{
+			continue;
+		}
+
+		const char* name = stringTableIntern(em->names, event_names[i]);
+		Event newEvent = emCreateEvent(em, name, event_ids[i], dates[i]);
+		if (newEvent == NULL || !emIndexEvent(em, newEvent))
+		{
+			if (newEvent != NULL)
+			{
+				emDestroyEvent(em, newEvent);
+			}
+			outOfMemory = true;
+			break;
+		}
+
+		priorities[acceptedCount] = newEvent->date;
+		accepted[acceptedCount++] = newEvent;
+	}
+
+	if (outOfMemory || pqInsertAll(em->events, (PQElement*)accepted, (PQElementPriority*)priorities, acceptedCount) != PQ_SUCCESS)
+	{
+		for (int i = 0; i < acceptedCount; i++)
+		{
+			emUnindexEvent(em, accepted[i]);
+			emDestroyEvent(em, accepted[i]);
+		}
+		free(accepted);
+		return emOutOfMemory(em);
+	}
+
+	if (!emIndexEventsByDate(em, accepted, acceptedCount))
+	{
+		// Some of the events may be in the date index already
+		for (int i = 0; i < acceptedCount; i++)
+		{
+			avlTreeRemove(em->eventsByDate, accepted[i]);
+			pqRemoveElement(em->events, accepted[i]);
+			emUnindexEvent(em, accepted[i]);
+			emDestroyEvent(em, accepted[i]);
+		}
+		free(accepted);
+		return emOutOfMemory(em);
+	}
+
+	for (int i = 0; i < acceptedCount; i++)
+	{
+		int day = emDateToDayNumber(accepted[i]->date);
+		emRecordMutation(em, EM_JOURNAL_ADD_EVENT, accepted[i]->id, day, accepted[i]->name);
+		emRecordUndo(em, EM_JOURNAL_ADD_EVENT, accepted[i]->id, day, accepted[i]->name);
+		emTrackEventChange(em, accepted[i], true);
+		emUseReservation(em, 1, 0, 0, accepted[i]->name);
+	}
+
+	free(accepted);
+	return EM_SUCCESS;
+}
+
+EventManagerResult emAddEventsBulk(EventManager em, char** event_names, Date* dates, int* event_ids, int count,
+	EventManagerResult* results)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	emLockForWriting(em);
+	return emUnlockAfterWriting(em, emAddEventsBulkUnlocked(em, event_names, dates, event_ids, count, results));
+}
+
+static EventManagerResult emAddMembersBulkUnlocked(EventManager em, char** member_names, int* member_ids, int count,
+	EventManagerResult* results)
+{
+	if (em == NULL || member_names == NULL || member_ids == NULL || results == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	if (count <= 0)
+	{
+		return EM_SUCCESS;
+	}
+
+	// accepted[] holds the new members and accepted[count + i] the id each one is queued by
+	Member* accepted = malloc(2 * count * sizeof(*accepted));
+	if (accepted == NULL || !emReserveUndo(em, count))
+	{
+		free(accepted);
+		return emOutOfMemory(em);
+	}
+	int** priorities = (int**)(accepted + count);
+
+	int acceptedCount = 0;
+	bool outOfMemory = false;
+	for (int i = 0; i < count; i++)
+	{
+		if (member_names[i] == NULL)
+		{
+			results[i] = EM_NULL_ARGUMENT;
+			continue;
+		}
+		if (member_ids[i] < 0)
+		{
+			results[i] = EM_INVALID_MEMBER_ID;
+			continue;
+		}
+		if (emGetMemberById(em, member_ids[i]) != NULL)
+		{
+			results[i] = EM_MEMBER_ID_ALREADY_EXISTS;
+			continue;
+		}
+
+		const char* name = stringTableIntern(em->names, member_names[i]);
+		Member member = emCreateMember(em, name, member_ids[i]);
+		if (member == NULL || hashTableInsert(em->membersById, member) != HT_SUCCESS)
+		{
+			arenaRelease(em->arena, member, sizeof(*member));
+			outOfMemory = true;
+			break;
+		}
+
+		results[i] = EM_SUCCESS;
+		priorities[acceptedCount] = &member->id;
+		accepted[acceptedCount++] = member;
+	}
+
+	if (outOfMemory || pqInsertAll(em->members, (PQElement*)accepted, (PQElementPriority*)priorities, acceptedCount) != PQ_SUCCESS)
+	{
+		for (int i = 0; i < acceptedCount; i++)
+		{
+			hashTableRemove(em->membersById, accepted[i]);
+			arenaRelease(em->arena, accepted[i], sizeof(*accepted[i]));
+		}
+		free(accepted);
+		return emOutOfMemory(em);
+	}
+
+	for (int i = 0; i < acceptedCount; i++)
+	{
+		emRecordMutation(em, EM_JOURNAL_ADD_MEMBER, accepted[i]->id, 0, accepted[i]->name);
+		emRecordUndo(em, EM_JOURNAL_ADD_MEMBER, accepted[i]->id, 0, accepted[i]->name);
+		emUseReservation(em, 0, 1, 0, accepted[i]->name);
+	}
+
+	free(accepted);
+	return EM_SUCCESS;
+}
+
+EventManagerResult emAddMembersBulk(EventManager em, char** member_names, int* member_ids, int count,
+	EventManagerResult* results)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	emLockForWriting(em);
+	return emUnlockAfterWriting(em, emAddMembersBulkUnlocked(em, member_names, member_ids, count, results));
+}
+
+static EventManagerResult emAddMemberToEventUnlocked(EventManager em, int member_id, int event_id)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	if (member_id < 0)
+	{
+		return EM_INVALID_MEMBER_ID;
+	}
+
+	if (event_id < 0)
+	{
+		return EM_INVALID_EVENT_ID;
+	}
+
+	Event event = emGetEventById(em, event_id);
+	if (event == NULL)
+	{
+		return EM_EVENT_ID_NOT_EXISTS;
+	}
+
+	Member member = emGetMemberById(em, member_id);
+	if (member == NULL)
+	{
+		return EM_MEMBER_ID_NOT_EXISTS;
+	}
+
+	if (pqContains(event->members, member) == true)
+	{
+		return EM_EVENT_AND_MEMBER_ALREADY_LINKED;
+	}
+
+	if (!emReserveUndo(em, 1) || pqInsert(event->members, member, &member->id) != PQ_SUCCESS)
+	{
+		return emOutOfMemory(em);
+	}
+
+	if (!emUpdateMemberEventsCount(em, member, 1))
+	{
+		// The member is still ranked by its old count
+		pqRemoveElement(event->members, member);
+		return emOutOfMemory(em);
+	}
+
+	emRecordMutation(em, EM_JOURNAL_LINK, member_id, event_id, NULL);
+	emRecordUndo(em, EM_JOURNAL_LINK, member_id, event_id, NULL);
+	emTrackEventChange(em, event, false);
+	emUseReservation(em, 0, 0, 1, NULL);
+	return EM_SUCCESS;
+}
+
+EventManagerResult emAddMemberToEvent(EventManager em, int member_id, int event_id)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	emLockForWriting(em);
+	return emUnlockAfterWriting(em, emAddMemberToEventUnlocked(em, member_id, event_id));
+}
+
+static EventManagerResult emReserveUnlocked(EventManager em, int events, int members, int links, int name_bytes)
+{
+	if (events < 0 || members < 0 || links < 0 || name_bytes < 0 || em->arena == NULL)
+	{
+		return EM_ERROR;
+	}
+
+	/*
+	* An event takes its date, its member queue and nodes in the events queue and the date index, a member a node
+	* in the members queue, and a link a node in the member queue of the event and, for the first event of the
+	* member, in the ranking. A removal or a change of date gives back what it takes
+	*/
+	if (!arenaReserve(em->arena, sizeof(struct Event_t), events)
+		|| !arenaReserve(em->arena, sizeof(struct Member_t), members)
+		|| !dateReserveInArena(em->arena, events)
+		|| pqReserveInArena(em->arena, events, events + members + links) != PQ_SUCCESS
+		|| avlTreeReserve(em->eventsByDate, events + links) != AVL_SUCCESS
+		|| hashTableReserve(em->eventsById, hashTableGetSize(em->eventsById) + events) != HT_SUCCESS
+		|| hashTableReserve(em->eventsByNameAndDate, hashTableGetSize(em->eventsByNameAndDate) + events) != HT_SUCCESS
+		|| hashTableReserve(em->membersById, hashTableGetSize(em->membersById) + members) != HT_SUCCESS
+		|| !stringTableReserve(em->names, events + members, name_bytes)
+		|| !emReserveUndo(em, events + members + links))
+	{
+		return EM_OUT_OF_MEMORY;
+	}
+
+	em->reserving = true;
+	em->reservedEvents += events;
+	em->reservedMembers += members;
+	em->reservedLinks += links;
+	em->reservedNameBytes += name_bytes;
+	return EM_SUCCESS;
+}
+
+EventManagerResult emReserve(EventManager em, int events, int members, int links, int name_bytes)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	// A failed reservation keeps the manager, so the lock is released after EM_OUT_OF_MEMORY too
+	emLockForWriting(em);
+	EventManagerResult result = emReserveUnlocked(em, events, members, links, name_bytes);
+	emReleaseWriteLock(em);
+	return result;
+}
+
+EventManagerResult emGetReservation(EventManager em, int* events, int* members, int* links, int* name_bytes)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	emLockForReading(em);
+	int amounts[] = { em->reservedEvents, em->reservedMembers, em->reservedLinks, em->reservedNameBytes };
+	int* targets[] = { events, members, links, name_bytes };
+	bool exhausted = false;
+	for (int i = 0; i < 4; i++)
+	{
+		exhausted = exhausted || amounts[i] < 0;
+		if (targets[i] != NULL)
+		{
+			*targets[i] = amounts[i] < 0 ? 0 : amounts[i];
+		}
+	}
+	emUnlockAfterReading(em);
+
+	return exhausted ? EM_RESERVATION_EXHAUSTED : EM_SUCCESS;
+}
+
+static EventManagerResult emRemoveMemberFromEventUnlocked(EventManager em, int member_id, int event_id)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	if (member_id < 0)
+	{
+		return EM_INVALID_MEMBER_ID;
+	}
+
+	if (event_id < 0)
+	{
+		return EM_INVALID_EVENT_ID;
+	}
+
+	Member memberEventManager = emGetMemberById(em, member_id);
+	if (memberEventManager == NULL)
+	{
+		return EM_MEMBER_ID_NOT_EXISTS;
+	}
+
+	Event event = emGetEventById(em, event_id);
+	if (event == NULL)
+	{
+		return EM_EVENT_ID_NOT_EXISTS;
+	}
+
+	if (!pqContains(event->members, memberEventManager))
+	{
+		return EM_EVENT_AND_MEMBER_NOT_LINKED;
+	}
+
+	if (!emReserveUndo(em, 1))
+	{
+		return emOutOfMemory(em);
+	}
+	pqRemoveElement(event->members, memberEventManager);
+
+	// Lowering a count moves the member within the ranking by its own node, so this cannot fail
+	emUpdateMemberEventsCount(em, memberEventManager, -1);
+
+	emRecordMutation(em, EM_JOURNAL_UNLINK, member_id, event_id, NULL);
+	emRecordUndo(em, EM_JOURNAL_UNLINK, member_id, event_id, NULL);
+	emTrackEventChange(em, event, false);
+	return EM_SUCCESS;
+}
+
+EventManagerResult emRemoveMemberFromEvent(EventManager em, int member_id, int event_id)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	emLockForWriting(em);
+	return emUnlockAfterWriting(em, emRemoveMemberFromEventUnlocked(em, member_id, event_id));
+}
+
+// Only undoes an emAddMember, whose member was not linked to an event before the rollback reached it
+static EventManagerResult emRemoveMemberUnlocked(EventManager em, int member_id)
+{
+	Member member = emGetMemberById(em, member_id);
+	if (member == NULL)
+	{
+		return EM_MEMBER_ID_NOT_EXISTS;
+	}
+
+	if (member->countEvents > 0)
+	{
+		return EM_ERROR;
+	}
+
+	if (!emReserveRetired(em, 1))
+	{
+		return emOutOfMemory(em);
+	}
+
+	hashTableRemove(em->membersById, member);
+	pqRemoveElement(em->members, member);
+	if (em->epoch != NULL)
+	{
+		epochRetireWith(em->epoch, member, emFreeRetiredMember);
+	}
+	else
+	{
+		arenaRelease(em->arena, member, sizeof(*member));
+	}
+
+	emRecordMutation(em, EM_JOURNAL_REMOVE_MEMBER, member_id, 0, NULL);
+	return EM_SUCCESS;
+}
+
+/*
+* Puts an event whose removal or change of date was undone back to its place among the events of its date, which
+* it was queued behind of by the undoing call. Every later change was undone already, so the event it followed is
+* in the queue again
+*/
+static void emRequeueEvent(EventManager em, UndoRecord record)
+{
+	Event event = emGetEventById(em, record->first);
+	Event previous = record->previousEventId < 0 ? NULL : emGetEventById(em, record->previousEventId);
+	pqMoveAfter(em->events, event, previous);
+	emReorderEventByDate(em, event, event->date, record->queueOrder);
+}
+
+// Makes the opposite change of a record, which is tracked like any other change
+static EventManagerResult emUndo(EventManager em, UndoRecord record)
+{
+	switch (record->type)
+	{
+	case EM_JOURNAL_ADD_EVENT:
+		return emRemoveEventUnlocked(em, record->first);
+	case EM_JOURNAL_REMOVE_EVENT:
+	case EM_JOURNAL_CHANGE_DATE:
+	{
+		Date date = emDateFromDayNumber(NULL, record->previousDay);
+		if (date == NULL)
+		{
+			return emOutOfMemory(em);
+		}
+		EventManagerResult result = record->type == EM_JOURNAL_REMOVE_EVENT
+			? emAddEventByDateUnlocked(em, (char*)record->name, date, record->first)
+			: emChangeEventDateUnlocked(em, record->first, date);
+		dateDestroy(date);
+		if (result == EM_SUCCESS)
+		{
+			emRequeueEvent(em, record);
+		}
+		for (int i = 0; i < record->membersCount && result == EM_SUCCESS; i++)
+		{
+			result = emAddMemberToEventUnlocked(em, record->members[i], record->first);
+		}
+		return result;
+	}
+	case EM_JOURNAL_ADD_MEMBER:
+		return emRemoveMemberUnlocked(em, record->first);
+	case EM_JOURNAL_LINK:
+		return emRemoveMemberFromEventUnlocked(em, record->first, record->second);
+	case EM_JOURNAL_UNLINK:
+		return emAddMemberToEventUnlocked(em, record->first, record->second);
+	default:
+		return EM_ERROR;
+	}
+}
+
+/*
+* Undoes the changes of the open transaction, newest first, and closes it. The undoing changes are not part of the
+* transaction, so if one of them runs out of memory the manager is destroyed
+*/
+static EventManagerResult emRollbackUnlocked(EventManager em)
+{
+	UndoRecord undo = em->undo;
+	int count = em->undoCount;
+	int capacity = em->undoCapacity;
+	em->undo = NULL;
+	em->undoCount = 0;
+	em->undoCapacity = 0;
+	atomic_store(&em->transactionOwner, 0);
+
+	EventManagerResult result = EM_SUCCESS;
+	for (int i = count - 1; i >= 0 && result != EM_OUT_OF_MEMORY; i--)
+	{
+		result = emUndo(em, &undo[i]);
+	}
+
+	emFreeUndoRecords(undo, count);
+	if (result == EM_OUT_OF_MEMORY)
+	{
+		free(undo);
+		return result;
+	}
+
+	emRecordRollback(em, em->beginSequence);
+	em->deferringRecords = false;
+	em->undo = undo;
+	em->undoCapacity = capacity;
+	return EM_SUCCESS;
+}
+
+EventManagerResult emBegin(EventManager em)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	// Holding the lock until the transaction ends keeps the other threads out of it
+	emLockForWriting(em);
+	if (emInTransaction(em))
+	{
+		return EM_ERROR;
+	}
+	atomic_store(&em->transactionOwner, (uintptr_t)&emThreadToken);
+	em->beginSequence = em->sequence;
+	em->deferringRecords = true;
+
+	return EM_SUCCESS;
+}
+
+EventManagerResult emCommit(EventManager em)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	if (!emOwnsTransaction(em))
+	{
+		return EM_ERROR;
+	}
+
+	emFreeUndoRecords(em->undo, em->undoCount);
+	em->undoCount = 0;
+	emWritePendingRecords(em);
+	em->deferringRecords = false;
+	atomic_store(&em->transactionOwner, 0);
+	emReleaseWriteLock(em);
+
+	return EM_SUCCESS;
+}
+
+EventManagerResult emRollback(EventManager em)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	if (!emOwnsTransaction(em))
+	{
+		return EM_ERROR;
+	}
+
+	return emUnlockAfterWriting(em, emRollbackUnlocked(em));
+}
+
+// Counts the events a tick of days will expire, which are the first events of the queue, and their members
+static int emCountExpiringEvents(EventManager em, int days, int* memberCount)
+{
+	int lastDay = emDateToDayNumber(em->currentDate) + days;
+	int eventCount = 0;
+	*memberCount = 0;
+	PQ_FOREACH_POSITION(eventPosition, em->events)
+	{
+		Event event = pqPositionGetElement(eventPosition);
+		if (emDateToDayNumber(event->date) >= lastDay)
+		{
+			break;
+		}
+		eventCount++;
+		*memberCount += pqGetSize(event->members);
+	}
+
+	return eventCount;
+}
+
+/*
+* Sizes the expiration buffers for the events a tick will expire, so gathering them cannot fail halfway through
+* the tick
+*/
+static bool emReserveExpiredEvents(EventManager em, int eventCount, int memberCount)
+{
+	if (eventCount > em->expiredCapacity)
+	{
+		EventManagerExpiredEvent* events = realloc(em->expiredEvents, eventCount * sizeof(*events));
+		if (events == NULL)
+		{
+			return false;
+		}
+		em->expiredEvents = events;
+		em->expiredCapacity = eventCount;
+	}
+	if (memberCount > em->expiredMembersCapacity)
+	{
+		int* members = realloc(em->expiredMembers, memberCount * sizeof(*members));
+		if (members == NULL)
+		{
+			return false;
+		}
+		em->expiredMembers = members;
+		em->expiredMembersCapacity = memberCount;
+	}
+
+	em->expiredCount = 0;
+	em->expiredMembersCount = 0;
+	return true;
+}
+
+static EventManagerResult emTickUnlocked(EventManager em, int days)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	if (days <= 0)
+	{
+		return EM_INVALID_DATE;
+	}
+
+	// Expired events were already handed out, so a tick could not be undone
+	if (emInTransaction(em))
+	{
+		return EM_ERROR;
+	}
+
+	if (em->expirationHandler != NULL || em->epoch != NULL)
+	{
+		int memberCount;
+		int eventCount = emCountExpiringEvents(em, days, &memberCount);
+		if (!emReserveRetired(em, eventCount)
+			|| (em->expirationHandler != NULL && !emReserveExpiredEvents(em, eventCount, memberCount)))
+		{
+			return emOutOfMemory(em);
+		}
+	}
+
+	emRecordMutation(em, EM_JOURNAL_TICK, days, 0, NULL);
+	while (days > 0)
+	{
+		emRemoveTodayEvents(em);
+		dateTick(em->currentDate);
+		days--;
+	}
+
+	if (em->expirationHandler != NULL && em->expiredCount > 0)
+	{
+		em->expirationHandler(em->expirationContext, em->expiredEvents, em->expiredCount);
+	}
+
+	return EM_SUCCESS;
+}
+
+EventManagerResult emTick(EventManager em, int days)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	emLockForWriting(em);
+	return emUnlockAfterWriting(em, emTickUnlocked(em, days));
+}
+
+EventManagerResult emSetExpirationHandler(EventManager em, EventManagerExpirationHandler handler, void* context)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	emLockForWriting(em);
+	em->expirationHandler = handler;
+	em->expirationContext = context;
+	emReleaseWriteLock(em);
+
+	return EM_SUCCESS;
+}
+
+#ifdef __linux__
+static EventManagerResult emStartSchedulerUnlocked(EventManager em, int day_length_ms)
+{
+	if (day_length_ms <= 0 || em->schedulerTimer >= 0)
+	{
+		return EM_ERROR;
+	}
+
+	int timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	int stop = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (timer < 0 || stop < 0)
+	{
+		if (timer >= 0)
+		{
+			close(timer);
+		}
+		if (stop >= 0)
+		{
+			close(stop);
+		}
+		return EM_ERROR;
+	}
+
+	// The current date starts now
+	em->schedulerTimer = timer;
+	em->schedulerStop = stop;
+	em->schedulerDayLength = day_length_ms * EM_NANOSECONDS_IN_MILLISECOND;
+	em->schedulerOrigin = emSchedulerNow();
+	em->schedulerOriginDay = emDateToDayNumber(em->currentDate);
+	em->schedulerArmedDay = EM_SCHEDULER_NOT_ARMED;
+	emArmScheduler(em);
+
+	return EM_SUCCESS;
+}
+
+static EventManagerResult emDispatchSchedulerUnlocked(EventManager em)
+{
+	if (em->schedulerTimer < 0)
+	{
+		return EM_ERROR;
+	}
+
+	// Only clears the readiness, the elapsed days are taken from the clock
+	uint64_t expirations;
+	if (read(em->schedulerTimer, &expirations, sizeof(expirations)) < 0 && errno != EAGAIN)
+	{
+		return EM_ERROR;
+	}
+
+	int64_t elapsed = (emSchedulerNow() - em->schedulerOrigin) / em->schedulerDayLength;
+	int days = em->schedulerOriginDay + (int)elapsed - emDateToDayNumber(em->currentDate);
+	if (days > 0)
+	{
+		EventManagerResult result = emTickUnlocked(em, days);
+		if (result != EM_SUCCESS)
+		{
+			return result;
+		}
+	}
+
+	// The timer went off, so it is armed again even if the next event is still on the same day
+	em->schedulerArmedDay = EM_SCHEDULER_NOT_ARMED;
+	return EM_SUCCESS;
+}
+#endif
+
+EventManagerResult emStartScheduler(EventManager em, int day_length_ms)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+#ifdef __linux__
+	emLockForWriting(em);
+	EventManagerResult result = emStartSchedulerUnlocked(em, day_length_ms);
+	emReleaseWriteLock(em);
+	return result;
+#else
+	return EM_ERROR;
+#endif
+}
+
+int emGetSchedulerFd(EventManager em)
+{
+	if (em == NULL)
+	{
+		return -1;
+	}
+
+	emLockForReading(em);
+	int fd = em->schedulerTimer;
+	emUnlockAfterReading(em);
+
+	return fd;
+}
+
+EventManagerResult emDispatchScheduler(EventManager em)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+#ifdef __linux__
+	emLockForWriting(em);
+	return emUnlockAfterWriting(em, emDispatchSchedulerUnlocked(em));
+#else
+	return EM_ERROR;
+#endif
+}
+
+EventManagerResult emRunScheduler(EventManager em, int day_length_ms)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+#ifdef __linux__
+	emLockForWriting(em);
+	EventManagerResult result = emStartSchedulerUnlocked(em, day_length_ms);
+	em->schedulerLooping = result == EM_SUCCESS;
+	emReleaseWriteLock(em);
+	if (result != EM_SUCCESS)
+	{
+		return result;
+	}
+
+	// Both descriptors stay open until the loop ends, since emStopScheduler leaves closing them to it
+	struct pollfd fds[2] = { { em->schedulerTimer, POLLIN, 0 }, { em->schedulerStop, POLLIN, 0 } };
+	while (true)
+	{
+		if (poll(fds, 2, -1) < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			result = EM_ERROR;
+			break;
+		}
+		if (fds[1].revents & POLLIN)
+		{
+			break;
+		}
+		if (fds[0].revents & POLLIN)
+		{
+			result = emDispatchScheduler(em);
+			// After EM_OUT_OF_MEMORY the manager, scheduler included, was destroyed
+			if (result == EM_OUT_OF_MEMORY)
+			{
+				return result;
+			}
+			if (result != EM_SUCCESS)
+			{
+				break;
+			}
+		}
+	}
+
+	emLockForWriting(em);
+	em->schedulerLooping = false;
+	emCloseScheduler(em);
+	emReleaseWriteLock(em);
+
+	return result;
+#else
+	(void)day_length_ms;
+	return EM_ERROR;
+#endif
+}
+
+EventManagerResult emStopScheduler(EventManager em)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	EventManagerResult result = EM_SUCCESS;
+	emLockForWriting(em);
+#ifdef __linux__
+	if (em->schedulerLooping)
+	{
+		// EAGAIN means the counter is already too high to add to, so the loop has a signal to see anyway
+		uint64_t signal = 1;
+		ssize_t written;
+		do
+		{
+			written = write(em->schedulerStop, &signal, sizeof(signal));
+		} while (written < 0 && errno == EINTR);
+		if (written < 0 && errno != EAGAIN)
+		{
+			result = EM_ERROR;
+		}
+	}
+	else
+	{
+		emCloseScheduler(em);
+	}
+#endif
+	emReleaseWriteLock(em);
+
+	return result;
+}
+
+int emGetEventsAmount(EventManager em)
+{
+	if (em == NULL)
+	{
+		return -1;
+	}
+
+	// The thread of a transaction sees its own changes, which are published when it ends
+	if (em->epoch != NULL && !emOwnsTransaction(em))
+	{
+		return atomic_load(&em->publishedEventsAmount);
+	}
+
+	return pqGetSize(em->events);
+}
+
+char* emGetNextEvent(EventManager em)
+{
+	if (em == NULL)
+	{
+		return NULL;
+	}
+
+	if (em->epoch == NULL || emOwnsTransaction(em))
+	{
+		Event nextEvent = pqPositionGetElement(pqGetFirstPosition(em->events));
+		return nextEvent == NULL ? NULL : (char*)nextEvent->name;
+	}
+
+	// The published event cannot be freed before epochExit. Names are interned and never freed while the manager
+	// lives, so the name stays valid after it
+	int token = epochEnter(em->epoch);
+	Event nextEvent = atomic_load(&em->publishedNextEvent);
+	const char* name = nextEvent == NULL ? NULL : nextEvent->name;
+	epochExit(em->epoch, token);
+
+	return (char*)name;
+}
+
+int emGetEventsInRange(EventManager em, Date from, Date to, EventManagerEventVisitor visitor, void* context)
+{
+	if (em == NULL || from == NULL || to == NULL || visitor == NULL)
+	{
+		return -1;
+	}
+
+	// No event has a queue order of 0, so the key comes before every event of the from date
+	struct Event_t key;
+	key.date = from;
+	key.queueOrder = 0;
+
+	int count = 0;
+	emLockForReading(em);
+	for (AvlNode node = avlTreeLowerBound(em->eventsByDate, &key); node != NULL; node = avlTreeGetNextNode(node))
+	{
+		Event event = avlNodeGetElement(node);
+		if (dateCompare(event->date, to) > 0)
+		{
+			break;
+		}
+		count++;
+		if (!visitor(context, event->id, event->name, event->date))
+		{
+			break;
+		}
+	}
+	emUnlockAfterReading(em);
+
+	return count;
+}
+
+int emGetNextEvents(EventManager em, int k, int* out_ids)
+{
+	if (em == NULL || out_ids == NULL)
+	{
+		return -1;
+	}
+
+	int count = 0;
+	emLockForReading(em);
+	for (AvlNode node = avlTreeGetFirstNode(em->eventsByDate); node != NULL && count < k;
+		node = avlTreeGetNextNode(node))
+	{
+		out_ids[count++] = ((Event)avlNodeGetElement(node))->id;
+	}
+	emUnlockAfterReading(em);
+
+	return count;
+}
+
+const char* emGetEventName(EventManager em, int event_id)
+{
+	if (em == NULL)
+	{
+		return NULL;
+	}
+
+	emLockForReading(em);
+	Event event = emGetEventById(em, event_id);
+	const char* name = event == NULL ? NULL : event->name;
+	emUnlockAfterReading(em);
+
+	return name;
+}
+
+static TextWriter emGetWriter(EventManager em)
+{
+	// The export buffer is allocated by the first export and reused by all later ones
+	if (em->writer == NULL)
+	{
+		em->writer = textWriterCreate(EM_EXPORT_BUFFER_SIZE);
+	}
+
+	return em->writer;
+}
+
+static void emWriteEventNameAndDate(TextWriter writer, const char* name, int day, int month, int year)
+{
+	textWriterAppendString(writer, name);
+	textWriterAppendChar(writer, ',');
+	textWriterAppendInt(writer, day);
+	textWriterAppendChar(writer, '.');
+	textWriterAppendInt(writer, month);
+	textWriterAppendChar(writer, '.');
+	textWriterAppendInt(writer, year);
+}
+
+static void emWriteEvent(TextWriter writer, Event event)
+{
+	int day, month, year;
+	dateGet(event->date, &day, &month, &year);
+
+	emWriteEventNameAndDate(writer, event->name, day, month, year);
+	PQ_FOREACH_POSITION(memberPosition, event->members)
+	{
+		Member member = pqPositionGetElement(memberPosition);
+		textWriterAppendChar(writer, ',');
+		textWriterAppendString(writer, member->name);
+	}
+	textWriterAppendChar(writer, '\n');
+}
+
+static bool emFileSinkWrite(void* context, const char* data, int length)
+{
+	return fwrite(data, 1, length, (FILE*)context) == (size_t)length;
+}
+
+EventManagerSink emFileSink(FILE* file)
+{
+	EventManagerSink sink = { emFileSinkWrite, file };
+	return sink;
+}
+
+EventManagerSink emFdSink(int fd)
+{
+	EventManagerSink sink = { textWriterFdOutput, (void*)(intptr_t)fd };
+	return sink;
+}
+
+static TextWriter emBeginExport(EventManager em, EventManagerSink sink, EventManagerResult* result)
+{
+	if (em == NULL || sink.write == NULL)
+	{
+		*result = EM_NULL_ARGUMENT;
+		return NULL;
+	}
+
+	// Readers of a thread safe manager export at the same time, so each export formats into its own buffer
+	TextWriter writer = em->threadSafe ? textWriterCreate(EM_EXPORT_BUFFER_SIZE) : emGetWriter(em);
+	if (writer == NULL)
+	{
+		*result = EM_OUT_OF_MEMORY;
+		return NULL;
+	}
+
+	textWriterBegin(writer, sink.write, sink.context);
+	return writer;
+}
+
+static EventManagerResult emEndExport(EventManager em, TextWriter writer)
+{
+	bool written = textWriterEnd(writer);
+	if (writer != em->writer)
+	{
+		textWriterDestroy(writer);
+	}
+
+	return written ? EM_SUCCESS : EM_ERROR;
+}
+
+static EventManagerResult emSetExportThreadsUnlocked(EventManager em, int threads)
+{
+	if (threads <= 1)
+	{
+		threads = 0;
+	}
+	if (threads == em->exportThreads)
+	{
+		return EM_SUCCESS;
+	}
+
+	ThreadPool pool = NULL;
+	ExportChunk chunks = NULL;
+	if (threads > 0)
+	{
+		pool = threadPoolCreate(threads);
+		chunks = calloc(2 * threads, sizeof(*chunks));
+		bool result = pool != NULL && chunks != NULL;
+		for (int i = 0; result && i < 2 * threads; i++)
+		{
+			chunks[i].writer = textWriterCreate(EM_EXPORT_CHUNK_BUFFER_SIZE);
+			result = chunks[i].writer != NULL;
+		}
+		if (!result)
+		{
+			threadPoolDestroy(pool);
+			emDestroyExportChunks(chunks, 2 * threads);
+			return EM_OUT_OF_MEMORY;
+		}
+	}
+
+	threadPoolDestroy(em->exportPool);
+	emDestroyExportChunks(em->exportChunks, 2 * em->exportThreads);
+	em->exportPool = pool;
+	em->exportChunks = chunks;
+	em->exportThreads = threads;
+	return EM_SUCCESS;
+}
+
+EventManagerResult emSetExportThreads(EventManager em, int threads)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	// Exports use the pool while holding the lock for reading, so it is only replaced while no export runs
+	emLockForWriting(em);
+	EventManagerResult result = emSetExportThreadsUnlocked(em, threads);
+	emReleaseWriteLock(em);
+
+	return result;
+}
+
+// Output function of the chunk writers, which collects the text of a chunk in memory
+static bool emExportChunkWrite(void* context, const char* data, int length)
+{
+	ExportChunk chunk = context;
+	if (length > chunk->capacity - chunk->length)
+	{
+		int capacity = chunk->capacity == 0 ? EM_EXPORT_CHUNK_BUFFER_SIZE : chunk->capacity;
+		while (length > capacity - chunk->length)
+		{
+			capacity *= 2;
+		}
+		char* newData = realloc(chunk->data, capacity);
+		if (newData == NULL)
+		{
+			return false;
+		}
+		chunk->data = newData;
+		chunk->capacity = capacity;
+	}
+
+	memcpy(chunk->data + chunk->length, data, length);
+	chunk->length += length;
+	return true;
+}
+
+// Runs on a worker of the export pool. Every chunk holds different events, so the chunks share nothing
+static void emFormatExportChunk(void* context, int index)
+{
+	ExportChunk chunk = (ExportChunk)context + index;
+	chunk->length = 0;
+	textWriterBegin(chunk->writer, emExportChunkWrite, chunk);
+	for (int i = 0; i < chunk->count; i++)
+	{
+		emWriteEvent(chunk->writer, chunk->events[i]);
+	}
+	chunk->failed = !textWriterEnd(chunk->writer);
+}
+
+// Fills a set of chunks with the events from first on, and returns the number of chunks used
+static int emFillExportChunks(ExportChunk chunks, int chunkCount, Event* events, int first, int count)
+{
+	int used = 0;
+	while (used < chunkCount && first < count)
+	{
+		chunks[used].events = events + first;
+		chunks[used].count = count - first < EM_EXPORT_CHUNK_EVENTS ? count - first : EM_EXPORT_CHUNK_EVENTS;
+		first += chunks[used].count;
+		used++;
+	}
+
+	return used;
+}
+
+/*
+* Formats the events on the export pool, one round of chunks at a time. While the workers format a round,
+* this thread writes the previous one to the sink in order, so the output is the same as a serial export.
+*/
+static EventManagerResult emWriteAllEventsInParallel(EventManager em, EventManagerSink sink)
+{
+	int count = pqGetSize(em->events);
+	Event* events = malloc(count * sizeof(*events));
+	if (events == NULL)
+	{
+		return EM_OUT_OF_MEMORY;
+	}
+	int index = 0;
+	PQ_FOREACH_POSITION(eventPosition, em->events)
+	{
+		Event event = pqPositionGetElement(eventPosition);
+		events[index++] = event;
+	}
+
+	int roundSize = em->exportThreads;
+	int roundEvents = roundSize * EM_EXPORT_CHUNK_EVENTS;
+	ExportChunk current = em->exportChunks;
+	ExportChunk next = em->exportChunks + roundSize;
+	int currentCount = emFillExportChunks(current, roundSize, events, 0, count);
+	threadPoolStart(em->exportPool, emFormatExportChunk, current, currentCount);
+
+	EventManagerResult result = EM_SUCCESS;
+	for (int first = roundEvents; currentCount > 0; first += roundEvents)
+	{
+		threadPoolWait(em->exportPool);
+		int nextCount = result == EM_SUCCESS ? emFillExportChunks(next, roundSize, events, first, count) : 0;
+		threadPoolStart(em->exportPool, emFormatExportChunk, next, nextCount);
+
+		for (int i = 0; i < currentCount && result == EM_SUCCESS; i++)
+		{
+			if (current[i].failed)
+			{
+				result = EM_OUT_OF_MEMORY;
+			}
+			else if (current[i].length > 0 && !sink.write(sink.context, current[i].data, current[i].length))
+			{
+				result = EM_ERROR;
+			}
+		}
+
+		ExportChunk written = current;
+		current = next;
+		next = written;
+		currentCount = nextCount;
+	}
+	threadPoolWait(em->exportPool);
+
+	free(events);
+	return result;
+}
+
+static EventManagerResult emWriteAllEventsUnlocked(EventManager em, EventManagerSink sink)
+{
+	if (sink.write != NULL && em->exportPool != NULL && pqGetSize(em->events) > EM_EXPORT_CHUNK_EVENTS)
+	{
+		// The pool and its chunks serve one export at a time
+		emLockExports(em);
+		EventManagerResult result = emWriteAllEventsInParallel(em, sink);
+		emUnlockExports(em);
+		return result;
+	}
+
+	EventManagerResult result;
+	TextWriter writer = emBeginExport(em, sink, &result);
+	if (writer == NULL)
+	{
+		return result;
+	}
+
+	PQ_FOREACH_POSITION(eventPosition, em->events)
+	{
+		Event event = pqPositionGetElement(eventPosition);
+		emWriteEvent(writer, event);
+	}
+
+	return emEndExport(em, writer);
+}
+
+EventManagerResult emWriteAllEvents(EventManager em, EventManagerSink sink)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	emLockForReading(em);
+	EventManagerResult result = emWriteAllEventsUnlocked(em, sink);
+	emUnlockAfterReading(em);
+
+	return result;
+}
+
+void emPrintAllEvents(EventManager em, const char* file_name)
+{
+	if (em == NULL || file_name == NULL)
+	{
+		return;
+	}
+
+	FILE* file = fopen(file_name, "w");
+	if (file == NULL)
+	{
+		return;
+	}
+
+	emWriteAllEvents(em, emFileSink(file));
+	fclose(file);
+}
+
+/** An event as it was when an asynchronous export started */
+typedef struct ExportedEvent_t
+{
+	const char* name;
+	int day;
+	int month;
+	int year;
+	int memberCount;
+} ExportedEvent;
+
+/** An asynchronous export, owned by the background thread once it is queued */
+typedef struct ExportJob_t
+{
+	EventManager em;
+	// The export queued after this one, run by the same task
+	struct ExportJob_t* next;
+	char* path;
+	EventManagerExportDone done;
+	void* context;
+	ExportedEvent* events;
+	int eventCount;
+	// The member names of all events, event after event
+	const char** memberNames;
+} *ExportJob;
+
+static void emDestroyExportJob(ExportJob job)
+{
+	free(job->path);
+	free(job->events);
+	free(job->memberNames);
+	free(job);
+}
+
+/*
+* Copies what the export needs out of the live queues. Names are interned and never freed or changed while the
+* manager lives, so the copy only holds pointers to them and costs a few words per event and per link.
+*/
+static ExportJob emCaptureExportJob(EventManager em, const char* path)
+{
+	int eventCount = pqGetSize(em->events);
+	// Sized for two members per event at first, since counting the links would mean one more walk over the queues
+	int namesCapacity = 2 * eventCount + 16;
+
+	ExportJob job = malloc(sizeof(*job));
+	char* pathCopy = malloc(strlen(path) + 1);
+	ExportedEvent* events = malloc((eventCount + 1) * sizeof(*events));
+	const char** memberNames = malloc(namesCapacity * sizeof(*memberNames));
+	if (job == NULL || pathCopy == NULL || events == NULL || memberNames == NULL)
+	{
+		free(job);
+		free(pathCopy);
+		free(events);
+		free(memberNames);
+		return NULL;
+	}
+
+	strcpy(pathCopy, path);
+	job->path = pathCopy;
+	job->events = events;
+	job->eventCount = eventCount;
+	job->memberNames = memberNames;
+
+	int namesCount = 0;
+	PQ_FOREACH_POSITION(eventPosition, em->events)
+	{
+		Event event = pqPositionGetElement(eventPosition);
+		events->name = event->name;
+		dateGet(event->date, &events->day, &events->month, &events->year);
+		events->memberCount = pqGetSize(event->members);
+		if (events->memberCount > namesCapacity - namesCount)
+		{
+			while (events->memberCount > namesCapacity - namesCount)
+			{
+				namesCapacity *= 2;
+			}
+			const char** newNames = realloc(job->memberNames, namesCapacity * sizeof(*newNames));
+			if (newNames == NULL)
+			{
+				emDestroyExportJob(job);
+				return NULL;
+			}
+			job->memberNames = newNames;
+		}
+		PQ_FOREACH_POSITION(memberPosition, event->members)
+		{
+			Member member = pqPositionGetElement(memberPosition);
+			job->memberNames[namesCount++] = member->name;
+		}
+		events++;
+	}
+
+	return job;
+}
+
+// Runs on the background thread, which only reads the captured copy
+static void emWriteExportJob(ExportJob job)
+{
+	EventManagerResult result = EM_ERROR;
+	TextWriter writer = textWriterCreate(EM_EXPORT_BUFFER_SIZE);
+	FILE* file = writer == NULL ? NULL : fopen(job->path, "w");
+	if (writer == NULL)
+	{
+		result = EM_OUT_OF_MEMORY;
+	}
+	else if (file != NULL)
+	{
+		textWriterBegin(writer, emFileSinkWrite, file);
+		const char** memberNames = job->memberNames;
+		for (int i = 0; i < job->eventCount; i++)
+		{
+			ExportedEvent* event = &job->events[i];
+			emWriteEventNameAndDate(writer, event->name, event->day, event->month, event->year);
+			for (int j = 0; j < event->memberCount; j++)
+			{
+				textWriterAppendChar(writer, ',');
+				textWriterAppendString(writer, *memberNames++);
+			}
+			textWriterAppendChar(writer, '\n');
+		}
+		bool written = textWriterEnd(writer);
+		result = fclose(file) == 0 && written ? EM_SUCCESS : EM_ERROR;
+	}
+	textWriterDestroy(writer);
+
+	if (job->done != NULL)
+	{
+		job->done(job->path, result, job->context);
+	}
+}
+
+// The task of the background thread, which runs the exports queued behind the first one until none is left
+static void emRunExportJob(void* context, int index)
+{
+	(void)index;
+	ExportJob job = context;
+	while (job != NULL)
+	{
+		emWriteExportJob(job);
+
+		EventManager em = job->em;
+		emLockExportQueue(em);
+		ExportJob next = job->next;
+		if (next == NULL)
+		{
+			em->lastExportJob = NULL;
+		}
+		emUnlockExportQueue(em);
+
+		emDestroyExportJob(job);
+		job = next;
+	}
+}
+
+static EventManagerResult emExportAsyncUnlocked(EventManager em, const char* path, EventManagerExportDone done,
+	void* context)
+{
+	// The background thread is started by the first asynchronous export and kept for the later ones
+	if (em->exportWorker == NULL)
+	{
+		em->exportWorker = threadPoolCreate(1);
+		if (em->exportWorker == NULL)
+		{
+			return EM_OUT_OF_MEMORY;
+		}
+#ifndef _WIN32
+		pthread_mutex_init(&em->exportQueueLock, NULL);
+#endif
+	}
+
+	ExportJob job = emCaptureExportJob(em, path);
+	if (job == NULL)
+	{
+		return EM_OUT_OF_MEMORY;
+	}
+	job->em = em;
+	job->next = NULL;
+	job->done = done;
+	job->context = context;
+
+	// While an export runs the copy is queued behind it, so the lock for reading is never held waiting for a write
+	emLockExportQueue(em);
+	ExportJob last = em->lastExportJob;
+	em->lastExportJob = job;
+	if (last != NULL)
+	{
+		last->next = job;
+	}
+	emUnlockExportQueue(em);
+
+	if (last == NULL)
+	{
+		// The task which ran the previous exports may still be returning, it takes no lock on the way out
+		threadPoolWait(em->exportWorker);
+		threadPoolStart(em->exportWorker, emRunExportJob, job, 1);
+	}
+	return EM_SUCCESS;
+}
+
+EventManagerResult emExportAsync(EventManager em, const char* path, EventManagerExportDone done, void* context)
+{
+	if (em == NULL || path == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	// The copy is taken under the lock for reading, and the export lock keeps other readers off the worker
+	emLockForReading(em);
+	emLockExports(em);
+	EventManagerResult result = emExportAsyncUnlocked(em, path, done, context);
+	emUnlockExports(em);
+	emUnlockAfterReading(em);
+
+	return result;
+}
+
+EventManagerResult emWaitForExport(EventManager em)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	// The worker is kept once it is created, and is waited for without the export lock so exports can still be queued
+	emLockExports(em);
+	ThreadPool exportWorker = em->exportWorker;
+	emUnlockExports(em);
+	threadPoolWait(exportWorker);
+
+	return EM_SUCCESS;
+}
+
+int emGetTopResponsibleMembers(EventManager em, int n, int* out_ids, int* out_counts)
+{
+	if (em == NULL || out_ids == NULL || out_counts == NULL)
+	{
+		return -1;
+	}
+
+	int count = 0;
+	emLockForReading(em);
+	for (AvlNode node = avlTreeGetFirstNode(em->responsibleMembers); node != NULL && count < n;
+		node = avlTreeGetNextNode(node))
+	{
+		Member member = avlNodeGetElement(node);
+		out_ids[count] = member->id;
+		out_counts[count] = member->countEvents;
+		count++;
+	}
+	emUnlockAfterReading(em);
+
+	return count;
+}
+
+static EventManagerResult emWriteResponsibleMembersUnlocked(EventManager em, EventManagerSink sink)
+{
+	EventManagerResult result;
+	TextWriter writer = emBeginExport(em, sink, &result);
+	if (writer == NULL)
+	{
+		return result;
+	}
+
+	AVL_FOREACH(AvlNode, node, em->responsibleMembers)
+	{
+		Member member = avlNodeGetElement(node);
+		textWriterAppendString(writer, member->name);
+		textWriterAppendChar(writer, ',');
+		textWriterAppendInt(writer, member->countEvents);
+		textWriterAppendChar(writer, '\n');
+	}
+
+	return emEndExport(em, writer);
+}
+
+EventManagerResult emWriteResponsibleMembers(EventManager em, EventManagerSink sink)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	emLockForReading(em);
+	EventManagerResult result = emWriteResponsibleMembersUnlocked(em, sink);
+	emUnlockAfterReading(em);
+
+	return result;
 }
 
 void emPrintAllResponsibleMembers(EventManager em, const char* file_name)
 {
-	if (em == NULL || file_name == NULL)
+	if (em == NULL || file_name == NULL)
+	{
+		return;
+	}
+
+	FILE* file = fopen(file_name, "w");
+	if (file == NULL)
+	{
+		return;
+	}
+
+	emWriteResponsibleMembers(em, emFileSink(file));
+	fclose(file);
+}
+
+uint64_t emGetVersion(EventManager em)
+{
+	if (em == NULL)
+	{
+		return 0;
+	}
+
+	emLockForReading(em);
+	uint64_t version = em->sequence;
+	emUnlockAfterReading(em);
+
+	return version;
+}
+
+// Returns the index of the first removal made after version
+static int emFindRemovalAfter(EventManager em, uint64_t version)
+{
+	int low = 0;
+	int high = em->removalsCount;
+	while (low < high)
+	{
+		int middle = low + (high - low) / 2;
+		if (em->removals[middle].version <= version)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	return low;
+}
+
+static EventManagerResult emExportChangesSinceUnlocked(EventManager em, uint64_t version, EventManagerSink sink,
+	uint64_t* new_version)
+{
+	EventManagerResult result;
+	TextWriter writer = emBeginExport(em, sink, &result);
+	if (writer == NULL)
+	{
+		return result;
+	}
+
+	if (version < em->changesStart || version > em->sequence)
+	{
+		emEndExport(em, writer);
+		return EM_ERROR;
+	}
+
+	for (int i = emFindRemovalAfter(em, version); i < em->removalsCount; i++)
+	{
+		textWriterAppendString(writer, em->removals[i].expired ? "E," : "R,");
+		textWriterAppendInt(writer, em->removals[i].id);
+		textWriterAppendChar(writer, '\n');
+	}
+
+	// The list is ordered by version, so only the events changed after version are visited
+	Event first = NULL;
+	for (Event event = em->lastChange; event != NULL && event->changedVersion > version; event = event->previousChange)
+	{
+		first = event;
+	}
+	for (Event event = first; event != NULL; event = event->nextChange)
+	{
+		textWriterAppendString(writer, event->addedVersion > version ? "A," : "C,");
+		textWriterAppendInt(writer, event->id);
+		textWriterAppendChar(writer, ',');
+		emWriteEvent(writer, event);
+	}
+
+	if (emEndExport(em, writer) != EM_SUCCESS)
+	{
+		return EM_ERROR;
+	}
+
+	*new_version = em->sequence;
+	return EM_SUCCESS;
+}
+
+EventManagerResult emExportChangesSince(EventManager em, uint64_t version, EventManagerSink sink, uint64_t* new_version)
+{
+	if (em == NULL || new_version == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	emLockForReading(em);
+	EventManagerResult result = emExportChangesSinceUnlocked(em, version, sink, new_version);
+	emUnlockAfterReading(em);
+
+	return result;
+}
+
+static EventManagerResult emForgetChangesBeforeUnlocked(EventManager em, uint64_t version)
+{
+	if (version > em->sequence)
+	{
+		return EM_ERROR;
+	}
+
+	if (version > em->changesStart)
+	{
+		int forgotten = emFindRemovalAfter(em, version);
+		if (forgotten > 0)
+		{
+			memmove(em->removals, em->removals + forgotten, (em->removalsCount - forgotten) * sizeof(*em->removals));
+			em->removalsCount -= forgotten;
+		}
+		em->changesStart = version;
+	}
+
+	return EM_SUCCESS;
+}
+
+EventManagerResult emForgetChangesBefore(EventManager em, uint64_t version)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	emLockForWriting(em);
+	EventManagerResult result = emForgetChangesBeforeUnlocked(em, version);
+	emReleaseWriteLock(em);
+
+	return result;
+}
+
+/*
+* Snapshot file layout, all fields fixed width in the byte order of the machine:
+*   SnapshotHeader
+*   String table	- stringCount NUL terminated names, zero padded to stringBytes (a multiple of 4)
+*   Member table	- memberCount SnapshotMember records in id order
+*   Event table		- eventCount SnapshotEvent records in queue order
+*   Link table		- linkCount member ids, the linkCount ids of every event in event table order
+* Dates are stored as day numbers and names as indices into the string table.
+* The checksum covers everything after the header. The sequence of the manager is saved, so a journal
+* replayed over the snapshot skips the mutations the snapshot already holds.
+*/
+typedef struct SnapshotHeader_t
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t checksum;
+	int32_t createdDay;
+	int32_t currentDay;
+	uint32_t stringCount;
+	uint32_t stringBytes;
+	uint32_t memberCount;
+	uint32_t eventCount;
+	uint32_t linkCount;
+	uint64_t sequence;
+} SnapshotHeader;
+
+typedef struct SnapshotMember_t
+{
+	int32_t id;
+	uint32_t name;
+} SnapshotMember;
+
+typedef struct SnapshotEvent_t
+{
+	int32_t id;
+	int32_t day;
+	uint32_t name;
+	uint32_t linkCount;
+} SnapshotEvent;
+
+typedef struct SnapshotString_t
+{
+	const char* name;
+	uint32_t index;
+} *SnapshotString;
+
+static unsigned int hashSnapshotStringGeneric(HashElement n) {
+	return hashInt((unsigned int)((uintptr_t)((SnapshotString)n)->name >> 4));
+}
+
+static bool equalSnapshotStringsGeneric(HashElement n1, HashElement n2) {
+	return ((SnapshotString)n1)->name == ((SnapshotString)n2)->name;
+}
+
+static uint32_t emSnapshotChecksum(const uint32_t* words, size_t count)
+{
+	// FNV-1a over 32 bit words instead of bytes
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < count; i++)
+	{
+		hash = (hash ^ words[i]) * 16777619u;
+	}
+
+	return hash;
+}
+
+// Gives name the next index of the string table, unless it already has one
+static bool emSnapshotAddString(HashTable table, SnapshotString entries, uint32_t* count, size_t* bytes,
+	const char* name, uint32_t* index)
+{
+	SnapshotString entry = &entries[*count];
+	entry->name = name;
+	SnapshotString existing = hashTableFind(table, entry);
+	if (existing != NULL)
+	{
+		*index = existing->index;
+		return true;
+	}
+
+	entry->index = *count;
+	if (hashTableInsert(table, entry) != HT_SUCCESS)
+	{
+		return false;
+	}
+
+	(*count)++;
+	*bytes += strlen(name) + 1;
+	*index = entry->index;
+	return true;
+}
+
+// Writes to a temporary file which replaces path only once it is complete, so a crash never leaves a partial snapshot
+static bool emWriteFileAtomically(const char* path, const char* data, size_t size)
+{
+	size_t pathLength = strlen(path);
+	char* temporaryPath = malloc(pathLength + sizeof(".tmp"));
+	if (temporaryPath == NULL)
+	{
+		return false;
+	}
+	memcpy(temporaryPath, path, pathLength);
+	memcpy(temporaryPath + pathLength, ".tmp", sizeof(".tmp"));
+
+	FILE* file = fopen(temporaryPath, "wb");
+	bool result = file != NULL && fwrite(data, 1, size, file) == size && fflush(file) == 0;
+#ifndef _WIN32
+	result = result && fsync(fileno(file)) == 0;
+#endif
+	if (file != NULL && fclose(file) != 0)
+	{
+		result = false;
+	}
+#ifdef _WIN32
+	if (result)
+	{
+		remove(path);
+	}
+#endif
+	result = result && rename(temporaryPath, path) == 0;
+	if (!result)
+	{
+		remove(temporaryPath);
+	}
+
+	free(temporaryPath);
+	return result;
+}
+
+static EventManagerResult emSaveSnapshotUnlocked(EventManager em, const char* path)
+{
+	int memberCount = pqGetSize(em->members);
+	int eventCount = pqGetSize(em->events);
+	int recordCount = memberCount + eventCount;
+
+	// nameIndices[] holds the string of every member and then of every event, in the order they are written
+	SnapshotString strings = malloc((recordCount + 1) * sizeof(*strings));
+	uint32_t* nameIndices = malloc((recordCount + 1) * sizeof(*nameIndices));
+	HashTable stringIndex = hashTableCreate(hashSnapshotStringGeneric, equalSnapshotStringsGeneric);
+	bool result = strings != NULL && nameIndices != NULL && stringIndex != NULL;
+
+	uint32_t stringCount = 0;
+	size_t stringBytes = 0;
+	size_t linkCount = 0;
+	int record = 0;
+	if (result)
+	{
+		PQ_FOREACH_POSITION(memberPosition, em->members)
+		{
+			Member member = pqPositionGetElement(memberPosition);
+			result = result && emSnapshotAddString(stringIndex, strings, &stringCount, &stringBytes, member->name,
+				&nameIndices[record++]);
+		}
+		PQ_FOREACH_POSITION(eventPosition, em->events)
+		{
+			Event event = pqPositionGetElement(eventPosition);
+			result = result && emSnapshotAddString(stringIndex, strings, &stringCount, &stringBytes, event->name,
+				&nameIndices[record++]);
+			linkCount += pqGetSize(event->members);
+		}
+	}
+	hashTableDestroy(stringIndex);
+
+	stringBytes = (stringBytes + sizeof(uint32_t) - 1) / sizeof(uint32_t) * sizeof(uint32_t);
+	size_t size = sizeof(SnapshotHeader) + stringBytes + memberCount * sizeof(SnapshotMember)
+		+ eventCount * sizeof(SnapshotEvent) + linkCount * sizeof(int32_t);
+	// calloc leaves the padding of the string table zeroed
+	char* buffer = result ? calloc(1, size) : NULL;
+	if (buffer == NULL)
+	{
+		free(strings);
+		free(nameIndices);
+		return EM_OUT_OF_MEMORY;
+	}
+
+	SnapshotHeader* header = (SnapshotHeader*)buffer;
+	char* stringTable = buffer + sizeof(*header);
+	SnapshotMember* members = (SnapshotMember*)(stringTable + stringBytes);
+	SnapshotEvent* events = (SnapshotEvent*)(members + memberCount);
+	int32_t* links = (int32_t*)(events + eventCount);
+
+	for (uint32_t i = 0; i < stringCount; i++)
+	{
+		size_t length = strlen(strings[i].name) + 1;
+		memcpy(stringTable, strings[i].name, length);
+		stringTable += length;
+	}
+
+	record = 0;
+	PQ_FOREACH_POSITION(memberPosition, em->members)
+	{
+		Member member = pqPositionGetElement(memberPosition);
+		members->id = member->id;
+		members->name = nameIndices[record++];
+		members++;
+	}
+	PQ_FOREACH_POSITION(eventPosition, em->events)
+	{
+		Event event = pqPositionGetElement(eventPosition);
+		events->id = event->id;
+		events->day = emDateToDayNumber(event->date);
+		events->name = nameIndices[record++];
+		events->linkCount = pqGetSize(event->members);
+		events++;
+		PQ_FOREACH_POSITION(memberPosition, event->members)
+		{
+			Member member = pqPositionGetElement(memberPosition);
+			*links++ = member->id;
+		}
+	}
+
+	header->magic = EM_SNAPSHOT_MAGIC;
+	header->version = EM_SNAPSHOT_VERSION;
+	header->createdDay = emDateToDayNumber(em->createdDate);
+	header->currentDay = emDateToDayNumber(em->currentDate);
+	header->stringCount = stringCount;
+	header->stringBytes = stringBytes;
+	header->memberCount = memberCount;
+	header->eventCount = eventCount;
+	header->linkCount = linkCount;
+	header->sequence = em->sequence;
+	header->checksum = emSnapshotChecksum((const uint32_t*)(buffer + sizeof(*header)),
+		(size - sizeof(*header)) / sizeof(uint32_t));
+
+	result = emWriteFileAtomically(path, buffer, size);
+	// The snapshot holds every journaled mutation, so the journal starts over
+	if (result && em->journal != NULL)
+	{
+		result = journalTruncate(em->journal);
+	}
+
+	free(buffer);
+	free(strings);
+	free(nameIndices);
+	return result ? EM_SUCCESS : EM_ERROR;
+}
+
+EventManagerResult emSaveSnapshot(EventManager em, const char* path)
+{
+	if (em == NULL || path == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	// The snapshot would hold changes which are not journaled yet, and may still be rolled back
+	if (emOwnsTransaction(em))
+	{
+		return EM_ERROR;
+	}
+
+	// Writers are kept out while the snapshot is taken. The export lock keeps two snapshots from truncating
+	// the journal at once
+	emLockForReading(em);
+	emLockExports(em);
+	EventManagerResult result = emSaveSnapshotUnlocked(em, path);
+	emUnlockExports(em);
+	emUnlockAfterReading(em);
+
+	return result;
+}
+
+static bool emSnapshotIsValid(const char* data, size_t size)
+{
+	if (data == NULL || size < sizeof(SnapshotHeader))
+	{
+		return false;
+	}
+
+	const SnapshotHeader* header = (const SnapshotHeader*)data;
+	if (header->magic != EM_SNAPSHOT_MAGIC || header->version != EM_SNAPSHOT_VERSION
+		|| header->stringBytes % sizeof(uint32_t) != 0)
+	{
+		return false;
+	}
+
+	uint64_t expectedSize = sizeof(*header) + (uint64_t)header->stringBytes
+		+ (uint64_t)header->memberCount * sizeof(SnapshotMember) + (uint64_t)header->eventCount * sizeof(SnapshotEvent)
+		+ (uint64_t)header->linkCount * sizeof(int32_t);
+	if (expectedSize != size)
+	{
+		return false;
+	}
+
+	// Names are read with string functions, so the table must end with a terminator
+	if (header->stringBytes > 0 && data[sizeof(*header) + header->stringBytes - 1] != '\0')
+	{
+		return false;
+	}
+
+	return emSnapshotChecksum((const uint32_t*)(data + sizeof(*header)), (size - sizeof(*header)) / sizeof(uint32_t))
+		== header->checksum;
+}
+
+static bool emRestoreNames(EventManager em, const SnapshotHeader* header, const char** names)
+{
+	const char* strings = (const char*)(header + 1);
+	size_t offset = 0;
+	for (uint32_t i = 0; i < header->stringCount; i++)
+	{
+		if (offset >= header->stringBytes)
+		{
+			return false;
+		}
+
+		names[i] = stringTableIntern(em->names, strings + offset);
+		if (names[i] == NULL)
+		{
+			return false;
+		}
+		offset += strlen(strings + offset) + 1;
+	}
+
+	return true;
+}
+
+static bool emRestoreMembers(EventManager em, const SnapshotHeader* header, const SnapshotMember* records,
+	const char** names)
+{
+	int count = header->memberCount;
+	if (count == 0)
+	{
+		return true;
+	}
+
+	// restored[] holds the new members and restored[count + i] the id each one is queued by
+	Member* restored = malloc(2 * count * sizeof(*restored));
+	if (restored == NULL)
+	{
+		return false;
+	}
+	int** priorities = (int**)(restored + count);
+
+	int restoredCount = 0;
+	bool result = true;
+	for (int i = 0; i < count && result; i++)
+	{
+		// Members are saved in id order, which also rules out duplicate ids
+		if (records[i].name >= header->stringCount || records[i].id < 0 || (i > 0 && records[i].id <= records[i - 1].id))
+		{
+			result = false;
+			break;
+		}
+
+		Member member = emCreateMember(em, names[records[i].name], records[i].id);
+		if (member == NULL || hashTableInsert(em->membersById, member) != HT_SUCCESS)
+		{
+			arenaRelease(em->arena, member, sizeof(*member));
+			result = false;
+			break;
+		}
+
+		priorities[restoredCount] = &member->id;
+		restored[restoredCount++] = member;
+	}
+
+	if (!result || pqInsertAll(em->members, (PQElement*)restored, (PQElementPriority*)priorities, restoredCount) != PQ_SUCCESS)
+	{
+		// The manager is destroyed by the caller, which only frees the members already in its queue
+		for (int i = 0; i < restoredCount; i++)
+		{
+			arenaRelease(em->arena, restored[i], sizeof(*restored[i]));
+		}
+		result = false;
+	}
+
+	free(restored);
+	return result;
+}
+
+// Links the members listed for an event, which are saved in id order
+static bool emRestoreEventMembers(EventManager em, Event event, const int32_t* memberIds, int count,
+	Member* members, int** priorities)
+{
+	for (int i = 0; i < count; i++)
+	{
+		members[i] = i > 0 && memberIds[i] <= memberIds[i - 1] ? NULL : emGetMemberById(em, memberIds[i]);
+		if (members[i] == NULL)
+		{
+			return false;
+		}
+		priorities[i] = &members[i]->id;
+	}
+
+	if (pqInsertAll(event->members, (PQElement*)members, (PQElementPriority*)priorities, count) != PQ_SUCCESS)
+	{
+		return false;
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		members[i]->countEvents++;
+	}
+	return true;
+}
+
+static bool emRestoreEvents(EventManager em, const SnapshotHeader* header, const SnapshotEvent* records,
+	const int32_t* links, const char** names)
+{
+	int count = header->eventCount;
+	if (count == 0)
+	{
+		return header->linkCount == 0;
+	}
+
+	uint32_t maxLinks = 0;
+	uint64_t totalLinks = 0;
+	for (int i = 0; i < count; i++)
+	{
+		maxLinks = records[i].linkCount > maxLinks ? records[i].linkCount : maxLinks;
+		totalLinks += records[i].linkCount;
+	}
+	if (totalLinks != header->linkCount)
+	{
+		return false;
+	}
+
+	// restored[] holds the new events and restored[count + i] the date each one is queued by
+	Event* restored = malloc(2 * count * sizeof(*restored));
+	Member* linked = malloc((2 * (size_t)maxLinks + 1) * sizeof(*linked));
+	if (restored == NULL || linked == NULL)
+	{
+		free(restored);
+		free(linked);
+		return false;
+	}
+	Date* priorities = (Date*)(restored + count);
+
+	int restoredCount = 0;
+	bool result = true;
+	for (int i = 0; i < count; i++)
+	{
+		const SnapshotEvent* record = &records[i];
+		if (record->name >= header->stringCount || record->id < 0 || record->day < header->currentDay)
+		{
+			result = false;
+			break;
+		}
+
+		Date date = emDateFromDayNumber(em->arena, record->day);
+		Event event = date == NULL ? NULL : emCreateEventWithDate(em, names[record->name], record->id, date);
+		if (event == NULL)
+		{
+			dateDestroyInArena(em->arena, date);
+			result = false;
+			break;
+		}
+
+		priorities[restoredCount] = event->date;
+		restored[restoredCount++] = event;
+		// Indexing fails on a repeated id or name and date as well
+		if (!emIndexEvent(em, event) || !emRestoreEventMembers(em, event, links, record->linkCount, linked,
+			(int**)(linked + maxLinks)))
+		{
+			result = false;
+			break;
+		}
+		links += record->linkCount;
+	}
+
+	if (!result || pqInsertAll(em->events, (PQElement*)restored, (PQElementPriority*)priorities, restoredCount) != PQ_SUCCESS)
+	{
+		// The manager is destroyed by the caller, which only frees the events already in its queue
+		for (int i = 0; i < restoredCount; i++)
+		{
+			emDestroyEvent(em, restored[i]);
+		}
+		result = false;
+	}
+
+	result = result && emIndexEventsByDate(em, restored, restoredCount);
+
+	free(restored);
+	free(linked);
+	return result;
+}
+
+/*
+* Builds the ranking from the event counts of the members. Loaders that set many counts directly call this once
+* at the end, instead of moving a member inside the ranking for every link.
+*/
+static bool emRebuildRanking(EventManager em)
+{
+	AvlTree ranking = avlTreeCreateInArena(em->arena, compareMembersByResponsibilityGeneric);
+	if (ranking == NULL)
+	{
+		return false;
+	}
+
+	PQ_FOREACH(Member, member, em->members)
+	{
+		if (member->countEvents > 0 && avlTreeInsert(ranking, member) != AVL_SUCCESS)
+		{
+			avlTreeDestroy(ranking);
+			return false;
+		}
+	}
+
+	avlTreeDestroy(em->responsibleMembers);
+	em->responsibleMembers = ranking;
+	return true;
+}
+
+static EventManager emRestoreSnapshot(const char* data, size_t size, int options)
+{
+	if (!emSnapshotIsValid(data, size))
+	{
+		return NULL;
+	}
+
+	const SnapshotHeader* header = (const SnapshotHeader*)data;
+	Date createdDate = emDateFromDayNumber(NULL, header->createdDay);
+	Date currentDate = emDateFromDayNumber(NULL, header->currentDay);
+	EventManager em = createdDate == NULL ? NULL : createEventManagerWithOptions(createdDate, options);
+	dateDestroy(createdDate);
+	if (em == NULL || currentDate == NULL)
+	{
+		dateDestroy(currentDate);
+		destroyEventManager(em);
+		return NULL;
+	}
+	dateDestroy(em->currentDate);
+	em->currentDate = currentDate;
+	em->sequence = header->sequence;
+
+	const SnapshotMember* members = (const SnapshotMember*)(data + sizeof(*header) + header->stringBytes);
+	const SnapshotEvent* events = (const SnapshotEvent*)(members + header->memberCount);
+	const int32_t* links = (const int32_t*)(events + header->eventCount);
+
+	// The indexes are sized up front instead of growing through every power of two
+	const char** names = malloc((header->stringCount + 1) * sizeof(*names));
+	bool result = names != NULL && hashTableReserve(em->membersById, header->memberCount) == HT_SUCCESS
+		&& hashTableReserve(em->eventsById, header->eventCount) == HT_SUCCESS
+		&& hashTableReserve(em->eventsByNameAndDate, header->eventCount) == HT_SUCCESS && emRestoreNames(em, header, names) && emRestoreMembers(em, header, members, names)
+		&& emRestoreEvents(em, header, events, links, names) && emRebuildRanking(em);
+	free(names);
+
+	if (!result)
+	{
+		destroyEventManager(em);
+		return NULL;
+	}
+
+	// The snapshot does not keep the history, so the delta exports start from its version
+	em->changesStart = em->sequence;
+	PQ_FOREACH(Event, event, em->events)
+	{
+		emTrackEventChange(em, event, true);
+	}
+	emPublishReadState(em);
+
+	return em;
+}
+
+EventManager emLoadSnapshot(const char* path)
+{
+	return emLoadSnapshotWithOptions(path, EM_OPTION_NONE);
+}
+
+EventManager emLoadSnapshotWithOptions(const char* path, int options)
+{
+	FileMap map = fileMapOpen(path);
+	if (map == NULL)
+	{
+		return NULL;
+	}
+
+	EventManager em = emRestoreSnapshot(fileMapGetData(map), fileMapGetSize(map), options);
+	fileMapClose(map);
+
+	return em;
+}
+
+static EventManagerResult emOpenJournalUnlocked(EventManager em, const char* path)
+{
+	Journal journal = journalOpen(path);
+	if (journal == NULL)
+	{
+		return EM_ERROR;
+	}
+
+	// Whatever was pending in a previous journal is committed before switching. The records of an open transaction
+	// were meant for that journal, so they are dropped
+	journalClose(em->journal);
+	em->journal = journal;
+	em->pendingCount = 0;
+
+	return EM_SUCCESS;
+}
+
+EventManagerResult emOpenJournal(EventManager em, const char* path)
+{
+	if (em == NULL || path == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	emLockForWriting(em);
+	EventManagerResult result = emOpenJournalUnlocked(em, path);
+	emReleaseWriteLock(em);
+
+	return result;
+}
+
+static EventManagerResult emSyncJournalUnlocked(EventManager em)
+{
+	if (em->journal == NULL)
+	{
+		return EM_SUCCESS;
+	}
+
+	return journalSync(em->journal) ? EM_SUCCESS : EM_ERROR;
+}
+
+EventManagerResult emSyncJournal(EventManager em)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	emLockForWriting(em);
+	EventManagerResult result = emSyncJournalUnlocked(em);
+	emReleaseWriteLock(em);
+
+	return result;
+}
+
+static EventManagerResult emCloseJournalUnlocked(EventManager em)
+{
+	if (em->journal == NULL)
+	{
+		return EM_SUCCESS;
+	}
+
+	bool result = journalClose(em->journal);
+	em->journal = NULL;
+	em->pendingCount = 0;
+
+	return result ? EM_SUCCESS : EM_ERROR;
+}
+
+EventManagerResult emCloseJournal(EventManager em)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	emLockForWriting(em);
+	EventManagerResult result = emCloseJournalUnlocked(em);
+	emReleaseWriteLock(em);
+
+	return result;
+}
+
+typedef struct JournalReplay_t
+{
+	EventManager em;
+	EventManagerResult result;
+} JournalReplay;
+
+static EventManagerResult emApplyJournalRecord(EventManager em, const JournalRecord* record)
+{
+	switch (record->type)
+	{
+	case EM_JOURNAL_ADD_EVENT:
+	case EM_JOURNAL_CHANGE_DATE:
+	{
+		Date date = emDateFromDayNumber(NULL, record->second);
+		if (date == NULL)
+		{
+			return EM_ERROR;
+		}
+		EventManagerResult result = record->type == EM_JOURNAL_ADD_EVENT
+			? emAddEventByDateUnlocked(em, (char*)record->name, date, record->first)
+			: emChangeEventDateUnlocked(em, record->first, date);
+		dateDestroy(date);
+		return result;
+	}
+	case EM_JOURNAL_REMOVE_EVENT:
+		return emRemoveEventUnlocked(em, record->first);
+	case EM_JOURNAL_ADD_MEMBER:
+		return emAddMemberUnlocked(em, (char*)record->name, record->first);
+	case EM_JOURNAL_LINK:
+		return emAddMemberToEventUnlocked(em, record->first, record->second);
+	case EM_JOURNAL_UNLINK:
+		return emRemoveMemberFromEventUnlocked(em, record->first, record->second);
+	case EM_JOURNAL_TICK:
+		return emTickUnlocked(em, record->first);
+	case EM_JOURNAL_REMOVE_MEMBER:
+		return emRemoveMemberUnlocked(em, record->first);
+	default:
+		return EM_ERROR;
+	}
+}
+
+static bool emReplayJournalRecord(void* context, const JournalRecord* record)
+{
+	JournalReplay* replay = context;
+	// Mutations up to the sequence of the manager are already part of it, for example through a snapshot
+	if (record->sequence <= replay->em->sequence)
+	{
+		return true;
+	}
+
+	// Every journaled call succeeded, so a record that fails or does not follow the last one means the journal
+	// does not belong to this manager. A rollback follows the last record by the mutations it stands for
+	uint64_t previous = record->sequence - (record->type == EM_JOURNAL_ROLLBACK ? record->first : 1);
+	if (previous != replay->em->sequence)
+	{
+		replay->result = EM_ERROR;
+		return false;
+	}
+
+	if (record->type == EM_JOURNAL_ROLLBACK)
+	{
+		replay->em->sequence = record->sequence;
+		emRecordRollback(replay->em, previous);
+		return true;
+	}
+
+	replay->result = emApplyJournalRecord(replay->em, record);
+	if (replay->result != EM_SUCCESS)
+	{
+		replay->result = replay->result == EM_OUT_OF_MEMORY ? EM_OUT_OF_MEMORY : EM_ERROR;
+		return false;
+	}
+
+	return true;
+}
+
+static EventManagerResult emReplayJournalUnlocked(EventManager em, const char* path)
+{
+	if (em == NULL || path == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	// The replayed calls are not recorded for a rollback
+	if (emInTransaction(em))
+	{
+		return EM_ERROR;
+	}
+
+	JournalReplay replay = { em, EM_SUCCESS };
+	if (!journalRead(path, emReplayJournalRecord, &replay))
+	{
+		return EM_ERROR;
+	}
+
+	return replay.result;
+}
+
+EventManagerResult emReplayJournal(EventManager em, const char* path)
+{
+	if (em == NULL)
 	{
-		return;
+		return EM_NULL_ARGUMENT;
 	}
 
-	FILE* stream;
-	errno_t err = fopen_s(&stream, file_name, "w");
-	if (err != 0)
+	emLockForWriting(em);
+	return emUnlockAfterWriting(em, emReplayJournalUnlocked(em, path));
+}
+
+/*
+* CSV import. Lines are parsed in place in the mapped file: fields are delimited with memchr, numbers are parsed
+* by hand and names are interned straight from the file, so nothing is copied or allocated per field.
+* Lines may end with "\n" or "\r\n", and empty lines are skipped.
+*/
+
+static int emCsvCountLines(const char* data, const char* end)
+{
+	int count = 0;
+	const char* line = data;
+	while (line < end)
 	{
-		return;
+		const char* newline = memchr(line, '\n', end - line);
+		count++;
+		line = newline == NULL ? end : newline + 1;
+	}
+
+	return count;
+}
+
+// Returns the end of the line starting at line, which is where its line break or the file ends
+static const char* emCsvLineEnd(const char* line, const char* end)
+{
+	const char* newline = memchr(line, '\n', end - line);
+	return newline == NULL ? end : newline;
+}
+
+// Returns the end of the contents of a line, without a carriage return before its line break
+static const char* emCsvContentEnd(const char* line, const char* lineEnd)
+{
+	return lineEnd > line && lineEnd[-1] == '\r' ? lineEnd - 1 : lineEnd;
+}
+
+// Returns the end of the field starting at field, which is where the next separator or the line ends
+static const char* emCsvFieldEnd(const char* field, const char* end)
+{
+	const char* separator = memchr(field, ',', end - field);
+	return separator == NULL ? end : separator;
+}
+
+// Parses a decimal integer at *position and moves *position past it
+static bool emCsvParseInt(const char** position, const char* end, int* value)
+{
+	const char* current = *position;
+	bool negative = current < end && *current == '-';
+	if (negative)
+	{
+		current++;
+	}
+
+	const char* digits = current;
+	long long result = 0;
+	while (current < end && *current >= '0' && *current <= '9')
+	{
+		result = result * 10 + (*current - '0');
+		if (result > INT_MAX)
+		{
+			return false;
+		}
+		current++;
+	}
+	if (current == digits)
+	{
+		return false;
+	}
+
+	*value = negative ? -(int)result : (int)result;
+	*position = current;
+	return true;
+}
+
+// Parses "day.month.year" at *position and moves *position past it
+static bool emCsvParseDate(const char** position, const char* end, int* day, int* month, int* year)
+{
+	const char* current = *position;
+	if (!emCsvParseInt(&current, end, day) || current == end || *current++ != '.'
+		|| !emCsvParseInt(&current, end, month) || current == end || *current++ != '.'
+		|| !emCsvParseInt(&current, end, year))
+	{
+		return false;
 	}
 
-	PriorityQueue newMemberQueue = pqCreate(copyMemberGeneric, freeMemberGeneric, equalMembersGeneric, copyIntGeneric, freeIntGeneric, compareIntsLargerHasHigherPriorityGeneric);
+	*position = current;
+	return true;
+}
+
+static unsigned int hashMemberByNameGeneric(HashElement n) {
+	return hashInt((unsigned int)((uintptr_t)((Member)n)->name >> 4));
+}
+
+static bool equalMembersByNameGeneric(HashElement n1, HashElement n2) {
+	return ((Member)n1)->name == ((Member)n2)->name;
+}
+
+// Indexes the members by name. Of members that share a name, the one with the lowest id is kept
+static HashTable emCreateMembersByName(EventManager em)
+{
+	HashTable membersByName = hashTableCreate(hashMemberByNameGeneric, equalMembersByNameGeneric);
+	if (membersByName == NULL || hashTableReserve(membersByName, pqGetSize(em->members)) != HT_SUCCESS)
+	{
+		hashTableDestroy(membersByName);
+		return NULL;
+	}
 
 	PQ_FOREACH(Member, member, em->members)
 	{
-		pqInsert(newMemberQueue, member, &member->countEvents);
+		// Members are visited in id order and the table never grows, so inserting cannot fail
+		hashTableInsert(membersByName, member);
+	}
+
+	return membersByName;
+}
+
+/*
+* Links the members named in the fields from position to end to a new event. Unknown names are skipped.
+* Only the event counts are updated, and the caller rebuilds the ranking once the import is done.
+*/
+static bool emImportEventMembers(EventManager em, Event event, const char* position, const char* end,
+	HashTable* membersByName)
+{
+	while (position < end)
+	{
+		// position is at the separator before the next name
+		const char* name = position + 1;
+		position = emCsvFieldEnd(name, end);
+
+		struct Member_t key;
+		key.name = stringTableFindLength(em->names, name, position - name);
+		if (key.name == NULL)
+		{
+			continue;
+		}
+		if (*membersByName == NULL && (*membersByName = emCreateMembersByName(em)) == NULL)
+		{
+			return false;
+		}
+
+		Member member = hashTableFind(*membersByName, &key);
+		if (member == NULL || pqContains(event->members, member))
+		{
+			continue;
+		}
+		if (pqInsert(event->members, member, &member->id) != PQ_SUCCESS)
+		{
+			return false;
+		}
+		member->countEvents++;
+	}
+
+	return true;
+}
+
+/*
+* Adds the event of a line in the format of emPrintAllEvents.
+* *event is set to the new event, or to NULL if the line was rejected. Returns false if an allocation failed.
+*/
+static bool emImportEventLine(EventManager em, const char* line, const char* end, int event_id, Event* event,
+	HashTable* membersByName)
+{
+	*event = NULL;
+	const char* nameEnd = emCsvFieldEnd(line, end);
+	const char* position = nameEnd + 1;
+	int day, month, year;
+	if (nameEnd == end || nameEnd == line || !emCsvParseDate(&position, end, &day, &month, &year)
+		|| (position < end && *position != ',') || day < 1 || day > EM_DAYS_IN_MONTH || month < 1
+		|| month > EM_MONTHS_IN_YEAR)
+	{
+		return true;
+	}
+
+	// The date is checked as a day number first, so rejected lines allocate nothing
+	int dayNumber = (year * EM_MONTHS_IN_YEAR + month - 1) * EM_DAYS_IN_MONTH + day - 1;
+	if (dayNumber < emDateToDayNumber(em->currentDate) || emGetEventById(em, event_id) != NULL)
+	{
+		return true;
+	}
+
+	const char* name = stringTableInternLength(em->names, line, nameEnd - line);
+	Date date = name == NULL ? NULL : dateCreateInArena(em->arena, day, month, year);
+	if (date == NULL)
+	{
+		return false;
+	}
+
+	struct Event_t key;
+	key.name = name;
+	key.date = date;
+	if (hashTableFind(em->eventsByNameAndDate, &key) != NULL)
+	{
+		dateDestroyInArena(em->arena, date);
+		return true;
+	}
+
+	Event newEvent = emCreateEventWithDate(em, name, event_id, date);
+	if (newEvent == NULL)
+	{
+		dateDestroyInArena(em->arena, date);
+		return false;
+	}
+	if (!emIndexEvent(em, newEvent))
+	{
+		emDestroyEvent(em, newEvent);
+		return false;
+	}
+
+	// The event is handed out before linking, so the caller releases it if linking fails
+	*event = newEvent;
+	return emImportEventMembers(em, newEvent, position, end, membersByName);
+}
+
+static EventManagerResult emImportEvents(EventManager em, const char* data, size_t size, int first_event_id,
+	int* imported)
+{
+	const char* end = data + size;
+	int lineCount = emCsvCountLines(data, end);
+	if (lineCount == 0)
+	{
+		return EM_SUCCESS;
+	}
+
+	// accepted[] holds the new events and accepted[lineCount + i] the date each one is queued by
+	Event* accepted = malloc(2 * lineCount * sizeof(*accepted));
+	if (accepted == NULL)
+	{
+		destroyEventManager(em);
+		return EM_OUT_OF_MEMORY;
+	}
+	Date* priorities = (Date*)(accepted + lineCount);
+
+	// Every line may hold a new event, so the indexes are sized for all of them at once
+	int eventCount = pqGetSize(em->events);
+	if (hashTableReserve(em->eventsById, eventCount + lineCount) != HT_SUCCESS
+		|| hashTableReserve(em->eventsByNameAndDate, eventCount + lineCount) != HT_SUCCESS)
+	{
+		free(accepted);
+		destroyEventManager(em);
+		return EM_OUT_OF_MEMORY;
+	}
+
+	HashTable membersByName = NULL;
+	int acceptedCount = 0;
+	int eventId = first_event_id;
+	bool outOfMemory = false;
+	const char* lineEnd;
+	for (const char* line = data; line < end && !outOfMemory; line = lineEnd + (lineEnd < end))
+	{
+		lineEnd = emCsvLineEnd(line, end);
+		const char* contentEnd = emCsvContentEnd(line, lineEnd);
+		if (contentEnd == line)
+		{
+			continue;
+		}
+
+		Event event;
+		outOfMemory = !emImportEventLine(em, line, contentEnd, eventId, &event, &membersByName);
+		if (event != NULL)
+		{
+			priorities[acceptedCount] = event->date;
+			accepted[acceptedCount++] = event;
+		}
+		if (eventId == INT_MAX)
+		{
+			break;
+		}
+		eventId++;
+	}
+	hashTableDestroy(membersByName);
+
+	if (outOfMemory || pqInsertAll(em->events, (PQElement*)accepted, (PQElementPriority*)priorities, acceptedCount) != PQ_SUCCESS)
+	{
+		// The manager is destroyed, so the links and counts of the new events are left as they are
+		for (int i = 0; i < acceptedCount; i++)
+		{
+			emDestroyEvent(em, accepted[i]);
+		}
+		free(accepted);
+		destroyEventManager(em);
+		return EM_OUT_OF_MEMORY;
+	}
+
+	if (!emIndexEventsByDate(em, accepted, acceptedCount) || !emRebuildRanking(em))
+	{
+		free(accepted);
+		destroyEventManager(em);
+		return EM_OUT_OF_MEMORY;
+	}
+
+	// Journaled as separate calls, every event before any of the links
+	for (int i = 0; i < acceptedCount; i++)
+	{
+		emRecordMutation(em, EM_JOURNAL_ADD_EVENT, accepted[i]->id, emDateToDayNumber(accepted[i]->date), accepted[i]->name);
+		emTrackEventChange(em, accepted[i], true);
+	}
+	for (int i = 0; i < acceptedCount; i++)
+	{
+		PQ_FOREACH(Member, member, accepted[i]->members)
+		{
+			emRecordMutation(em, EM_JOURNAL_LINK, member->id, accepted[i]->id, NULL);
+		}
+		if (pqGetSize(accepted[i]->members) > 0)
+		{
+			emTrackEventChange(em, accepted[i], false);
+		}
+	}
+
+	*imported = acceptedCount;
+	free(accepted);
+	return EM_SUCCESS;
+}
+
+static EventManagerResult emImportEventsCsvUnlocked(EventManager em, const char* path, int first_event_id, int* imported)
+{
+	if (em == NULL || path == NULL || imported == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	if (first_event_id < 0)
+	{
+		return EM_INVALID_EVENT_ID;
+	}
+
+	// The events are imported in one batch, which is not recorded for a rollback
+	if (emInTransaction(em))
+	{
+		return EM_ERROR;
+	}
+
+	*imported = 0;
+	FileMap map = fileMapOpen(path);
+	if (map == NULL)
+	{
+		return EM_ERROR;
+	}
+
+	EventManagerResult result = emImportEvents(em, fileMapGetData(map), fileMapGetSize(map), first_event_id, imported);
+	fileMapClose(map);
+
+	return result;
+}
+
+EventManagerResult emImportEventsCsv(EventManager em, const char* path, int first_event_id, int* imported)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	emLockForWriting(em);
+	return emUnlockAfterWriting(em, emImportEventsCsvUnlocked(em, path, first_event_id, imported));
+}
+
+static EventManagerResult emImportMembers(EventManager em, const char* data, size_t size, int* imported)
+{
+	const char* end = data + size;
+	int lineCount = emCsvCountLines(data, end);
+	if (lineCount == 0)
+	{
+		return EM_SUCCESS;
+	}
+
+	// accepted[] holds the new members and accepted[lineCount + i] the id each one is queued by
+	Member* accepted = malloc(2 * lineCount * sizeof(*accepted));
+	if (accepted == NULL)
+	{
+		destroyEventManager(em);
+		return EM_OUT_OF_MEMORY;
+	}
+	int** priorities = (int**)(accepted + lineCount);
+
+	if (hashTableReserve(em->membersById, pqGetSize(em->members) + lineCount) != HT_SUCCESS)
+	{
+		free(accepted);
+		destroyEventManager(em);
+		return EM_OUT_OF_MEMORY;
+	}
+
+	int acceptedCount = 0;
+	bool outOfMemory = false;
+	const char* lineEnd;
+	for (const char* line = data; line < end; line = lineEnd + (lineEnd < end))
+	{
+		lineEnd = emCsvLineEnd(line, end);
+		const char* contentEnd = emCsvContentEnd(line, lineEnd);
+		const char* position = line;
+		int memberId;
+		// The name is the rest of the line, so it may hold separators
+		if (!emCsvParseInt(&position, contentEnd, &memberId) || position == contentEnd || *position != ','
+			|| memberId < 0 || emGetMemberById(em, memberId) != NULL)
+		{
+			continue;
+		}
+
+		const char* name = stringTableInternLength(em->names, position + 1, contentEnd - position - 1);
+		Member member = name == NULL ? NULL : emCreateMember(em, name, memberId);
+		if (member == NULL || hashTableInsert(em->membersById, member) != HT_SUCCESS)
+		{
+			arenaRelease(em->arena, member, sizeof(*member));
+			outOfMemory = true;
+			break;
+		}
+
+		priorities[acceptedCount] = &member->id;
+		accepted[acceptedCount++] = member;
 	}
 
-	char* countEventsString;
-	PQ_FOREACH(Member, member, newMemberQueue)
+	if (outOfMemory || pqInsertAll(em->members, (PQElement*)accepted, (PQElementPriority*)priorities, acceptedCount) != PQ_SUCCESS)
 	{
-		if (member->countEvents != 0)
+		for (int i = 0; i < acceptedCount; i++)
 		{
-			countEventsString = intToString(member->countEvents);
+			hashTableRemove(em->membersById, accepted[i]);
+			arenaRelease(em->arena, accepted[i], sizeof(*accepted[i]));
+		}
+		free(accepted);
+		destroyEventManager(em);
+		return EM_OUT_OF_MEMORY;
+	}
+
+	for (int i = 0; i < acceptedCount; i++)
+	{
+		emRecordMutation(em, EM_JOURNAL_ADD_MEMBER, accepted[i]->id, 0, accepted[i]->name);
+	}
+
+	*imported = acceptedCount;
+	free(accepted);
+	return EM_SUCCESS;
+}
+
+static EventManagerResult emImportMembersCsvUnlocked(EventManager em, const char* path, int* imported)
+{
+	if (em == NULL || path == NULL || imported == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	// The members are imported in one batch, which is not recorded for a rollback
+	if (emInTransaction(em))
+	{
+		return EM_ERROR;
+	}
+
+	*imported = 0;
+	FileMap map = fileMapOpen(path);
+	if (map == NULL)
+	{
+		return EM_ERROR;
+	}
+
+	EventManagerResult result = emImportMembers(em, fileMapGetData(map), fileMapGetSize(map), imported);
+	fileMapClose(map);
+
+	return result;
+}
+
+EventManagerResult emImportMembersCsv(EventManager em, const char* path, int* imported)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
 
-			fprintf(stream, member->name);
-			fprintf(stream, ",");
-			fprintf(stream, countEventsString);
-			fprintf(stream, "\n");
+	emLockForWriting(em);
+	return emUnlockAfterWriting(em, emImportMembersCsvUnlocked(em, path, imported));
+}
+
+static EventManagerResult emImportLinks(EventManager em, const char* data, size_t size, int* imported)
+{
+	const char* end = data + size;
+	const char* lineEnd;
+	for (const char* line = data; line < end; line = lineEnd + (lineEnd < end))
+	{
+		lineEnd = emCsvLineEnd(line, end);
+		const char* contentEnd = emCsvContentEnd(line, lineEnd);
+		const char* position = line;
+		int memberId, eventId;
+		if (!emCsvParseInt(&position, contentEnd, &memberId) || position == contentEnd || *position++ != ','
+			|| !emCsvParseInt(&position, contentEnd, &eventId) || position != contentEnd)
+		{
+			continue;
+		}
 
-			free(countEventsString);
+		EventManagerResult result = emAddMemberToEventUnlocked(em, memberId, eventId);
+		if (result == EM_OUT_OF_MEMORY || result == EM_TRANSACTION_ROLLED_BACK)
+		{
+			return result;
+		}
+		if (result == EM_SUCCESS)
+		{
+			(*imported)++;
 		}
 	}
 
-	pqDestroy(newMemberQueue);
-	fclose(stream);
-}
\ No newline at end of file
+	return EM_SUCCESS;
+}
+
+static EventManagerResult emImportLinksCsvUnlocked(EventManager em, const char* path, int* imported)
+{
+	if (em == NULL || path == NULL || imported == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	*imported = 0;
+	FileMap map = fileMapOpen(path);
+	if (map == NULL)
+	{
+		return EM_ERROR;
+	}
+
+	EventManagerResult result = emImportLinks(em, fileMapGetData(map), fileMapGetSize(map), imported);
+	fileMapClose(map);
+
+	return result;
+}
+
+EventManagerResult emImportLinksCsv(EventManager em, const char* path, int* imported)
+{
+	if (em == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	emLockForWriting(em);
+	return emUnlockAfterWriting(em, emImportLinksCsvUnlocked(em, path, imported));
+}
@@ -1,10 +1,21 @@
 #ifndef EVENT_MANAGER_H
 #define EVENT_MANAGER_H
 
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include "date.h"
 
 typedef struct EventManager_t* EventManager;
 
+/**
+* Memory shared by many event managers: the arena every event, member, queue node and index bucket array is taken
+* from, and the table that interns the names. Created for hosting many small managers in one process, whose fixed
+* cost then comes down to the manager itself and its empty queues and indexes.
+* The managers of a context share it without locking, so they must not be called from different threads at once.
+*/
+typedef struct EventManagerContext_t* EventManagerContext;
+
 typedef enum EventManagerResult_t {
     EM_SUCCESS,
     EM_OUT_OF_MEMORY,
@@ -20,14 +31,105 @@ typedef enum EventManagerResult_t {
     EM_MEMBER_ID_NOT_EXISTS,
     EM_EVENT_AND_MEMBER_ALREADY_LINKED,
     EM_EVENT_AND_MEMBER_NOT_LINKED,
+    EM_TRANSACTION_ROLLED_BACK,
+    EM_RESERVATION_EXHAUSTED,
     EM_ERROR
 } EventManagerResult;
 
+/**
+* Options for createEventManagerWithOptions. Options can be combined with bitwise or.
+*   EM_OPTION_ARENA - Allocate all events, members and queue nodes from growable region chunks
+*       owned by the event manager. Removed objects are recycled through free lists, and
+*       destroyEventManager releases everything with a handful of frees instead of one per object.
+*   EM_OPTION_THREAD_SAFE - Allow calling the event manager from several threads at once. Queries and exports
+*       hold a reader/writer lock for reading and run together, while every change holds it for writing and runs
+*       alone. Visitors and export done functions are called with the lock held and must not call the event
+*       manager. emGetEventsAmount and emGetNextEvent take no lock at all: every change publishes their answers
+*       before it unlocks, and removed events are freed only once no such reader can still be reading them.
+*       destroyEventManager must still only be called once no other call is running.
+*       Not available on Windows, where createEventManagerWithOptions returns NULL for it.
+*/
+typedef enum EventManagerOption_t {
+    EM_OPTION_NONE = 0,
+    EM_OPTION_ARENA = 1 << 0,
+    EM_OPTION_THREAD_SAFE = 1 << 1
+} EventManagerOption;
+
+/**
+* Destination of an export. write is called with consecutive chunks of the output and should consume
+* all length bytes of data, returning true on success and false otherwise. context is passed to write as is,
+* so a sink can append to a FILE*, a file descriptor, a memory buffer or a socket.
+*/
+typedef struct EventManagerSink_t {
+    bool (*write)(void* context, const char* data, int length);
+    void* context;
+} EventManagerSink;
+
+/**
+* Called by emGetEventsInRange for every event in the range, with context. date is owned by the event manager and is
+* only valid during the call. Should return true to go on to the next event, or false to stop.
+*/
+typedef bool (*EventManagerEventVisitor)(void* context, int event_id, const char* event_name, Date date);
+
+/**
+* Called when an asynchronous export is done, on the thread that wrote it.
+* result is EM_SUCCESS, EM_ERROR if the file could not be written or EM_OUT_OF_MEMORY.
+*/
+typedef void (*EventManagerExportDone)(const char* path, EventManagerResult result, void* context);
+
+/**
+* An event which expired on emTick, as it was right before it was removed.
+* event_name stays valid until the event manager is destroyed. member_ids holds the ids of the member_count
+* members which were linked to the event, in the order of emPrintAllEvents, and is only valid during the call.
+*/
+typedef struct EventManagerExpiredEvent_t {
+    int event_id;
+    const char* event_name;
+    const int* member_ids;
+    int member_count;
+} EventManagerExpiredEvent;
+
+/**
+* Called by emTick with the count events that expired during the tick, in the order they expired, and with context.
+* It is called after the events were removed, and must not call the event manager.
+*/
+typedef void (*EventManagerExpirationHandler)(void* context, const EventManagerExpiredEvent* events, int count);
 
 EventManager createEventManager(Date date);
 
+EventManager createEventManagerWithOptions(Date date, int options);
+
 void destroyEventManager(EventManager em);
 
+/**
+* createEventManagerContext: Allocates a new context with an empty arena and name table.
+*
+* @return
+* 	NULL - if allocations failed.
+* 	A new EventManagerContext in case of success.
+*/
+EventManagerContext createEventManagerContext();
+
+/**
+* destroyEventManagerContext: Deallocates a context and all of its memory. Every event manager created in it must
+* have been destroyed before.
+*
+* @param context - Target context to be deallocated. If context is NULL nothing will be done
+*/
+void destroyEventManagerContext(EventManagerContext context);
+
+/**
+* createEventManagerInContext: Creates an event manager whose memory comes from the context, as if it was created
+* with EM_OPTION_ARENA on an arena of its own. Destroying the manager gives its memory back to the context, to be
+* reused by the other managers, and names interned by one manager are shared by all.
+*
+* @param options - As for createEventManagerWithOptions. EM_OPTION_ARENA is implied.
+* @return
+* 	NULL - if context or date is NULL, options include EM_OPTION_THREAD_SAFE, or allocations failed.
+* 	A new EventManager in case of success.
+*/
+EventManager createEventManagerInContext(EventManagerContext context, Date date, int options);
+
 EventManagerResult emAddEventByDate(EventManager em, char* event_name, Date date, int event_id);
 
 EventManagerResult emAddEventByDiff(EventManager em, char* event_name, int days, int event_id);
@@ -38,17 +140,468 @@ EventManagerResult emChangeEventDate(EventManager em, int event_id, Date new_dat
 
 EventManagerResult emAddMember(EventManager em, char* member_name, int member_id);
 
+/**
+* emAddEventsBulk: Adds count events at once. event_names[i], dates[i] and event_ids[i] describe the i-th event.
+* The outcome is the same as calling emAddEventByDate for every event in array order, and results[i] receives
+* the result of the i-th event, but duplicates are detected with hashing and the events queue is built in one pass.
+*
+* @return
+* 	EM_NULL_ARGUMENT if em or one of the arrays is NULL.
+* 	EM_OUT_OF_MEMORY if an allocation failed, in which case the event manager is destroyed.
+* 	EM_SUCCESS otherwise, even if some of the events were rejected.
+*/
+EventManagerResult emAddEventsBulk(EventManager em, char** event_names, Date* dates, int* event_ids, int count,
+    EventManagerResult* results);
+
+/**
+* emAddMembersBulk: Adds count members at once, as if emAddMember was called for member_names[i] and member_ids[i]
+* in array order. results[i] receives the result of the i-th member.
+*
+* @return
+* 	EM_NULL_ARGUMENT if em or one of the arrays is NULL.
+* 	EM_OUT_OF_MEMORY if an allocation failed, in which case the event manager is destroyed.
+* 	EM_SUCCESS otherwise, even if some of the members were rejected.
+*/
+EventManagerResult emAddMembersBulk(EventManager em, char** member_names, int* member_ids, int count,
+    EventManagerResult* results);
+
 EventManagerResult emAddMemberToEvent(EventManager em, int member_id, int event_id);
 
+/**
+* emReserve: Sets memory aside so the next events calls of emAddEventByDate, members of emAddMember and links of
+* emAddMemberToEvent, with names of name_bytes bytes in total counting their terminators, make no allocator call.
+* The reservation fills the free lists of the manager's arena and grows its indexes and its name storage ahead of
+* time, and adds to what earlier calls reserved. The bulk adds use it too, and so do changes made inside a
+* transaction, whose undo log is grown as well; emAddEventByDiff still allocates its date on the heap.
+*
+* @return
+* 	EM_NULL_ARGUMENT if em is NULL.
+* 	EM_ERROR if one of the amounts is negative, or the manager was created neither with EM_OPTION_ARENA nor in a
+* 		context. What is reserved for a manager in a context is shared by all the managers of the context,
+* 		though emGetReservation only counts the adds of the manager itself.
+* 	EM_OUT_OF_MEMORY if an allocation failed. Part of the memory may be reserved, and the manager is kept.
+* 	EM_SUCCESS otherwise.
+*/
+EventManagerResult emReserve(EventManager em, int events, int members, int links, int name_bytes);
+
+/**
+* emGetReservation: Reports what is left of the reservations of emReserve. Every successful add takes its share,
+* and its name is counted as if it were new. The amounts left are written to the pointers which are not NULL,
+* 0 for an amount that ran out.
+*
+* @return
+* 	EM_NULL_ARGUMENT if em is NULL.
+* 	EM_RESERVATION_EXHAUSTED if some adds went past an amount, so they may have taken memory from the heap.
+* 	EM_SUCCESS otherwise, also when nothing was ever reserved.
+*/
+EventManagerResult emGetReservation(EventManager em, int* events, int* members, int* links, int* name_bytes);
+
 EventManagerResult emRemoveMemberFromEvent(EventManager em, int member_id, int event_id);
 
 EventManagerResult emTick(EventManager em, int days);
 
+/**
+* Transactions
+*
+* Groups changes so they are kept or undone together. Between emBegin and emCommit or emRollback every change also
+* records how to undo itself, before it changes anything, so undoing cannot fail for lack of room.
+* If an allocation fails inside a transaction, the failed call undoes its own part, every change made since emBegin
+* is undone and the call returns EM_TRANSACTION_ROLLED_BACK instead of destroying the manager. The transaction is
+* then over. Only if putting things back needs memory which cannot be had either, as when emChangeEventDate cannot
+* queue the event again, the manager is still destroyed and the call returns EM_OUT_OF_MEMORY.
+*
+* With EM_OPTION_THREAD_SAFE the transaction holds the lock for writing from emBegin to its end, so other threads
+* wait for it and see none of its changes before it is committed, while the thread which began it calls the event
+* manager as usual. The lock free emGetEventsAmount and emGetNextEvent of other threads see the changes once the
+* transaction ends.
+*
+* Undoing is done by the opposite calls, which are exported as changes like any other call, and puts every event
+* back to the place it had in the queue. The journal gets the changes of a transaction only once it is committed,
+* so a crash in the middle of a transaction leaves none of them in the journal, and a rollback leaves a single
+* record which a replay skips them by.
+* emTick, emReplayJournal, emImportEventsCsv and emImportMembersCsv return EM_ERROR inside a transaction, since
+* what they do is not recorded for undoing. emSaveSnapshot does too, since the snapshot would hold changes that may
+* still be rolled back.
+*/
+
+/**
+* emBegin: Begins a transaction. With EM_OPTION_THREAD_SAFE waits for the transactions of other threads to end.
+*
+* @return
+* 	EM_NULL_ARGUMENT if em is NULL.
+* 	EM_ERROR if the calling thread already began a transaction on em.
+* 	EM_SUCCESS otherwise.
+*/
+EventManagerResult emBegin(EventManager em);
+
+/**
+* emCommit: Keeps the changes of the transaction the calling thread began, and ends it.
+*
+* @return
+* 	EM_NULL_ARGUMENT if em is NULL.
+* 	EM_ERROR if the calling thread has no transaction on em, for example after EM_TRANSACTION_ROLLED_BACK.
+* 	EM_SUCCESS otherwise.
+*/
+EventManagerResult emCommit(EventManager em);
+
+/**
+* emRollback: Undoes the changes of the transaction the calling thread began, newest first, and ends it.
+*
+* @return
+* 	EM_NULL_ARGUMENT if em is NULL.
+* 	EM_ERROR if the calling thread has no transaction on em.
+* 	EM_OUT_OF_MEMORY if undoing ran out of memory, in which case the event manager is destroyed.
+* 	EM_SUCCESS otherwise.
+*/
+EventManagerResult emRollback(EventManager em);
+
+/**
+* emSetExpirationHandler: Sets the function every later emTick calls once with all the events that expired during
+* the tick, so expirations are pushed as they happen. Ticks in which no event expired do not call it.
+* The expired events are gathered into buffers the event manager keeps and reuses, sized before the tick starts.
+*
+* @param handler - The function to call, or NULL to stop calling one.
+* @return
+* 	EM_NULL_ARGUMENT if em is NULL.
+* 	EM_SUCCESS otherwise.
+*/
+EventManagerResult emSetExpirationHandler(EventManager em, EventManagerExpirationHandler handler, void* context);
+
+/**
+* Wall-clock scheduler
+*
+* Drives emTick from a monotonic clock instead of by hand: the current date begins when the scheduler starts, and
+* every day lasts day_length_ms milliseconds. A Linux timerfd is armed for the moment the next event expires, which
+* is the end of its day, and is moved whenever a change makes another event the next one. There are no wake-ups on
+* the days in between, so the current date only catches up with the clock when the timer goes off or
+* emDispatchScheduler is called.
+* Either call emRunScheduler, which waits on the timer until emStopScheduler is called, or call emStartScheduler
+* and add the descriptor of emGetSchedulerFd to an existing epoll or poll loop, calling emDispatchScheduler whenever
+* it is readable.
+* Only available on Linux. Elsewhere the functions return EM_ERROR and emGetSchedulerFd returns -1.
+*/
+
+/**
+* emStartScheduler: Starts the scheduler without waiting on it, see emGetSchedulerFd.
+*
+* @return
+* 	EM_NULL_ARGUMENT if em is NULL.
+* 	EM_ERROR if day_length_ms is not positive, a scheduler already runs or the timer could not be created.
+* 	EM_SUCCESS otherwise.
+*/
+EventManagerResult emStartScheduler(EventManager em, int day_length_ms);
+
+/**
+* emGetSchedulerFd: Returns the timer descriptor of a started scheduler, which becomes readable when an event
+* expires. It is owned by the event manager and must not be read or closed.
+*
+* @return
+* 	-1 if em is NULL or no scheduler runs.
+* 	The descriptor otherwise.
+*/
+int emGetSchedulerFd(EventManager em);
+
+/**
+* emDispatchScheduler: Ticks the days which passed on the clock since the current date began and arms the timer
+* again. Meant to be called when the descriptor is readable, but can be called any time to catch up.
+*
+* @return
+* 	EM_NULL_ARGUMENT if em is NULL.
+* 	EM_ERROR if no scheduler runs.
+* 	EM_OUT_OF_MEMORY if the tick ran out of memory, in which case the event manager is destroyed.
+* 	EM_SUCCESS otherwise.
+*/
+EventManagerResult emDispatchScheduler(EventManager em);
+
+/**
+* emRunScheduler: Starts the scheduler and ticks the event manager on the calling thread whenever an event expires,
+* until emStopScheduler is called. Expiration handlers are called from this thread.
+*
+* @return
+* 	Same as emStartScheduler and emDispatchScheduler, EM_SUCCESS once stopped.
+*/
+EventManagerResult emRunScheduler(EventManager em, int day_length_ms);
+
+/**
+* emStopScheduler: Stops the scheduler. A running emRunScheduler returns soon after, and may be stopped from another
+* thread if em was created with EM_OPTION_THREAD_SAFE, or from an expiration handler otherwise.
+*
+* @return
+* 	EM_NULL_ARGUMENT if em is NULL.
+* 	EM_ERROR if the running emRunScheduler could not be signalled, in which case it keeps running.
+* 	EM_SUCCESS otherwise, even if no scheduler runs.
+*/
+EventManagerResult emStopScheduler(EventManager em);
+
 int emGetEventsAmount(EventManager em);
 
 char* emGetNextEvent(EventManager em);
 
+/**
+* emGetEventsInRange: Calls visitor for every event whose date is between from and to, both included,
+* in the order of emPrintAllEvents. The events are kept in a tree ordered by date, so this takes O(log n)
+* plus the number of events visited.
+*
+* @return
+* 	-1 if a NULL was sent.
+* 	The number of events visitor was called for otherwise.
+*/
+int emGetEventsInRange(EventManager em, Date from, Date to, EventManagerEventVisitor visitor, void* context);
+
+/**
+* emGetNextEvents: Writes the ids of the k next events, in the order of emPrintAllEvents, into out_ids.
+* Takes O(log n + k).
+*
+* @param out_ids - An array of at least k elements.
+* @return
+* 	-1 if a NULL was sent.
+* 	The number of ids written otherwise, which is at most k.
+*/
+int emGetNextEvents(EventManager em, int k, int* out_ids);
+
+/**
+* emGetEventName: Returns the name of the event with the given id. The name stays valid until the event manager
+* is destroyed, even if the event is removed.
+*
+* @return
+* 	NULL if em is NULL or no event has the id.
+* 	The name of the event otherwise.
+*/
+const char* emGetEventName(EventManager em, int event_id);
+
+/**
+* emFileSink: Returns a sink which appends to an open stdio stream. The stream is not closed.
+*/
+EventManagerSink emFileSink(FILE* file);
+
+/**
+* emFdSink: Returns a sink which writes to an open file descriptor. The descriptor is not closed.
+*/
+EventManagerSink emFdSink(int fd);
+
+/**
+* emWriteAllEvents: Writes all events, in the format of emPrintAllEvents, to a sink.
+* The output is formatted in a buffer owned by the event manager and handed to the sink in large chunks.
+*
+* @return
+* 	EM_NULL_ARGUMENT if em or the write function of the sink is NULL.
+* 	EM_OUT_OF_MEMORY if the export buffer could not be allocated. The event manager is not changed.
+* 	EM_ERROR if the sink failed to write. Output after the failure is discarded.
+* 	EM_SUCCESS otherwise.
+*/
+EventManagerResult emWriteAllEvents(EventManager em, EventManagerSink sink);
+
+/**
+* emSetExportThreads: Sets the number of threads emWriteAllEvents and emPrintAllEvents format the events on.
+* With more than one thread, the events are split into chunks of consecutive events which a pool of worker threads
+* formats into separate buffers, while the calling thread writes the finished chunks in order.
+* The output is the same as with one thread. Managers with few events are still exported on the calling thread.
+*
+* @param threads - The number of worker threads. 0 or 1 export on the calling thread only, which is the default.
+* @return
+* 	EM_NULL_ARGUMENT if em is NULL.
+* 	EM_OUT_OF_MEMORY if an allocation failed or the threads could not be started. The previous setting is kept.
+* 	EM_SUCCESS otherwise.
+*/
+EventManagerResult emSetExportThreads(EventManager em, int threads);
+
+/**
+* emWriteResponsibleMembers: Writes all members with events, in the format of emPrintAllResponsibleMembers,
+* to a sink. Same results as emWriteAllEvents.
+*/
+EventManagerResult emWriteResponsibleMembers(EventManager em, EventManagerSink sink);
+
 void emPrintAllEvents(EventManager em, const char* file_name);
 
 void emPrintAllResponsibleMembers(EventManager em, const char* file_name);
+
+/**
+* emExportAsync: Writes all events to a file, in the format of emPrintAllEvents, on a background thread.
+* The events and their members are copied as they are at the time of the call, which only takes a few words per
+* event and per link since names are shared, and the file is formatted and written from that copy. The event
+* manager can be changed in the meantime without affecting the file. Exports run one at a time, in the order of
+* the calls: a call made while an export is running copies the events at once and queues the copy behind it.
+*
+* @param done - Called on the background thread once the file is written, with context. May be NULL.
+* 		It must not call functions of the event manager.
+* @return
+* 	EM_NULL_ARGUMENT if em or path is NULL.
+* 	EM_OUT_OF_MEMORY if the copy could not be allocated or the thread could not be started. done is not called.
+* 	EM_SUCCESS if the export started.
+*/
+EventManagerResult emExportAsync(EventManager em, const char* path, EventManagerExportDone done, void* context);
+
+/**
+* emWaitForExport: Returns once the running asynchronous export and those queued behind it, if any, are done and
+* their done functions returned.
+* destroyEventManager waits as well.
+*
+* @return
+* 	EM_NULL_ARGUMENT if em is NULL.
+* 	EM_SUCCESS otherwise.
+*/
+EventManagerResult emWaitForExport(EventManager em);
+
+/**
+* emGetTopResponsibleMembers: Writes the n members with the most events, in the order used by
+* emPrintAllResponsibleMembers, into out_ids and out_counts. Members without events are not included.
+* The ranking is kept up to date by the event manager, so this takes O(n + log m) and does no I/O.
+*
+* @param out_ids - An array of at least n elements, receives the ids of the members.
+* @param out_counts - An array of at least n elements, receives the number of events of every member.
+* @return
+* 	-1 if a NULL was sent.
+* 	The number of members written otherwise, which is at most n.
+*/
+int emGetTopResponsibleMembers(EventManager em, int n, int* out_ids, int* out_counts);
+
+/**
+* emGetVersion: Returns the version of the event manager, which every successful mutation increases.
+*
+* @return
+* 	0 if a NULL was sent.
+* 	The current version otherwise.
+*/
+uint64_t emGetVersion(EventManager em);
+
+/**
+* emExportChangesSince: Writes to a sink only the events that changed after a version returned by an earlier
+* export or by emGetVersion, so a consumer can follow the event manager without exporting everything again.
+* One line is written per change, first the events removed after version and then the events added or changed
+* after it, each group in the order of the changes:
+*   R,id                                         - The event was removed with emRemoveEvent
+*   E,id                                         - The event expired on emTick
+*   A,id,name,day.month.year[,member name...]    - The event was added, with its current state
+*   C,id,name,day.month.year[,member name...]    - The date or the members of the event changed, with its current state
+* Every live event is written at most once, so the time taken depends on the number of changes and not on the number
+* of events. An id may be removed and then added again, and applying the lines in order gives the current state.
+*
+* @param version - The version the consumer is up to date with. 0 for a new event manager writes all of its events.
+* @param new_version - Receives the version to send to the next call.
+* @return
+* 	EM_NULL_ARGUMENT if em, new_version or the write function of the sink is NULL.
+* 	EM_OUT_OF_MEMORY if the export buffer could not be allocated. The event manager is not changed.
+* 	EM_ERROR if the sink failed to write, or if version is newer than the event manager or older than the changes
+* 	it still knows, after emForgetChangesBefore or emLoadSnapshot. A full export is needed in the latter case.
+* 	EM_SUCCESS otherwise.
+*/
+EventManagerResult emExportChangesSince(EventManager em, uint64_t version, EventManagerSink sink, uint64_t* new_version);
+
+/**
+* emForgetChangesBefore: Frees the removals kept for emExportChangesSince up to a version, once every consumer is
+* past it. Exports from an older version fail afterwards.
+*
+* @return
+* 	EM_NULL_ARGUMENT if a NULL was sent.
+* 	EM_ERROR if version is newer than the event manager.
+* 	EM_SUCCESS otherwise.
+*/
+EventManagerResult emForgetChangesBefore(EventManager em, uint64_t version);
+
+/**
+* emSaveSnapshot: Saves the whole state of the event manager to a binary snapshot file, which
+* emLoadSnapshot restores without replaying the calls that built it.
+* The file is versioned and checksummed, and it replaces path only once it was fully written.
+*
+* @return
+* 	EM_NULL_ARGUMENT if a NULL was sent.
+* 	EM_OUT_OF_MEMORY if an allocation failed. The event manager is not changed.
+* 	EM_ERROR if the file could not be written, or the calling thread began a transaction which did not end.
+* 	EM_SUCCESS otherwise.
+*/
+EventManagerResult emSaveSnapshot(EventManager em, const char* path);
+
+/**
+* emLoadSnapshot: Creates an event manager from a snapshot file written by emSaveSnapshot.
+* The file is mapped to memory and the queues and indexes are built in bulk.
+*
+* @return
+* 	NULL if a NULL was sent, the file could not be read, it is not a valid snapshot of this version
+* 	or an allocation failed.
+* 	The restored event manager otherwise.
+*/
+EventManager emLoadSnapshot(const char* path);
+
+/**
+* emLoadSnapshotWithOptions: Same as emLoadSnapshot, for an event manager created with the given options.
+*/
+EventManager emLoadSnapshotWithOptions(const char* path, int options);
+
+/**
+* emOpenJournal: Starts recording every successful mutating call of the event manager in an append-only
+* journal file, so the state between snapshots survives a crash. An existing journal is appended to, and
+* a journal that was already open is closed first.
+*
+* Records are buffered and written in groups. They reach the file when the buffer fills up, and reach the disk
+* on emSyncJournal, which commits every pending record with a single flush. emSaveSnapshot empties the journal
+* once the snapshot is written, since the snapshot holds all of its mutations.
+*
+* @return
+* 	EM_NULL_ARGUMENT if a NULL was sent.
+* 	EM_ERROR if the file could not be opened or is not a journal.
+* 	EM_SUCCESS otherwise.
+*/
+EventManagerResult emOpenJournal(EventManager em, const char* path);
+
+/**
+* emSyncJournal: Commits the pending journal records to the disk.
+*
+* @return
+* 	EM_NULL_ARGUMENT if a NULL was sent.
+* 	EM_ERROR if writing the journal failed at any point since it was opened.
+* 	EM_SUCCESS otherwise, including when no journal is open.
+*/
+EventManagerResult emSyncJournal(EventManager em);
+
+/**
+* emCloseJournal: Commits the pending journal records and stops journaling. Same results as emSyncJournal.
+*/
+EventManagerResult emCloseJournal(EventManager em);
+
+/**
+* emReplayJournal: Repeats the mutations recorded in a journal file, skipping those that the event manager
+* already holds, so a manager loaded with emLoadSnapshot is brought back to its state at the last journaled call.
+* Replay stops at a record torn by a crash.
+*
+* @return
+* 	EM_NULL_ARGUMENT if a NULL was sent.
+* 	EM_OUT_OF_MEMORY if an allocation failed, in which case the event manager is destroyed.
+* 	EM_ERROR if the file could not be read or its records do not follow the state of the event manager.
+* 	EM_SUCCESS otherwise.
+*/
+EventManagerResult emReplayJournal(EventManager em, const char* path);
+
+/**
+* emImportEventsCsv: Adds the events of a CSV file in the format written by emPrintAllEvents, one event per line:
+*   name,day.month.year[,member name...]
+* The file carries no ids, so the i-th non-empty line gets the id first_event_id + i. Members are found by name
+* (the one with the lowest id if several share a name) and names of unknown members are skipped.
+* Lines that are malformed or that emAddEventByDate would reject are skipped as well.
+* The file is mapped to memory and parsed in place, and the events queue is built in one pass.
+*
+* @param imported - Receives the number of events that were added.
+* @return
+* 	EM_NULL_ARGUMENT if a NULL was sent.
+* 	EM_INVALID_EVENT_ID if first_event_id is negative.
+* 	EM_ERROR if the file could not be read.
+* 	EM_OUT_OF_MEMORY if an allocation failed, in which case the event manager is destroyed.
+* 	EM_SUCCESS otherwise.
+*/
+EventManagerResult emImportEventsCsv(EventManager em, const char* path, int first_event_id, int* imported);
+
+/**
+* emImportMembersCsv: Adds the members of a CSV file, one member per line:
+*   id,name
+* The name is the rest of the line. Lines that are malformed or that emAddMember would reject are skipped.
+* Same results as emImportEventsCsv, except for EM_INVALID_EVENT_ID.
+*/
+EventManagerResult emImportMembersCsv(EventManager em, const char* path, int* imported);
+
+/**
+* emImportLinksCsv: Links members to events as listed in a CSV file, one link per line:
+*   member id,event id
+* Lines that are malformed or that emAddMemberToEvent would reject are skipped.
+* Same results as emImportEventsCsv, except for EM_INVALID_EVENT_ID.
+*/
+EventManagerResult emImportLinksCsv(EventManager em, const char* path, int* imported);
 #endif //EVENT_MANAGER_H
@@ -0,0 +1,465 @@
+#include "../event_manager.h"
+#include "../sharded_event_manager.h"
+#include "../async_event_manager.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+/**
+* Event manager benchmarks. Each benchmark prints one line per measurement.
+* Run with no arguments to run all of them, or with the number of a benchmark to run only that one.
+*
+*   benchmarkReadScaling - Queries per second of a thread safe event manager with 1 to 8 reader threads
+*   benchmarkShardedTick - Time taken by a tick which expires every event, with 1 to 8 shards
+*   benchmarkAsyncIngest - Commands per second submitted to an asynchronous front-end by 1 to 8 producer threads
+*   benchmarkReadLatency - Latency percentiles of emGetNextEvent on a thread safe manager, with and without a writer
+*   benchmarkAddLatency  - p99 latency of the adds as an arena manager fills up, with and without emReserve
+*   benchmarkTenantOverhead - Resident memory per small manager, on its own, with an arena or in a shared context
+*/
+
+#define NUMBER_BENCHMARKS 6
+
+#define READ_SCALING_EVENTS 100000
+#define READ_SCALING_SECONDS 1.0
+#define SHARDED_TICK_EVENTS 40000
+#define SHARDED_TICK_DAYS 365
+#define ASYNC_INGEST_COMMANDS 4000000
+#define ASYNC_INGEST_CAPACITY 65536
+#define ASYNC_INGEST_EVENTS 1000
+#define ASYNC_INGEST_MEMBERS 16
+#define READ_LATENCY_EVENTS 10000
+#define READ_LATENCY_SAMPLES 1000000
+#define ADD_LATENCY_ADDS 40000
+#define ADD_LATENCY_WINDOWS 4
+// Events are added a day apart going back from this year, so every insert lands at the front of the queue
+#define ADD_LATENCY_LAST_YEAR 2200
+#define TENANT_OVERHEAD_TENANTS 10000
+
+static double benchmarkNow() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static EventManager benchmarkCreateManager(int options, int events) {
+    Date start_date = dateCreate(1,1,2020);
+    EventManager em = createEventManagerWithOptions(start_date, options);
+    dateDestroy(start_date);
+    char name[32];
+    for (int i = 0; em != NULL && i < events; i++) {
+        sprintf(name, "event%d", i);
+        if (emAddEventByDiff(em, name, i % 3650, i) != EM_SUCCESS) {
+            return NULL;
+        }
+    }
+
+    return em;
+}
+
+#ifndef _WIN32
+typedef struct {
+    EventManager em;
+    double end;
+    long queries;
+} BenchmarkReader;
+
+static bool benchmarkVisit(void* context, int event_id, const char* event_name, Date date) {
+    (void)context;
+    (void)event_id;
+    (void)event_name;
+    (void)date;
+    return true;
+}
+
+// A mix of the cheap queries: the queue size, the next events and a short date range
+static void* benchmarkReader(void* context) {
+    BenchmarkReader* reader = context;
+    Date from = dateCreate(1,6,2020);
+    Date to = dateCreate(3,6,2020);
+    int ids[16];
+    while (benchmarkNow() < reader->end) {
+        for (int i = 0; i < 100; i++) {
+            emGetEventsAmount(reader->em);
+            emGetNextEvent(reader->em);
+            emGetNextEvents(reader->em, 16, ids);
+            emGetEventsInRange(reader->em, from, to, benchmarkVisit, NULL);
+        }
+        reader->queries += 400;
+    }
+    dateDestroy(from);
+    dateDestroy(to);
+    return NULL;
+}
+#endif
+
+void benchmarkReadScaling() {
+#ifdef _WIN32
+    printf("benchmarkReadScaling: EM_OPTION_THREAD_SAFE is not available\n");
+#else
+    EventManager em = benchmarkCreateManager(EM_OPTION_THREAD_SAFE, READ_SCALING_EVENTS);
+    if (em == NULL) {
+        printf("benchmarkReadScaling: out of memory\n");
+        return;
+    }
+
+    for (int threads = 1; threads <= 8; threads *= 2) {
+        BenchmarkReader readers[8];
+        pthread_t handles[8];
+        double start = benchmarkNow();
+        for (int i = 0; i < threads; i++) {
+            readers[i] = (BenchmarkReader){ em, start + READ_SCALING_SECONDS, 0 };
+            pthread_create(&handles[i], NULL, benchmarkReader, &readers[i]);
+        }
+        long queries = 0;
+        for (int i = 0; i < threads; i++) {
+            pthread_join(handles[i], NULL);
+            queries += readers[i].queries;
+        }
+        double seconds = benchmarkNow() - start;
+        printf("benchmarkReadScaling: threads=%d events=%d queries_per_second=%.0f\n", threads, READ_SCALING_EVENTS,
+            queries / seconds);
+    }
+
+    destroyEventManager(em);
+#endif
+}
+
+void benchmarkShardedTick() {
+    char name[32];
+    for (int shards = 1; shards <= 8; shards *= 2) {
+        Date start_date = dateCreate(1,1,2020);
+        ShardedEventManager sem = createShardedEventManager(start_date, shards, EM_OPTION_NONE);
+        dateDestroy(start_date);
+        for (int i = 0; sem != NULL && i < SHARDED_TICK_EVENTS; i++) {
+            sprintf(name, "event%d", i);
+            if (semAddEventByDiff(sem, name, i % SHARDED_TICK_DAYS, i) != EM_SUCCESS) {
+                sem = NULL;
+            }
+        }
+        if (sem == NULL) {
+            printf("benchmarkShardedTick: out of memory\n");
+            return;
+        }
+
+        double start = benchmarkNow();
+        semTick(sem, SHARDED_TICK_DAYS);
+        double seconds = benchmarkNow() - start;
+        printf("benchmarkShardedTick: shards=%d events=%d tick_ms=%.1f\n", shards, SHARDED_TICK_EVENTS,
+            seconds * 1000);
+        destroyShardedEventManager(sem);
+    }
+}
+
+#ifndef _WIN32
+typedef struct {
+    AsyncEventManager aem;
+    int index;
+    int commands;
+} BenchmarkProducer;
+
+// Links members to events, most of which are already linked after the first round, so applying them is cheap
+static void* benchmarkProducer(void* context) {
+    BenchmarkProducer* producer = context;
+    for (int i = 0; i < producer->commands; i++) {
+        int event_id = (producer->index + i) % ASYNC_INGEST_EVENTS;
+        // A full ring means the owner is behind, so the producer gives it the core
+        while (aemAddMemberToEvent(producer->aem, i % ASYNC_INGEST_MEMBERS, event_id, NULL, NULL) == EM_ERROR) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+#endif
+
+void benchmarkAsyncIngest() {
+#ifdef _WIN32
+    printf("benchmarkAsyncIngest: there is no owner thread without POSIX threads\n");
+#else
+    EventManager em = benchmarkCreateManager(EM_OPTION_NONE, ASYNC_INGEST_EVENTS);
+    char name[32];
+    for (int i = 0; em != NULL && i < ASYNC_INGEST_MEMBERS; i++) {
+        sprintf(name, "member%d", i);
+        emAddMember(em, name, i);
+    }
+    AsyncEventManager aem = createAsyncEventManager(em, ASYNC_INGEST_CAPACITY);
+    if (aem == NULL) {
+        printf("benchmarkAsyncIngest: out of memory\n");
+        destroyEventManager(em);
+        return;
+    }
+
+    for (int producers = 1; producers <= 8; producers *= 2) {
+        BenchmarkProducer contexts[8];
+        pthread_t handles[8];
+        double start = benchmarkNow();
+        for (int i = 0; i < producers; i++) {
+            contexts[i] = (BenchmarkProducer){ aem, i, ASYNC_INGEST_COMMANDS / producers };
+            pthread_create(&handles[i], NULL, benchmarkProducer, &contexts[i]);
+        }
+        for (int i = 0; i < producers; i++) {
+            pthread_join(handles[i], NULL);
+        }
+        double submitted = benchmarkNow() - start;
+        aemFlush(aem);
+        double applied = benchmarkNow() - start;
+        printf("benchmarkAsyncIngest: producers=%d commands=%d submitted_per_second=%.0f applied_per_second=%.0f\n",
+            producers, ASYNC_INGEST_COMMANDS, ASYNC_INGEST_COMMANDS / submitted, ASYNC_INGEST_COMMANDS / applied);
+    }
+
+    destroyAsyncEventManager(aem);
+    destroyEventManager(em);
+#endif
+}
+
+static int benchmarkCompareDoubles(const void* first, const void* second) {
+    double difference = *(const double*)first - *(const double*)second;
+    return (difference > 0) - (difference < 0);
+}
+
+#ifndef _WIN32
+typedef struct {
+    EventManager em;
+    volatile bool stop;
+} BenchmarkWriter;
+
+// Keeps replacing the next event, so every read races with a removal
+static void* benchmarkWriter(void* context) {
+    BenchmarkWriter* writer = context;
+    Date date = dateCreate(1,1,2020);
+    for (int id = READ_LATENCY_EVENTS; !writer->stop; id++) {
+        emAddEventByDate(writer->em, "writer event", date, id);
+        emRemoveEvent(writer->em, id);
+    }
+    dateDestroy(date);
+    return NULL;
+}
+#endif
+
+void benchmarkReadLatency() {
+#ifdef _WIN32
+    printf("benchmarkReadLatency: EM_OPTION_THREAD_SAFE is not available\n");
+#else
+    EventManager em = benchmarkCreateManager(EM_OPTION_THREAD_SAFE, READ_LATENCY_EVENTS);
+    double* samples = malloc(READ_LATENCY_SAMPLES * sizeof(*samples));
+    if (em == NULL || samples == NULL) {
+        printf("benchmarkReadLatency: out of memory\n");
+        destroyEventManager(em);
+        free(samples);
+        return;
+    }
+
+    for (int writers = 0; writers <= 1; writers++) {
+        BenchmarkWriter writer = { em, false };
+        pthread_t handle;
+        if (writers > 0) {
+            pthread_create(&handle, NULL, benchmarkWriter, &writer);
+        }
+        for (int i = 0; i < READ_LATENCY_SAMPLES; i++) {
+            double start = benchmarkNow();
+            emGetNextEvent(em);
+            samples[i] = benchmarkNow() - start;
+        }
+        if (writers > 0) {
+            writer.stop = true;
+            pthread_join(handle, NULL);
+        }
+
+        qsort(samples, READ_LATENCY_SAMPLES, sizeof(*samples), benchmarkCompareDoubles);
+        printf("benchmarkReadLatency: writers=%d p50_ns=%.0f p99_ns=%.0f p999_ns=%.0f\n", writers,
+            samples[READ_LATENCY_SAMPLES / 2] * 1e9, samples[READ_LATENCY_SAMPLES / 100 * 99] * 1e9,
+            samples[READ_LATENCY_SAMPLES / 1000 * 999] * 1e9);
+    }
+
+    free(samples);
+    destroyEventManager(em);
+#endif
+}
+
+static double benchmarkPercentile(double* samples, int count, int per_thousand) {
+    qsort(samples, count, sizeof(*samples), benchmarkCompareDoubles);
+    return samples[(long)count * per_thousand / 1000];
+}
+
+/*
+* Adds events, members and links one at a time and times every call. Events go to the front of the events queue and
+* members are added by decreasing id, so no add walks its queue and the time left is the allocations and indexing.
+* The p99 of each window of adds shows whether the latency stays flat as the manager grows
+*/
+void benchmarkAddLatency() {
+    double* samples = malloc(3 * ADD_LATENCY_ADDS * sizeof(*samples));
+    if (samples == NULL) {
+        printf("benchmarkAddLatency: out of memory\n");
+        return;
+    }
+    double* event_samples = samples;
+    double* member_samples = samples + ADD_LATENCY_ADDS;
+    double* link_samples = samples + 2 * ADD_LATENCY_ADDS;
+
+    char name[32];
+    int name_bytes = 0;
+    for (int i = 0; i < ADD_LATENCY_ADDS; i++) {
+        name_bytes += sprintf(name, "event%d", i) + 1;
+        name_bytes += sprintf(name, "member%d", i) + 1;
+    }
+
+    for (int reserved = 0; reserved <= 1; reserved++) {
+        Date start_date = dateCreate(1,1,2020);
+        EventManager em = createEventManagerWithOptions(start_date, EM_OPTION_ARENA);
+        dateDestroy(start_date);
+        if (em == NULL || (reserved && emReserve(em, ADD_LATENCY_ADDS, ADD_LATENCY_ADDS, ADD_LATENCY_ADDS,
+            name_bytes) != EM_SUCCESS)) {
+            printf("benchmarkAddLatency: out of memory\n");
+            destroyEventManager(em);
+            free(samples);
+            return;
+        }
+
+        for (int i = 0; i < ADD_LATENCY_ADDS; i++) {
+            int day = ADD_LATENCY_LAST_YEAR * 360 - i;
+            Date date = dateCreate(day % 30 + 1, day / 30 % 12 + 1, day / 360);
+            int member_id = ADD_LATENCY_ADDS - i;
+            sprintf(name, "event%d", i);
+            double start = benchmarkNow();
+            emAddEventByDate(em, name, date, i);
+            double added = benchmarkNow();
+            sprintf(name, "member%d", i);
+            double member_start = benchmarkNow();
+            emAddMember(em, name, member_id);
+            double member_added = benchmarkNow();
+            emAddMemberToEvent(em, member_id, i);
+            double linked = benchmarkNow();
+            event_samples[i] = added - start;
+            member_samples[i] = member_added - member_start;
+            link_samples[i] = linked - member_added;
+            dateDestroy(date);
+        }
+
+        int window = ADD_LATENCY_ADDS / ADD_LATENCY_WINDOWS;
+        for (int first = 0; first + window <= ADD_LATENCY_ADDS; first += window) {
+            printf("benchmarkAddLatency: reserved=%d adds=%d-%d event_p99_ns=%.0f member_p99_ns=%.0f "
+                "link_p99_ns=%.0f\n", reserved, first, first + window,
+                benchmarkPercentile(event_samples + first, window, 990) * 1e9,
+                benchmarkPercentile(member_samples + first, window, 990) * 1e9,
+                benchmarkPercentile(link_samples + first, window, 990) * 1e9);
+        }
+        destroyEventManager(em);
+    }
+
+    free(samples);
+}
+
+#ifdef __linux__
+static long benchmarkResidentBytes() {
+    long pages = 0;
+    long resident = 0;
+    FILE* file = fopen("/proc/self/statm", "r");
+    if (file == NULL) {
+        return 0;
+    }
+    if (fscanf(file, "%ld %ld", &pages, &resident) != 2) {
+        resident = 0;
+    }
+    fclose(file);
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+// Creates the tenants of one configuration and prints how much resident memory each one added
+static void benchmarkMeasureTenants(const char* mode, int options, bool in_context, int events) {
+    EventManager* tenants = malloc(TENANT_OVERHEAD_TENANTS * sizeof(*tenants));
+    Date start_date = dateCreate(1,1,2020);
+    long before = benchmarkResidentBytes();
+    EventManagerContext context = in_context ? createEventManagerContext() : NULL;
+    char name[32];
+    for (int t = 0; tenants != NULL && t < TENANT_OVERHEAD_TENANTS; t++) {
+        tenants[t] = in_context ? createEventManagerInContext(context, start_date, options)
+            : createEventManagerWithOptions(start_date, options);
+        for (int i = 0; tenants[t] != NULL && i < events; i++) {
+            sprintf(name, "event%d", i);
+            emAddEventByDiff(tenants[t], name, i, i);
+            sprintf(name, "member%d", i);
+            emAddMember(tenants[t], name, i);
+            emAddMemberToEvent(tenants[t], i, i);
+        }
+    }
+    printf("benchmarkTenantOverhead: mode=%s tenants=%d events_per_tenant=%d bytes_per_tenant=%ld\n", mode,
+        TENANT_OVERHEAD_TENANTS, events, (benchmarkResidentBytes() - before) / TENANT_OVERHEAD_TENANTS);
+    fflush(stdout);
+
+    for (int t = 0; tenants != NULL && t < TENANT_OVERHEAD_TENANTS; t++) {
+        destroyEventManager(tenants[t]);
+    }
+    destroyEventManagerContext(context);
+    dateDestroy(start_date);
+    free(tenants);
+}
+#endif
+
+/*
+* Every configuration is measured in a child process of its own, so memory freed by one cannot be reused by the next
+* and hide its cost. Every tenant holds events events, as many members and a link for every event
+*/
+void benchmarkTenantOverhead() {
+#ifndef __linux__
+    printf("benchmarkTenantOverhead: resident memory is only read on Linux\n");
+#else
+    for (int events = 0; events <= 8; events += 8) {
+        for (int mode = 0; mode < 3; mode++) {
+            pid_t child = fork();
+            if (child == 0) {
+                if (mode == 0) {
+                    benchmarkMeasureTenants("own", EM_OPTION_NONE, false, events);
+                } else if (mode == 1) {
+                    benchmarkMeasureTenants("own_arena", EM_OPTION_ARENA, false, events);
+                } else {
+                    benchmarkMeasureTenants("context", EM_OPTION_NONE, true, events);
+                }
+                _exit(0);
+            }
+            if (child > 0) {
+                waitpid(child, NULL, 0);
+            }
+        }
+    }
+#endif
+}
+
+void (*benchmarks[]) (void) = {
+        benchmarkReadScaling,
+        benchmarkShardedTick,
+        benchmarkAsyncIngest,
+        benchmarkReadLatency,
+        benchmarkAddLatency,
+        benchmarkTenantOverhead
+};
+
+int main(int argc, char *argv[]) {
+    if (argc == 1) {
+        for (int benchmark_idx = 0; benchmark_idx < NUMBER_BENCHMARKS; benchmark_idx++) {
+            benchmarks[benchmark_idx]();
+        }
+        return 0;
+    }
+    if (argc != 2) {
+        fprintf(stdout, "Usage: event_manager_benchmark <benchmark index>\n");
+        return 0;
+    }
+
+    int benchmark_idx = strtol(argv[1], NULL, 10);
+    if (benchmark_idx < 1 || benchmark_idx > NUMBER_BENCHMARKS) {
+        fprintf(stderr, "Invalid benchmark index %d\n", benchmark_idx);
+        return 0;
+    }
+
+    benchmarks[benchmark_idx - 1]();
+    return 0;
+}
@@ -1,9 +1,19 @@
 #include "test_utilities.h"
 #include "../event_manager.h"
+#include "../sharded_event_manager.h"
+#include "../async_event_manager.h"
 #include <stdlib.h>
 #include <string.h>
 
-#define NUMBER_TESTS 3
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+#ifdef __linux__
+#include <poll.h>
+#endif
+
+#define NUMBER_TESTS 23
 
 bool testEventManagerCreateDestroy() {
     bool result = true;
@@ -56,16 +66,1259 @@ destroyEMTick:
     return result;
 }
 
+bool testArenaMode() {
+    bool result = true;
+
+    Date start_date = dateCreate(1,12,2020);
+    EventManager em = createEventManagerWithOptions(start_date, EM_OPTION_ARENA);
+
+    ASSERT_TEST(em != NULL, destroyArenaMode);
+    ASSERT_TEST(emAddEventByDiff(em, "event1", 1, 1) == EM_SUCCESS, destroyArenaMode);
+    ASSERT_TEST(emAddEventByDiff(em, "event2", 2, 2) == EM_SUCCESS, destroyArenaMode);
+    ASSERT_TEST(emAddMember(em, "member1", 1) == EM_SUCCESS, destroyArenaMode);
+    ASSERT_TEST(emAddMemberToEvent(em, 1, 1) == EM_SUCCESS, destroyArenaMode);
+    ASSERT_TEST(emAddMemberToEvent(em, 1, 2) == EM_SUCCESS, destroyArenaMode);
+    ASSERT_TEST(emTick(em, 2) == EM_SUCCESS, destroyArenaMode);
+    ASSERT_TEST(emGetEventsAmount(em) == 1, destroyArenaMode);
+    ASSERT_TEST(emAddEventByDiff(em, "event3", 1, 3) == EM_SUCCESS, destroyArenaMode);
+    ASSERT_TEST(strcmp("event2", emGetNextEvent(em)) == 0, destroyArenaMode);
+
+destroyArenaMode:
+    dateDestroy(start_date);
+    destroyEventManager(em);
+    return result;
+}
+
+bool testAddEventsBulk() {
+    bool result = true;
+
+    Date start_date = dateCreate(1,12,2020);
+    Date date1 = dateCreate(3,12,2020);
+    Date date2 = dateCreate(2,12,2020);
+    EventManager em = createEventManager(start_date);
+
+    char* names[] = { "event1", "event2", "event1", "event3" };
+    Date dates[] = { date1, date2, date1, date2 };
+    int ids[] = { 1, 2, 3, 2 };
+    EventManagerResult results[4];
+    ASSERT_TEST(emAddEventsBulk(em, names, dates, ids, 4, results) == EM_SUCCESS, destroyAddEventsBulk);
+    ASSERT_TEST(results[0] == EM_SUCCESS && results[1] == EM_SUCCESS, destroyAddEventsBulk);
+    ASSERT_TEST(results[2] == EM_EVENT_ALREADY_EXISTS, destroyAddEventsBulk);
+    ASSERT_TEST(results[3] == EM_EVENT_ID_ALREADY_EXISTS, destroyAddEventsBulk);
+    ASSERT_TEST(emGetEventsAmount(em) == 2, destroyAddEventsBulk);
+    ASSERT_TEST(strcmp("event2", emGetNextEvent(em)) == 0, destroyAddEventsBulk);
+
+    char* member_names[] = { "member1", "member2" };
+    int member_ids[] = { 1, 1 };
+    ASSERT_TEST(emAddMembersBulk(em, member_names, member_ids, 2, results) == EM_SUCCESS, destroyAddEventsBulk);
+    ASSERT_TEST(results[0] == EM_SUCCESS && results[1] == EM_MEMBER_ID_ALREADY_EXISTS, destroyAddEventsBulk);
+    ASSERT_TEST(emAddMemberToEvent(em, 1, 2) == EM_SUCCESS, destroyAddEventsBulk);
+
+destroyAddEventsBulk:
+    dateDestroy(start_date);
+    dateDestroy(date1);
+    dateDestroy(date2);
+    destroyEventManager(em);
+    return result;
+}
+
+bool testGetTopResponsibleMembers() {
+    bool result = true;
+
+    Date start_date = dateCreate(1,12,2020);
+    EventManager em = createEventManager(start_date);
+    int ids[3];
+    int counts[3];
+
+    ASSERT_TEST(emAddEventByDiff(em, "event1", 1, 1) == EM_SUCCESS, destroyGetTopResponsibleMembers);
+    ASSERT_TEST(emAddEventByDiff(em, "event2", 2, 2) == EM_SUCCESS, destroyGetTopResponsibleMembers);
+    ASSERT_TEST(emAddMember(em, "member1", 1) == EM_SUCCESS, destroyGetTopResponsibleMembers);
+    ASSERT_TEST(emAddMember(em, "member2", 2) == EM_SUCCESS, destroyGetTopResponsibleMembers);
+    ASSERT_TEST(emAddMember(em, "member3", 3) == EM_SUCCESS, destroyGetTopResponsibleMembers);
+    ASSERT_TEST(emAddMemberToEvent(em, 3, 1) == EM_SUCCESS, destroyGetTopResponsibleMembers);
+    ASSERT_TEST(emAddMemberToEvent(em, 3, 2) == EM_SUCCESS, destroyGetTopResponsibleMembers);
+    ASSERT_TEST(emAddMemberToEvent(em, 2, 2) == EM_SUCCESS, destroyGetTopResponsibleMembers);
+
+    ASSERT_TEST(emGetTopResponsibleMembers(em, 3, ids, counts) == 2, destroyGetTopResponsibleMembers);
+    ASSERT_TEST(ids[0] == 3 && counts[0] == 2 && ids[1] == 2 && counts[1] == 1, destroyGetTopResponsibleMembers);
+
+    ASSERT_TEST(emTick(em, 2) == EM_SUCCESS, destroyGetTopResponsibleMembers);
+    ASSERT_TEST(emGetTopResponsibleMembers(em, 1, ids, counts) == 1, destroyGetTopResponsibleMembers);
+    ASSERT_TEST(ids[0] == 2 && counts[0] == 1, destroyGetTopResponsibleMembers);
+
+destroyGetTopResponsibleMembers:
+    dateDestroy(start_date);
+    destroyEventManager(em);
+    return result;
+}
+
+typedef struct {
+    char data[256];
+    int length;
+} TestBuffer;
+
+static bool testBufferWrite(void* context, const char* data, int length) {
+    TestBuffer* buffer = context;
+    if (buffer->length + length >= (int)sizeof(buffer->data)) {
+        return false;
+    }
+    memcpy(buffer->data + buffer->length, data, length);
+    buffer->length += length;
+    buffer->data[buffer->length] = '\0';
+    return true;
+}
+
+static bool testFailingWrite(void* context, const char* data, int length) {
+    (void)context;
+    (void)data;
+    (void)length;
+    return false;
+}
+
+bool testWriteToSink() {
+    bool result = true;
+
+    Date start_date = dateCreate(1,12,2020);
+    EventManager em = createEventManager(start_date);
+    TestBuffer buffer = { "", 0 };
+    EventManagerSink sink = { testBufferWrite, &buffer };
+    EventManagerSink failing_sink = { testFailingWrite, NULL };
+    EventManagerSink null_sink = { NULL, NULL };
+
+    ASSERT_TEST(emAddEventByDiff(em, "event1", 1, 1) == EM_SUCCESS, destroyWriteToSink);
+    ASSERT_TEST(emAddEventByDiff(em, "event2", 2, 2) == EM_SUCCESS, destroyWriteToSink);
+    ASSERT_TEST(emAddMember(em, "member1", 1) == EM_SUCCESS, destroyWriteToSink);
+    ASSERT_TEST(emAddMember(em, "member2", 2) == EM_SUCCESS, destroyWriteToSink);
+    ASSERT_TEST(emAddMemberToEvent(em, 2, 1) == EM_SUCCESS, destroyWriteToSink);
+    ASSERT_TEST(emAddMemberToEvent(em, 1, 1) == EM_SUCCESS, destroyWriteToSink);
+    ASSERT_TEST(emAddMemberToEvent(em, 2, 2) == EM_SUCCESS, destroyWriteToSink);
+
+    ASSERT_TEST(emWriteAllEvents(em, sink) == EM_SUCCESS, destroyWriteToSink);
+    ASSERT_TEST(strcmp(buffer.data, "event1,2.12.2020,member1,member2\nevent2,3.12.2020,member2\n") == 0,
+        destroyWriteToSink);
+
+    buffer.length = 0;
+    ASSERT_TEST(emWriteResponsibleMembers(em, sink) == EM_SUCCESS, destroyWriteToSink);
+    ASSERT_TEST(strcmp(buffer.data, "member2,2\nmember1,1\n") == 0, destroyWriteToSink);
+
+    ASSERT_TEST(emWriteAllEvents(em, failing_sink) == EM_ERROR, destroyWriteToSink);
+    ASSERT_TEST(emWriteAllEvents(em, null_sink) == EM_NULL_ARGUMENT, destroyWriteToSink);
+    ASSERT_TEST(emWriteResponsibleMembers(NULL, sink) == EM_NULL_ARGUMENT, destroyWriteToSink);
+
+destroyWriteToSink:
+    dateDestroy(start_date);
+    destroyEventManager(em);
+    return result;
+}
+
+bool testSnapshot() {
+    bool result = true;
+
+    Date start_date = dateCreate(1,12,2020);
+    EventManager em = createEventManager(start_date);
+    EventManager loaded = NULL;
+    TestBuffer expected = { "", 0 };
+    TestBuffer actual = { "", 0 };
+    EventManagerSink expected_sink = { testBufferWrite, &expected };
+    EventManagerSink actual_sink = { testBufferWrite, &actual };
+    FILE* file = NULL;
+
+    ASSERT_TEST(emAddEventByDiff(em, "event1", 3, 1) == EM_SUCCESS, destroySnapshot);
+    ASSERT_TEST(emAddEventByDiff(em, "event2", 1, 2) == EM_SUCCESS, destroySnapshot);
+    ASSERT_TEST(emAddEventByDiff(em, "event3", 3, 3) == EM_SUCCESS, destroySnapshot);
+    ASSERT_TEST(emAddMember(em, "member2", 2) == EM_SUCCESS, destroySnapshot);
+    ASSERT_TEST(emAddMember(em, "member1", 1) == EM_SUCCESS, destroySnapshot);
+    ASSERT_TEST(emAddMemberToEvent(em, 1, 1) == EM_SUCCESS, destroySnapshot);
+    ASSERT_TEST(emAddMemberToEvent(em, 2, 1) == EM_SUCCESS, destroySnapshot);
+    ASSERT_TEST(emAddMemberToEvent(em, 2, 3) == EM_SUCCESS, destroySnapshot);
+    ASSERT_TEST(emTick(em, 1) == EM_SUCCESS, destroySnapshot);
+
+    ASSERT_TEST(emSaveSnapshot(em, "snapshot_test.bin") == EM_SUCCESS, destroySnapshot);
+    loaded = emLoadSnapshot("snapshot_test.bin");
+    ASSERT_TEST(loaded != NULL, destroySnapshot);
+    ASSERT_TEST(emGetEventsAmount(loaded) == emGetEventsAmount(em), destroySnapshot);
+    ASSERT_TEST(strcmp(emGetNextEvent(loaded), "event2") == 0, destroySnapshot);
+    ASSERT_TEST(emWriteAllEvents(em, expected_sink) == EM_SUCCESS, destroySnapshot);
+    ASSERT_TEST(emWriteAllEvents(loaded, actual_sink) == EM_SUCCESS, destroySnapshot);
+    ASSERT_TEST(strcmp(expected.data, actual.data) == 0, destroySnapshot);
+    expected.length = 0;
+    actual.length = 0;
+    ASSERT_TEST(emWriteResponsibleMembers(em, expected_sink) == EM_SUCCESS, destroySnapshot);
+    ASSERT_TEST(emWriteResponsibleMembers(loaded, actual_sink) == EM_SUCCESS, destroySnapshot);
+    ASSERT_TEST(strcmp(expected.data, actual.data) == 0, destroySnapshot);
+    ASSERT_TEST(emAddEventByDate(loaded, "event0", start_date, 4) == EM_INVALID_DATE, destroySnapshot);
+    ASSERT_TEST(emAddMemberToEvent(loaded, 1, 3) == EM_SUCCESS, destroySnapshot);
+
+    // A damaged snapshot is rejected by the checksum
+    file = fopen("snapshot_test.bin", "r+b");
+    ASSERT_TEST(file != NULL, destroySnapshot);
+    fseek(file, -1, SEEK_END);
+    fputc(0x7f, file);
+    fclose(file);
+    ASSERT_TEST(emLoadSnapshot("snapshot_test.bin") == NULL, destroySnapshot);
+    ASSERT_TEST(emLoadSnapshot("no_such_snapshot.bin") == NULL, destroySnapshot);
+
+destroySnapshot:
+    remove("snapshot_test.bin");
+    dateDestroy(start_date);
+    destroyEventManager(em);
+    destroyEventManager(loaded);
+    return result;
+}
+
+bool testJournalReplay() {
+    bool result = true;
+
+    Date start_date = dateCreate(1,12,2020);
+    Date new_date = dateCreate(10,12,2020);
+    EventManager em = createEventManager(start_date);
+    EventManager restored = NULL;
+    TestBuffer expected = { "", 0 };
+    TestBuffer actual = { "", 0 };
+    EventManagerSink expected_sink = { testBufferWrite, &expected };
+    EventManagerSink actual_sink = { testBufferWrite, &actual };
+    FILE* file = NULL;
+
+    remove("journal_test.bin");
+    ASSERT_TEST(emOpenJournal(em, "journal_test.bin") == EM_SUCCESS, destroyJournalReplay);
+    ASSERT_TEST(emAddEventByDiff(em, "event1", 1, 1) == EM_SUCCESS, destroyJournalReplay);
+    ASSERT_TEST(emAddEventByDiff(em, "event2", 2, 2) == EM_SUCCESS, destroyJournalReplay);
+    ASSERT_TEST(emAddMember(em, "member1", 1) == EM_SUCCESS, destroyJournalReplay);
+    ASSERT_TEST(emAddMemberToEvent(em, 1, 2) == EM_SUCCESS, destroyJournalReplay);
+    // The snapshot empties the journal, which then only holds the mutations made after it
+    ASSERT_TEST(emSaveSnapshot(em, "journal_snapshot_test.bin") == EM_SUCCESS, destroyJournalReplay);
+    ASSERT_TEST(emAddEventByDiff(em, "event3", 3, 3) == EM_SUCCESS, destroyJournalReplay);
+    ASSERT_TEST(emAddMember(em, "member2", 2) == EM_SUCCESS, destroyJournalReplay);
+    ASSERT_TEST(emAddMemberToEvent(em, 2, 3) == EM_SUCCESS, destroyJournalReplay);
+    ASSERT_TEST(emAddMemberToEvent(em, 2, 1) == EM_SUCCESS, destroyJournalReplay);
+    ASSERT_TEST(emRemoveMemberFromEvent(em, 1, 2) == EM_SUCCESS, destroyJournalReplay);
+    ASSERT_TEST(emChangeEventDate(em, 2, new_date) == EM_SUCCESS, destroyJournalReplay);
+    ASSERT_TEST(emTick(em, 1) == EM_SUCCESS, destroyJournalReplay);
+    ASSERT_TEST(emRemoveEvent(em, 3) == EM_SUCCESS, destroyJournalReplay);
+    ASSERT_TEST(emAddEventByDiff(em, "event3", 3, 3) == EM_SUCCESS, destroyJournalReplay);
+    ASSERT_TEST(emSyncJournal(em) == EM_SUCCESS, destroyJournalReplay);
+    ASSERT_TEST(emWriteAllEvents(em, expected_sink) == EM_SUCCESS, destroyJournalReplay);
+
+    // A record torn by a crash ends the journal
+    file = fopen("journal_test.bin", "ab");
+    ASSERT_TEST(file != NULL, destroyJournalReplay);
+    fputs("torn", file);
+    fclose(file);
+
+    restored = emLoadSnapshot("journal_snapshot_test.bin");
+    ASSERT_TEST(restored != NULL, destroyJournalReplay);
+    ASSERT_TEST(emReplayJournal(restored, "journal_test.bin") == EM_SUCCESS, destroyJournalReplay);
+    ASSERT_TEST(emWriteAllEvents(restored, actual_sink) == EM_SUCCESS, destroyJournalReplay);
+    ASSERT_TEST(strcmp(expected.data, actual.data) == 0, destroyJournalReplay);
+    // Replaying again changes nothing, since the manager already holds every record
+    ASSERT_TEST(emReplayJournal(restored, "journal_test.bin") == EM_SUCCESS, destroyJournalReplay);
+    ASSERT_TEST(emGetEventsAmount(restored) == 3, destroyJournalReplay);
+
+destroyJournalReplay:
+    destroyEventManager(em);
+    destroyEventManager(restored);
+    remove("journal_test.bin");
+    remove("journal_snapshot_test.bin");
+    dateDestroy(start_date);
+    dateDestroy(new_date);
+    return result;
+}
+
+bool testImportCsv() {
+    bool result = true;
+
+    Date start_date = dateCreate(1,12,2020);
+    EventManager em = createEventManager(start_date);
+    int imported = 0;
+    TestBuffer buffer = { "", 0 };
+    EventManagerSink sink = { testBufferWrite, &buffer };
+    FILE* file = NULL;
+
+    file = fopen("members_test.csv", "wb");
+    ASSERT_TEST(file != NULL, destroyImportCsv);
+    fputs("2,member2\r\n1,member1\n-3,negative\n1,again\nbad line\n3,member3", file);
+    fclose(file);
+    ASSERT_TEST(emImportMembersCsv(em, "members_test.csv", &imported) == EM_SUCCESS, destroyImportCsv);
+    ASSERT_TEST(imported == 3, destroyImportCsv);
+
+    file = fopen("events_test.csv", "wb");
+    ASSERT_TEST(file != NULL, destroyImportCsv);
+    fputs("event1,3.12.2020,member1,member2\nevent2,2.12.2020,unknown,member2\n\nevent0,30.11.2020\n"
+          "event1,3.12.2020\nevent3,31.12.2020\nevent4,3.12.2020", file);
+    fclose(file);
+    ASSERT_TEST(emImportEventsCsv(em, "events_test.csv", 10, &imported) == EM_SUCCESS, destroyImportCsv);
+    ASSERT_TEST(imported == 3 && emGetEventsAmount(em) == 3, destroyImportCsv);
+
+    file = fopen("links_test.csv", "wb");
+    ASSERT_TEST(file != NULL, destroyImportCsv);
+    fputs("3,15\n3,11\n2,11\n9,10\n", file);
+    fclose(file);
+    ASSERT_TEST(emImportLinksCsv(em, "links_test.csv", &imported) == EM_SUCCESS, destroyImportCsv);
+    ASSERT_TEST(imported == 2, destroyImportCsv);
+
+    ASSERT_TEST(emWriteAllEvents(em, sink) == EM_SUCCESS, destroyImportCsv);
+    ASSERT_TEST(strcmp(buffer.data, "event2,2.12.2020,member2,member3\nevent1,3.12.2020,member1,member2\n"
+                                    "event4,3.12.2020,member3\n") == 0, destroyImportCsv);
+    ASSERT_TEST(emImportEventsCsv(em, "no_such_file.csv", 0, &imported) == EM_ERROR, destroyImportCsv);
+
+destroyImportCsv:
+    remove("members_test.csv");
+    remove("events_test.csv");
+    remove("links_test.csv");
+    dateDestroy(start_date);
+    destroyEventManager(em);
+    return result;
+}
+
+bool testExportChangesSince() {
+    bool result = true;
+
+    Date start_date = dateCreate(1,12,2020);
+    Date new_date = dateCreate(10,12,2020);
+    EventManager em = createEventManager(start_date);
+    TestBuffer buffer = { "", 0 };
+    EventManagerSink sink = { testBufferWrite, &buffer };
+    uint64_t version = 0;
+
+    ASSERT_TEST(emAddEventByDiff(em, "event1", 1, 1) == EM_SUCCESS, destroyExportChangesSince);
+    ASSERT_TEST(emAddEventByDiff(em, "event2", 2, 2) == EM_SUCCESS, destroyExportChangesSince);
+    ASSERT_TEST(emAddEventByDiff(em, "event3", 3, 3) == EM_SUCCESS, destroyExportChangesSince);
+    ASSERT_TEST(emAddMember(em, "member1", 1) == EM_SUCCESS, destroyExportChangesSince);
+    ASSERT_TEST(emExportChangesSince(em, version, sink, &version) == EM_SUCCESS, destroyExportChangesSince);
+    ASSERT_TEST(strcmp(buffer.data, "A,1,event1,2.12.2020\nA,2,event2,3.12.2020\nA,3,event3,4.12.2020\n") == 0,
+        destroyExportChangesSince);
+    ASSERT_TEST(version == emGetVersion(em), destroyExportChangesSince);
+
+    // Nothing changed since the last export
+    buffer.length = 0;
+    buffer.data[0] = '\0';
+    ASSERT_TEST(emExportChangesSince(em, version, sink, &version) == EM_SUCCESS, destroyExportChangesSince);
+    ASSERT_TEST(buffer.length == 0, destroyExportChangesSince);
+
+    ASSERT_TEST(emAddMemberToEvent(em, 1, 3) == EM_SUCCESS, destroyExportChangesSince);
+    ASSERT_TEST(emChangeEventDate(em, 2, new_date) == EM_SUCCESS, destroyExportChangesSince);
+    ASSERT_TEST(emTick(em, 2) == EM_SUCCESS, destroyExportChangesSince);
+    ASSERT_TEST(emRemoveEvent(em, 3) == EM_SUCCESS, destroyExportChangesSince);
+    ASSERT_TEST(emAddEventByDiff(em, "event4", 1, 3) == EM_SUCCESS, destroyExportChangesSince);
+    ASSERT_TEST(emAddMemberToEvent(em, 1, 2) == EM_SUCCESS, destroyExportChangesSince);
+    ASSERT_TEST(emExportChangesSince(em, version, sink, &version) == EM_SUCCESS, destroyExportChangesSince);
+    ASSERT_TEST(strcmp(buffer.data, "E,1\nR,3\nA,3,event4,4.12.2020\nC,2,event2,10.12.2020,member1\n") == 0,
+        destroyExportChangesSince);
+
+    ASSERT_TEST(emExportChangesSince(em, version + 1, sink, &version) == EM_ERROR, destroyExportChangesSince);
+    ASSERT_TEST(emForgetChangesBefore(em, version) == EM_SUCCESS, destroyExportChangesSince);
+    ASSERT_TEST(emExportChangesSince(em, 0, sink, &version) == EM_ERROR, destroyExportChangesSince);
+    ASSERT_TEST(emExportChangesSince(em, version, sink, NULL) == EM_NULL_ARGUMENT, destroyExportChangesSince);
+
+destroyExportChangesSince:
+    dateDestroy(start_date);
+    dateDestroy(new_date);
+    destroyEventManager(em);
+    return result;
+}
+
+typedef struct {
+    unsigned int hash;
+    long length;
+} TestHash;
+
+static bool testHashWrite(void* context, const char* data, int length) {
+    TestHash* hash = context;
+    for (int i = 0; i < length; i++) {
+        hash->hash = (hash->hash ^ (unsigned char)data[i]) * 16777619u;
+    }
+    hash->length += length;
+    return true;
+}
+
+bool testParallelExport() {
+    bool result = true;
+
+    Date start_date = dateCreate(1,12,2020);
+    EventManager em = createEventManager(start_date);
+    TestHash serial = { 2166136261u, 0 };
+    TestHash parallel = { 2166136261u, 0 };
+    EventManagerSink serial_sink = { testHashWrite, &serial };
+    EventManagerSink parallel_sink = { testHashWrite, &parallel };
+    EventManagerSink failing_sink = { testFailingWrite, NULL };
+    char name[32];
+
+    for (int i = 0; i < 20000; i++) {
+        sprintf(name, "event%d", i);
+        ASSERT_TEST(emAddEventByDiff(em, name, i % 700, i) == EM_SUCCESS, destroyParallelExport);
+    }
+    for (int i = 0; i < 50; i++) {
+        sprintf(name, "member%d", i);
+        ASSERT_TEST(emAddMember(em, name, i) == EM_SUCCESS, destroyParallelExport);
+    }
+    for (int i = 0; i < 20000; i += 3) {
+        ASSERT_TEST(emAddMemberToEvent(em, i % 50, i) == EM_SUCCESS, destroyParallelExport);
+        ASSERT_TEST(emAddMemberToEvent(em, (i + 7) % 50, i) == EM_SUCCESS, destroyParallelExport);
+    }
+
+    ASSERT_TEST(emWriteAllEvents(em, serial_sink) == EM_SUCCESS, destroyParallelExport);
+    ASSERT_TEST(emSetExportThreads(em, 4) == EM_SUCCESS, destroyParallelExport);
+    ASSERT_TEST(emWriteAllEvents(em, parallel_sink) == EM_SUCCESS, destroyParallelExport);
+    ASSERT_TEST(serial.length == parallel.length && serial.hash == parallel.hash, destroyParallelExport);
+    ASSERT_TEST(emWriteAllEvents(em, failing_sink) == EM_ERROR, destroyParallelExport);
+    ASSERT_TEST(emSetExportThreads(em, 1) == EM_SUCCESS, destroyParallelExport);
+    ASSERT_TEST(emSetExportThreads(NULL, 4) == EM_NULL_ARGUMENT, destroyParallelExport);
+
+destroyParallelExport:
+    dateDestroy(start_date);
+    destroyEventManager(em);
+    return result;
+}
+
+static void testExportDone(const char* path, EventManagerResult result, void* context) {
+    (void)path;
+    *(EventManagerResult*)context = result;
+}
+
+bool testExportAsync() {
+    bool result = true;
+
+    Date start_date = dateCreate(1,12,2020);
+    EventManager em = createEventManager(start_date);
+    EventManagerResult export_result = EM_NULL_ARGUMENT;
+    EventManagerResult queued_result = EM_NULL_ARGUMENT;
+    TestBuffer expected = { "", 0 };
+    EventManagerSink sink = { testBufferWrite, &expected };
+    char actual[256] = "";
+    FILE* file = NULL;
+
+    ASSERT_TEST(emAddEventByDiff(em, "event1", 1, 1) == EM_SUCCESS, destroyExportAsync);
+    ASSERT_TEST(emAddEventByDiff(em, "event2", 2, 2) == EM_SUCCESS, destroyExportAsync);
+    ASSERT_TEST(emAddMember(em, "member1", 1) == EM_SUCCESS, destroyExportAsync);
+    ASSERT_TEST(emAddMemberToEvent(em, 1, 2) == EM_SUCCESS, destroyExportAsync);
+    ASSERT_TEST(emWriteAllEvents(em, sink) == EM_SUCCESS, destroyExportAsync);
+
+    // The file holds the events as they were when the export started
+    ASSERT_TEST(emExportAsync(em, "export_async_test.csv", testExportDone, &export_result) == EM_SUCCESS,
+        destroyExportAsync);
+    ASSERT_TEST(emRemoveEvent(em, 2) == EM_SUCCESS, destroyExportAsync);
+    ASSERT_TEST(emAddEventByDiff(em, "event3", 3, 3) == EM_SUCCESS, destroyExportAsync);
+    ASSERT_TEST(emWaitForExport(em) == EM_SUCCESS, destroyExportAsync);
+    ASSERT_TEST(export_result == EM_SUCCESS, destroyExportAsync);
+
+    file = fopen("export_async_test.csv", "r");
+    ASSERT_TEST(file != NULL, destroyExportAsync);
+    actual[fread(actual, 1, sizeof(actual) - 1, file)] = '\0';
+    fclose(file);
+    ASSERT_TEST(strcmp(expected.data, actual) == 0, destroyExportAsync);
+
+    // The second export is queued behind the first one, and both are done once the wait returns
+    ASSERT_TEST(emExportAsync(em, "no_such_directory/export.csv", testExportDone, &export_result) == EM_SUCCESS,
+        destroyExportAsync);
+    ASSERT_TEST(emExportAsync(em, "export_async_test.csv", testExportDone, &queued_result) == EM_SUCCESS,
+        destroyExportAsync);
+    ASSERT_TEST(emWaitForExport(em) == EM_SUCCESS, destroyExportAsync);
+    ASSERT_TEST(export_result == EM_ERROR && queued_result == EM_SUCCESS, destroyExportAsync);
+    ASSERT_TEST(emExportAsync(em, NULL, NULL, NULL) == EM_NULL_ARGUMENT, destroyExportAsync);
+
+destroyExportAsync:
+    remove("export_async_test.csv");
+    dateDestroy(start_date);
+    destroyEventManager(em);
+    return result;
+}
+
+typedef struct {
+    int ids[8];
+    int count;
+    int limit;
+} TestVisit;
+
+static bool testVisitEvent(void* context, int event_id, const char* event_name, Date date) {
+    (void)event_name;
+    (void)date;
+    TestVisit* visit = context;
+    visit->ids[visit->count++] = event_id;
+    return visit->count < visit->limit;
+}
+
+bool testEventsInRange() {
+    bool result = true;
+
+    Date start_date = dateCreate(1,12,2020);
+    Date from = dateCreate(2,12,2020);
+    Date to = dateCreate(3,12,2020);
+    Date late = dateCreate(5,12,2020);
+    EventManager em = createEventManager(start_date);
+    TestVisit visit = { { 0 }, 0, 8 };
+    int ids[8];
+
+    ASSERT_TEST(emAddEventByDiff(em, "event1", 2, 1) == EM_SUCCESS, destroyEventsInRange);
+    ASSERT_TEST(emAddEventByDiff(em, "event2", 1, 2) == EM_SUCCESS, destroyEventsInRange);
+    ASSERT_TEST(emAddEventByDiff(em, "event3", 2, 3) == EM_SUCCESS, destroyEventsInRange);
+    ASSERT_TEST(emAddEventByDiff(em, "event4", 5, 4) == EM_SUCCESS, destroyEventsInRange);
+    // A changed event goes after the events it now shares the date with, as in the exports
+    ASSERT_TEST(emChangeEventDate(em, 1, from) == EM_SUCCESS, destroyEventsInRange);
+
+    ASSERT_TEST(emGetNextEvents(em, 3, ids) == 3, destroyEventsInRange);
+    ASSERT_TEST(ids[0] == 2 && ids[1] == 1 && ids[2] == 3, destroyEventsInRange);
+    ASSERT_TEST(emGetEventsInRange(em, from, to, testVisitEvent, &visit) == 3, destroyEventsInRange);
+    ASSERT_TEST(visit.ids[0] == 2 && visit.ids[1] == 1 && visit.ids[2] == 3, destroyEventsInRange);
+
+    visit.count = 0;
+    ASSERT_TEST(emGetEventsInRange(em, to, late, testVisitEvent, &visit) == 1, destroyEventsInRange);
+    ASSERT_TEST(visit.ids[0] == 3, destroyEventsInRange);
+    visit.count = 0;
+    visit.limit = 1;
+    ASSERT_TEST(emGetEventsInRange(em, from, late, testVisitEvent, &visit) == 1, destroyEventsInRange);
+    ASSERT_TEST(emGetEventsInRange(em, to, from, testVisitEvent, &visit) == 0, destroyEventsInRange);
+
+    ASSERT_TEST(emRemoveEvent(em, 3) == EM_SUCCESS, destroyEventsInRange);
+    ASSERT_TEST(emTick(em, 2) == EM_SUCCESS, destroyEventsInRange);
+    ASSERT_TEST(emGetNextEvents(em, 8, ids) == 1 && ids[0] == 4, destroyEventsInRange);
+    ASSERT_TEST(emGetNextEvents(em, 8, NULL) == -1, destroyEventsInRange);
+
+destroyEventsInRange:
+    dateDestroy(start_date);
+    dateDestroy(from);
+    dateDestroy(to);
+    dateDestroy(late);
+    destroyEventManager(em);
+    return result;
+}
+
+#define STRESS_WRITERS 2
+#define STRESS_READERS 3
+#define STRESS_EVENTS 400
+
+typedef struct {
+    EventManager em;
+    int index;
+    bool failed;
+    int last_date;
+} TestStress;
+
+// Every writer owns its own ids and dates, so the final state does not depend on how the writers interleave
+static void testStressChanges(EventManager em, int writer, bool* failed) {
+    char name[32];
+    for (int i = 0; i < STRESS_EVENTS; i++) {
+        int id = writer * STRESS_EVENTS + i;
+        sprintf(name, "stress%d", id);
+        *failed |= emAddEventByDiff(em, name, writer + STRESS_WRITERS * i, id) != EM_SUCCESS;
+        *failed |= emAddMemberToEvent(em, writer, id) != EM_SUCCESS;
+        if (i % 2 == 1) {
+            *failed |= emRemoveEvent(em, id - 1) != EM_SUCCESS;
+        }
+    }
+}
+
+static bool testStressVisit(void* context, int event_id, const char* event_name, Date date) {
+    (void)event_id;
+    TestStress* stress = context;
+    int day, month, year;
+    dateGet(date, &day, &month, &year);
+    int key = (year * 12 + month) * 31 + day;
+    // A reader sees the queue between two changes, never in the middle of one
+    stress->failed |= key < stress->last_date || strncmp(event_name, "stress", 6) != 0;
+    stress->last_date = key;
+    return true;
+}
+
+#ifndef _WIN32
+static void* testStressWriter(void* context) {
+    TestStress* stress = context;
+    testStressChanges(stress->em, stress->index, &stress->failed);
+    return NULL;
+}
+
+static void* testStressReader(void* context) {
+    TestStress* stress = context;
+    Date from = dateCreate(1,1,2000);
+    Date to = dateCreate(1,1,2100);
+    TestHash hash = { 2166136261u, 0 };
+    EventManagerSink sink = { testHashWrite, &hash };
+    int ids[16];
+    for (int i = 0; i < 200; i++) {
+        int amount = emGetEventsAmount(stress->em);
+        stress->failed |= amount < 0 || amount > STRESS_WRITERS * STRESS_EVENTS;
+        // The next event may be removed meanwhile, but its name is still readable
+        const char* next = emGetNextEvent(stress->em);
+        stress->failed |= next != NULL && strncmp(next, "stress", 6) != 0;
+        stress->failed |= emGetNextEvents(stress->em, 16, ids) < 0;
+        stress->last_date = 0;
+        stress->failed |= emGetEventsInRange(stress->em, from, to, testStressVisit, stress) < 0;
+        stress->failed |= emWriteAllEvents(stress->em, sink) != EM_SUCCESS;
+    }
+    dateDestroy(from);
+    dateDestroy(to);
+    return NULL;
+}
+#endif
+
+bool testThreadSafeStress() {
+    bool result = true;
+
+    Date start_date = dateCreate(1,12,2020);
+    EventManager em = createEventManagerWithOptions(start_date, EM_OPTION_THREAD_SAFE);
+    EventManager serial_em = createEventManager(start_date);
+    TestHash expected = { 2166136261u, 0 };
+    TestHash actual = { 2166136261u, 0 };
+    EventManagerSink expected_sink = { testHashWrite, &expected };
+    EventManagerSink actual_sink = { testHashWrite, &actual };
+
+#ifdef _WIN32
+    ASSERT_TEST(em == NULL, destroyThreadSafeStress);
+#else
+    TestStress writers[STRESS_WRITERS];
+    TestStress readers[STRESS_READERS];
+    pthread_t threads[STRESS_WRITERS + STRESS_READERS];
+    bool failed = false;
+
+    ASSERT_TEST(em != NULL && serial_em != NULL, destroyThreadSafeStress);
+    ASSERT_TEST(emSetExportThreads(em, 2) == EM_SUCCESS, destroyThreadSafeStress);
+    for (int i = 0; i < STRESS_WRITERS; i++) {
+        ASSERT_TEST(emAddMember(em, "stress member", i) == EM_SUCCESS, destroyThreadSafeStress);
+        ASSERT_TEST(emAddMember(serial_em, "stress member", i) == EM_SUCCESS, destroyThreadSafeStress);
+        testStressChanges(serial_em, i, &failed);
+    }
+    ASSERT_TEST(!failed, destroyThreadSafeStress);
+
+    for (int i = 0; i < STRESS_WRITERS; i++) {
+        writers[i] = (TestStress){ em, i, false, 0 };
+        pthread_create(&threads[i], NULL, testStressWriter, &writers[i]);
+    }
+    for (int i = 0; i < STRESS_READERS; i++) {
+        readers[i] = (TestStress){ em, i, false, 0 };
+        pthread_create(&threads[STRESS_WRITERS + i], NULL, testStressReader, &readers[i]);
+    }
+    for (int i = 0; i < STRESS_WRITERS + STRESS_READERS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    for (int i = 0; i < STRESS_WRITERS; i++) {
+        ASSERT_TEST(!writers[i].failed, destroyThreadSafeStress);
+    }
+    for (int i = 0; i < STRESS_READERS; i++) {
+        ASSERT_TEST(!readers[i].failed, destroyThreadSafeStress);
+    }
+
+    ASSERT_TEST(emGetEventsAmount(em) == STRESS_WRITERS * STRESS_EVENTS / 2, destroyThreadSafeStress);
+    ASSERT_TEST(emWriteAllEvents(serial_em, expected_sink) == EM_SUCCESS, destroyThreadSafeStress);
+    ASSERT_TEST(emWriteAllEvents(em, actual_sink) == EM_SUCCESS, destroyThreadSafeStress);
+    ASSERT_TEST(expected.length == actual.length && expected.hash == actual.hash, destroyThreadSafeStress);
+#endif
+
+destroyThreadSafeStress:
+    dateDestroy(start_date);
+    destroyEventManager(em);
+    destroyEventManager(serial_em);
+    return result;
+}
+
+bool testShardedEventManager() {
+    bool result = true;
+
+    Date start_date = dateCreate(1,12,2020);
+    Date past_date = dateCreate(1,11,2020);
+    Date new_date = dateCreate(10,12,2020);
+    EventManager em = createEventManager(start_date);
+    ShardedEventManager sem = createShardedEventManager(start_date, 4, EM_OPTION_NONE);
+    char name[32];
+
+    ASSERT_TEST(createShardedEventManager(start_date, 0, EM_OPTION_NONE) == NULL, destroyShardedManager);
+    ASSERT_TEST(sem != NULL && semGetNextEvent(sem) == NULL, destroyShardedManager);
+    for (int i = 0; i < 3; i++) {
+        sprintf(name, "member%d", i);
+        ASSERT_TEST(emAddMember(em, name, i) == EM_SUCCESS, destroyShardedManager);
+        ASSERT_TEST(semAddMember(sem, name, i) == EM_SUCCESS, destroyShardedManager);
+    }
+    ASSERT_TEST(semAddMember(sem, "member", 1) == EM_MEMBER_ID_ALREADY_EXISTS, destroyShardedManager);
+
+    // Every call gets the result an event manager gives, whichever shards the events are in
+    for (int i = 0; i < 40; i++) {
+        sprintf(name, "event%d", i % 10);
+        EventManagerResult expected = emAddEventByDiff(em, name, i % 20, i);
+        ASSERT_TEST(semAddEventByDiff(sem, name, i % 20, i) == expected, destroyShardedManager);
+        expected = emAddMemberToEvent(em, i % 3, i);
+        ASSERT_TEST(semAddMemberToEvent(sem, i % 3, i) == expected, destroyShardedManager);
+    }
+    ASSERT_TEST(semAddEventByDate(sem, "event0", start_date, 0) == EM_EVENT_ALREADY_EXISTS, destroyShardedManager);
+    ASSERT_TEST(semAddEventByDate(sem, "late", start_date, 0) == EM_EVENT_ID_ALREADY_EXISTS, destroyShardedManager);
+    ASSERT_TEST(semAddEventByDate(sem, "late", past_date, 99) == EM_INVALID_DATE, destroyShardedManager);
+    ASSERT_TEST(semAddEventByDate(sem, "late", start_date, -1) == EM_INVALID_EVENT_ID, destroyShardedManager);
+    for (int i = 0; i < 40; i += 3) {
+        EventManagerResult expected = emChangeEventDate(em, i, new_date);
+        ASSERT_TEST(semChangeEventDate(sem, i, new_date) == expected, destroyShardedManager);
+        expected = emRemoveMemberFromEvent(em, i % 3, i + 1);
+        ASSERT_TEST(semRemoveMemberFromEvent(sem, i % 3, i + 1) == expected, destroyShardedManager);
+        expected = emRemoveEvent(em, i + 2);
+        ASSERT_TEST(semRemoveEvent(sem, i + 2) == expected, destroyShardedManager);
+    }
+    ASSERT_TEST(semGetEventsAmount(sem) == emGetEventsAmount(em), destroyShardedManager);
+    ASSERT_TEST(strcmp(semGetNextEvent(sem), emGetNextEvent(em)) == 0, destroyShardedManager);
+
+    for (int days = 1; days <= 4; days++) {
+        ASSERT_TEST(emTick(em, days) == EM_SUCCESS && semTick(sem, days) == EM_SUCCESS, destroyShardedManager);
+        ASSERT_TEST(semGetEventsAmount(sem) == emGetEventsAmount(em), destroyShardedManager);
+        ASSERT_TEST(strcmp(semGetNextEvent(sem), emGetNextEvent(em)) == 0, destroyShardedManager);
+    }
+    ASSERT_TEST(semTick(sem, 0) == EM_INVALID_DATE, destroyShardedManager);
+    ASSERT_TEST(semGetEventsAmount(NULL) == -1, destroyShardedManager);
+
+destroyShardedManager:
+    dateDestroy(start_date);
+    dateDestroy(past_date);
+    dateDestroy(new_date);
+    destroyEventManager(em);
+    destroyShardedEventManager(sem);
+    return result;
+}
+
+#define ASYNC_PRODUCERS 4
+#define ASYNC_EVENTS 250
+
+typedef struct {
+    int succeeded;
+    int failed;
+} TestAsyncCount;
+
+// Runs on the owner thread only, so the counts need no locking
+static void testAsyncDone(EventManagerResult result, void* context) {
+    TestAsyncCount* count = context;
+    if (result == EM_SUCCESS) {
+        count->succeeded++;
+    } else {
+        count->failed++;
+    }
+}
+
+typedef struct {
+    AsyncEventManager aem;
+    int index;
+    TestAsyncCount* count;
+    bool failed;
+} TestAsyncProducer;
+
+static void testAsyncSubmit(TestAsyncProducer* producer) {
+    Date date = dateCreate(1 + producer->index,12,2020);
+    char name[64];
+    for (int i = 0; i < ASYNC_EVENTS; i++) {
+        int id = producer->index * ASYNC_EVENTS + i;
+        // Every tenth name is too long to be copied into the command
+        sprintf(name, i % 10 == 0 ? "async event with a name longer than the inline buffer %d" : "async%d", id);
+        EventManagerResult result;
+        while ((result = aemAddEventByDate(producer->aem, name, date, id, testAsyncDone, producer->count)) == EM_ERROR);
+        producer->failed |= result != EM_SUCCESS;
+        while ((result = aemAddMemberToEvent(producer->aem, id % 2, id, testAsyncDone, producer->count)) == EM_ERROR);
+        producer->failed |= result != EM_SUCCESS;
+    }
+    dateDestroy(date);
+}
+
+#ifndef _WIN32
+static void* testAsyncProducer(void* context) {
+    testAsyncSubmit(context);
+    return NULL;
+}
+#endif
+
+bool testAsyncEventManager() {
+    bool result = true;
+
+    Date start_date = dateCreate(1,12,2020);
+    EventManager em = createEventManager(start_date);
+    // A small ring, so producers also find it full
+    AsyncEventManager aem = createAsyncEventManager(em, 16);
+    TestAsyncCount count = { 0, 0 };
+    TestAsyncProducer producers[ASYNC_PRODUCERS];
+
+    ASSERT_TEST(aem != NULL && createAsyncEventManager(NULL, 16) == NULL, destroyAsyncManager);
+    ASSERT_TEST(emAddMember(em, "member0", 0) == EM_SUCCESS, destroyAsyncManager);
+    ASSERT_TEST(emAddMember(em, "member1", 1) == EM_SUCCESS, destroyAsyncManager);
+
+#ifndef _WIN32
+    pthread_t threads[ASYNC_PRODUCERS];
+    for (int i = 0; i < ASYNC_PRODUCERS; i++) {
+        producers[i] = (TestAsyncProducer){ aem, i, &count, false };
+        pthread_create(&threads[i], NULL, testAsyncProducer, &producers[i]);
+    }
+    for (int i = 0; i < ASYNC_PRODUCERS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+#else
+    for (int i = 0; i < ASYNC_PRODUCERS; i++) {
+        producers[i] = (TestAsyncProducer){ aem, i, &count, false };
+        testAsyncSubmit(&producers[i]);
+    }
+#endif
+    for (int i = 0; i < ASYNC_PRODUCERS; i++) {
+        ASSERT_TEST(!producers[i].failed, destroyAsyncManager);
+    }
+
+    ASSERT_TEST(aemFlush(aem) == EM_SUCCESS, destroyAsyncManager);
+    ASSERT_TEST(count.succeeded == 2 * ASYNC_PRODUCERS * ASYNC_EVENTS && count.failed == 0, destroyAsyncManager);
+    ASSERT_TEST(emGetEventsAmount(em) == ASYNC_PRODUCERS * ASYNC_EVENTS, destroyAsyncManager);
+    ASSERT_TEST(strcmp(emGetNextEvent(em), "async event with a name longer than the inline buffer 0") == 0,
+        destroyAsyncManager);
+
+    // Rejected calls are reported through done as well
+    ASSERT_TEST(aemAddEventByDate(aem, "async1", start_date, 1, testAsyncDone, &count) == EM_SUCCESS,
+        destroyAsyncManager);
+    ASSERT_TEST(aemAddMemberToEvent(aem, 0, 0, testAsyncDone, &count) == EM_SUCCESS, destroyAsyncManager);
+    ASSERT_TEST(aemAddEventByDate(aem, NULL, start_date, 1, NULL, NULL) == EM_NULL_ARGUMENT, destroyAsyncManager);
+    ASSERT_TEST(aemFlush(aem) == EM_SUCCESS && count.failed == 2, destroyAsyncManager);
+
+destroyAsyncManager:
+    destroyAsyncEventManager(aem);
+    dateDestroy(start_date);
+    destroyEventManager(em);
+    return result;
+}
+
+typedef struct {
+    int calls;
+    int events;
+    int ids[4];
+    char names[4][16];
+    int members[4];
+    int member_ids[4][3];
+} TestExpired;
+
+static void testExpirationHandlerCollect(void* context, const EventManagerExpiredEvent* events, int count) {
+    TestExpired* expired = context;
+    expired->calls++;
+    for (int i = 0; i < count && expired->events < 4; i++, expired->events++) {
+        expired->ids[expired->events] = events[i].event_id;
+        strcpy(expired->names[expired->events], events[i].event_name);
+        expired->members[expired->events] = events[i].member_count;
+        for (int j = 0; j < events[i].member_count && j < 3; j++) {
+            expired->member_ids[expired->events][j] = events[i].member_ids[j];
+        }
+    }
+}
+
+bool testExpirationHandler() {
+    bool result = true;
+
+    Date start_date = dateCreate(1,12,2020);
+    EventManager em = createEventManager(start_date);
+    TestExpired expired = { 0 };
+
+    ASSERT_TEST(emSetExpirationHandler(NULL, testExpirationHandlerCollect, &expired) == EM_NULL_ARGUMENT,
+        destroyExpirationManager);
+    ASSERT_TEST(emSetExpirationHandler(em, testExpirationHandlerCollect, &expired) == EM_SUCCESS,
+        destroyExpirationManager);
+    ASSERT_TEST(emAddEventByDiff(em, "event1", 0, 1) == EM_SUCCESS, destroyExpirationManager);
+    ASSERT_TEST(emAddEventByDiff(em, "event2", 1, 2) == EM_SUCCESS, destroyExpirationManager);
+    ASSERT_TEST(emAddEventByDiff(em, "event3", 5, 3) == EM_SUCCESS, destroyExpirationManager);
+    ASSERT_TEST(emAddMember(em, "member1", 1) == EM_SUCCESS, destroyExpirationManager);
+    ASSERT_TEST(emAddMember(em, "member2", 2) == EM_SUCCESS, destroyExpirationManager);
+    ASSERT_TEST(emAddMemberToEvent(em, 2, 2) == EM_SUCCESS, destroyExpirationManager);
+    ASSERT_TEST(emAddMemberToEvent(em, 1, 2) == EM_SUCCESS, destroyExpirationManager);
+    ASSERT_TEST(emAddMemberToEvent(em, 1, 3) == EM_SUCCESS, destroyExpirationManager);
+
+    // Both days expire in one batch, with their members
+    ASSERT_TEST(emTick(em, 2) == EM_SUCCESS, destroyExpirationManager);
+    ASSERT_TEST(expired.calls == 1 && expired.events == 2, destroyExpirationManager);
+    ASSERT_TEST(expired.ids[0] == 1 && strcmp(expired.names[0], "event1") == 0 && expired.members[0] == 0,
+        destroyExpirationManager);
+    ASSERT_TEST(expired.ids[1] == 2 && strcmp(expired.names[1], "event2") == 0 && expired.members[1] == 2,
+        destroyExpirationManager);
+    ASSERT_TEST((expired.member_ids[1][0] == 1 && expired.member_ids[1][1] == 2) ||
+        (expired.member_ids[1][0] == 2 && expired.member_ids[1][1] == 1), destroyExpirationManager);
+
+    // Nothing expires, so the handler is not called
+    ASSERT_TEST(emTick(em, 1) == EM_SUCCESS && expired.calls == 1, destroyExpirationManager);
+
+    // Removing the handler stops the calls
+    ASSERT_TEST(emSetExpirationHandler(em, NULL, NULL) == EM_SUCCESS, destroyExpirationManager);
+    ASSERT_TEST(emTick(em, 5) == EM_SUCCESS && expired.calls == 1, destroyExpirationManager);
+    ASSERT_TEST(emGetEventsAmount(em) == 0, destroyExpirationManager);
+
+destroyExpirationManager:
+    dateDestroy(start_date);
+    destroyEventManager(em);
+    return result;
+}
+
+typedef struct {
+    EventManager em;
+    int expired;
+    bool stopped;
+} TestScheduler;
+
+static void testSchedulerExpired(void* context, const EventManagerExpiredEvent* events, int count) {
+    (void)events;
+    TestScheduler* scheduler = context;
+    scheduler->expired += count;
+    if (scheduler->expired == 3) {
+        scheduler->stopped = emStopScheduler(scheduler->em) == EM_SUCCESS;
+    }
+}
+
+bool testScheduler() {
+    bool result = true;
+
+    Date start_date = dateCreate(1,12,2020);
+    EventManager em = createEventManager(start_date);
+    TestScheduler scheduler = { em, 0, false };
+
+    ASSERT_TEST(emAddEventByDiff(em, "event1", 0, 1) == EM_SUCCESS, destroySchedulerManager);
+    ASSERT_TEST(emAddEventByDiff(em, "event2", 2, 2) == EM_SUCCESS, destroySchedulerManager);
+    ASSERT_TEST(emAddEventByDiff(em, "event3", 3, 3) == EM_SUCCESS, destroySchedulerManager);
+#ifdef __linux__
+    ASSERT_TEST(emGetSchedulerFd(em) == -1 && emDispatchScheduler(em) == EM_ERROR, destroySchedulerManager);
+    ASSERT_TEST(emStartScheduler(em, 0) == EM_ERROR, destroySchedulerManager);
+
+    // Driven from a poll loop, the first wake-up expires the event of the current day only
+    ASSERT_TEST(emStartScheduler(em, 20) == EM_SUCCESS, destroySchedulerManager);
+    ASSERT_TEST(emStartScheduler(em, 20) == EM_ERROR, destroySchedulerManager);
+    struct pollfd fd = { emGetSchedulerFd(em), POLLIN, 0 };
+    ASSERT_TEST(fd.fd >= 0 && poll(&fd, 1, 5000) == 1, destroySchedulerManager);
+    ASSERT_TEST(emDispatchScheduler(em) == EM_SUCCESS && emGetEventsAmount(em) == 2, destroySchedulerManager);
+    ASSERT_TEST(strcmp(emGetNextEvent(em), "event2") == 0, destroySchedulerManager);
+    ASSERT_TEST(emStopScheduler(em) == EM_SUCCESS && emGetSchedulerFd(em) == -1, destroySchedulerManager);
+
+    // An earlier event moves the timer, and the handler stops the loop once all three expired
+    ASSERT_TEST(emSetExpirationHandler(em, testSchedulerExpired, &scheduler) == EM_SUCCESS, destroySchedulerManager);
+    ASSERT_TEST(emAddEventByDiff(em, "event4", 1, 4) == EM_SUCCESS, destroySchedulerManager);
+    ASSERT_TEST(emRunScheduler(em, 10) == EM_SUCCESS, destroySchedulerManager);
+    ASSERT_TEST(scheduler.expired == 3 && scheduler.stopped && emGetEventsAmount(em) == 0, destroySchedulerManager);
+    ASSERT_TEST(emGetSchedulerFd(em) == -1, destroySchedulerManager);
+#else
+    ASSERT_TEST(emRunScheduler(em, 10) == EM_ERROR && emGetSchedulerFd(em) == -1, destroySchedulerManager);
+    (void)scheduler;
+#endif
+
+destroySchedulerManager:
+    dateDestroy(start_date);
+    destroyEventManager(em);
+    return result;
+}
+
+bool testTransactions() {
+    bool result = true;
+
+    Date start_date = dateCreate(1,12,2020);
+    Date new_date = dateCreate(10,12,2020);
+    EventManager em = createEventManager(start_date);
+    EventManager replayed = createEventManager(start_date);
+    EventManager uncommitted = createEventManager(start_date);
+    EventManager thread_safe = createEventManagerWithOptions(start_date, EM_OPTION_THREAD_SAFE);
+    TestBuffer expected = { "", 0 };
+    TestBuffer actual = { "", 0 };
+    EventManagerSink expected_sink = { testBufferWrite, &expected };
+    EventManagerSink actual_sink = { testBufferWrite, &actual };
+
+    remove("transaction_test.bin");
+    ASSERT_TEST(emOpenJournal(em, "transaction_test.bin") == EM_SUCCESS, destroyTransactions);
+    ASSERT_TEST(emAddEventByDiff(em, "event1", 1, 1) == EM_SUCCESS, destroyTransactions);
+    ASSERT_TEST(emAddEventByDiff(em, "event2", 1, 2) == EM_SUCCESS, destroyTransactions);
+    ASSERT_TEST(emAddMember(em, "member1", 1) == EM_SUCCESS, destroyTransactions);
+    ASSERT_TEST(emAddMember(em, "member2", 2) == EM_SUCCESS, destroyTransactions);
+    ASSERT_TEST(emAddMemberToEvent(em, 1, 1) == EM_SUCCESS, destroyTransactions);
+    ASSERT_TEST(emAddMemberToEvent(em, 2, 1) == EM_SUCCESS, destroyTransactions);
+    ASSERT_TEST(emWriteAllEvents(em, expected_sink) == EM_SUCCESS, destroyTransactions);
+    ASSERT_TEST(emWriteResponsibleMembers(em, expected_sink) == EM_SUCCESS, destroyTransactions);
+
+    ASSERT_TEST(emCommit(em) == EM_ERROR && emRollback(em) == EM_ERROR, destroyTransactions);
+    ASSERT_TEST(emBegin(em) == EM_SUCCESS && emBegin(em) == EM_ERROR, destroyTransactions);
+    ASSERT_TEST(emAddEventByDiff(em, "event3", 2, 3) == EM_SUCCESS, destroyTransactions);
+    ASSERT_TEST(emAddMember(em, "member3", 3) == EM_SUCCESS, destroyTransactions);
+    ASSERT_TEST(emAddMemberToEvent(em, 3, 3) == EM_SUCCESS, destroyTransactions);
+    ASSERT_TEST(emAddMemberToEvent(em, 3, 1) == EM_SUCCESS, destroyTransactions);
+    ASSERT_TEST(emRemoveMemberFromEvent(em, 1, 1) == EM_SUCCESS, destroyTransactions);
+    ASSERT_TEST(emChangeEventDate(em, 2, new_date) == EM_SUCCESS, destroyTransactions);
+    ASSERT_TEST(emRemoveEvent(em, 1) == EM_SUCCESS, destroyTransactions);
+    // Failed calls are not part of the transaction, and ticks are refused
+    ASSERT_TEST(emAddMember(em, "member3", 3) == EM_MEMBER_ID_ALREADY_EXISTS, destroyTransactions);
+    ASSERT_TEST(emTick(em, 1) == EM_ERROR, destroyTransactions);
+    ASSERT_TEST(emSaveSnapshot(em, "transaction_snapshot_test.bin") == EM_ERROR, destroyTransactions);
+    ASSERT_TEST(emGetEventsAmount(em) == 2 && strcmp(emGetNextEvent(em), "event3") == 0, destroyTransactions);
+
+    // Everything is back as it was before emBegin
+    ASSERT_TEST(emRollback(em) == EM_SUCCESS && emRollback(em) == EM_ERROR, destroyTransactions);
+    ASSERT_TEST(emWriteAllEvents(em, actual_sink) == EM_SUCCESS, destroyTransactions);
+    ASSERT_TEST(emWriteResponsibleMembers(em, actual_sink) == EM_SUCCESS, destroyTransactions);
+    ASSERT_TEST(strcmp(expected.data, actual.data) == 0, destroyTransactions);
+    ASSERT_TEST(emAddMember(em, "member3", 3) == EM_SUCCESS, destroyTransactions);
+
+    ASSERT_TEST(emBegin(em) == EM_SUCCESS, destroyTransactions);
+    ASSERT_TEST(emAddEventByDiff(em, "event4", 3, 4) == EM_SUCCESS, destroyTransactions);
+    ASSERT_TEST(emAddMemberToEvent(em, 3, 4) == EM_SUCCESS, destroyTransactions);
+    // The journal gets the changes of a transaction once it ends, so a crash before cannot replay half of it
+    ASSERT_TEST(emSyncJournal(em) == EM_SUCCESS, destroyTransactions);
+    ASSERT_TEST(emReplayJournal(uncommitted, "transaction_test.bin") == EM_SUCCESS, destroyTransactions);
+    ASSERT_TEST(emGetEventsAmount(uncommitted) == 2, destroyTransactions);
+    ASSERT_TEST(emCommit(em) == EM_SUCCESS && emCommit(em) == EM_ERROR, destroyTransactions);
+    ASSERT_TEST(emGetEventsAmount(em) == 3, destroyTransactions);
+
+    // The journal skips the rolled back transaction, so replaying it ends in the same state
+    expected = (TestBuffer){ "", 0 };
+    actual = (TestBuffer){ "", 0 };
+    ASSERT_TEST(emSyncJournal(em) == EM_SUCCESS, destroyTransactions);
+    ASSERT_TEST(emReplayJournal(replayed, "transaction_test.bin") == EM_SUCCESS, destroyTransactions);
+    ASSERT_TEST(emWriteAllEvents(em, expected_sink) == EM_SUCCESS, destroyTransactions);
+    ASSERT_TEST(emWriteAllEvents(replayed, actual_sink) == EM_SUCCESS, destroyTransactions);
+    ASSERT_TEST(strcmp(expected.data, actual.data) == 0, destroyTransactions);
+
+#ifndef _WIN32
+    // The thread of the transaction sees its changes before they are published
+    ASSERT_TEST(thread_safe != NULL && emBegin(thread_safe) == EM_SUCCESS, destroyTransactions);
+    ASSERT_TEST(emAddEventByDiff(thread_safe, "event1", 1, 1) == EM_SUCCESS, destroyTransactions);
+    ASSERT_TEST(emGetEventsAmount(thread_safe) == 1, destroyTransactions);
+    ASSERT_TEST(strcmp(emGetNextEvent(thread_safe), "event1") == 0, destroyTransactions);
+    ASSERT_TEST(emRollback(thread_safe) == EM_SUCCESS, destroyTransactions);
+    ASSERT_TEST(emGetEventsAmount(thread_safe) == 0 && emGetNextEvent(thread_safe) == NULL, destroyTransactions);
+#endif
+
+destroyTransactions:
+    destroyEventManager(em);
+    destroyEventManager(replayed);
+    destroyEventManager(uncommitted);
+    destroyEventManager(thread_safe);
+    remove("transaction_test.bin");
+    dateDestroy(start_date);
+    dateDestroy(new_date);
+    return result;
+}
+
+bool testReserve() {
+    bool result = true;
+
+    Date start_date = dateCreate(1,12,2020);
+    EventManager plain = createEventManager(start_date);
+    EventManager em = createEventManagerWithOptions(start_date, EM_OPTION_ARENA);
+    int events = -1, members = -1, links = -1, name_bytes = -1;
+
+    // The reservation lives in the arena, and amounts cannot be negative
+    ASSERT_TEST(emReserve(NULL, 1, 1, 1, 1) == EM_NULL_ARGUMENT, destroyReserve);
+    ASSERT_TEST(emReserve(plain, 1, 1, 1, 1) == EM_ERROR, destroyReserve);
+    ASSERT_TEST(emReserve(em, -1, 1, 1, 1) == EM_ERROR, destroyReserve);
+    ASSERT_TEST(emGetReservation(NULL, NULL, NULL, NULL, NULL) == EM_NULL_ARGUMENT, destroyReserve);
+    ASSERT_TEST(emGetReservation(em, &events, &members, &links, &name_bytes) == EM_SUCCESS, destroyReserve);
+    ASSERT_TEST(events == 0 && members == 0 && links == 0 && name_bytes == 0, destroyReserve);
+
+    // Reservations add up, and every add takes its share with its name
+    ASSERT_TEST(emReserve(em, 2, 1, 0, 10) == EM_SUCCESS, destroyReserve);
+    ASSERT_TEST(emReserve(em, 1, 1, 3, 20) == EM_SUCCESS, destroyReserve);
+    ASSERT_TEST(emAddEventByDiff(em, "event1", 1, 1) == EM_SUCCESS, destroyReserve);
+    ASSERT_TEST(emAddEventByDiff(em, "event2", 2, 2) == EM_SUCCESS, destroyReserve);
+    ASSERT_TEST(emAddMember(em, "member1", 1) == EM_SUCCESS, destroyReserve);
+    ASSERT_TEST(emAddMemberToEvent(em, 1, 1) == EM_SUCCESS, destroyReserve);
+    ASSERT_TEST(emAddMemberToEvent(em, 1, 2) == EM_SUCCESS, destroyReserve);
+    // Rejected adds take nothing
+    ASSERT_TEST(emAddMemberToEvent(em, 1, 2) == EM_EVENT_AND_MEMBER_ALREADY_LINKED, destroyReserve);
+    ASSERT_TEST(emGetReservation(em, &events, &members, &links, &name_bytes) == EM_SUCCESS, destroyReserve);
+    ASSERT_TEST(events == 1 && members == 1 && links == 1 && name_bytes == 30 - 7 - 7 - 8, destroyReserve);
+
+    // Going past an amount is reported until more is reserved
+    ASSERT_TEST(emAddMember(em, "member2", 2) == EM_SUCCESS, destroyReserve);
+    ASSERT_TEST(emAddMember(em, "member3", 3) == EM_SUCCESS, destroyReserve);
+    ASSERT_TEST(emGetReservation(em, NULL, &members, NULL, &name_bytes) == EM_RESERVATION_EXHAUSTED, destroyReserve);
+    ASSERT_TEST(members == 0 && name_bytes == 0, destroyReserve);
+    ASSERT_TEST(emReserve(em, 0, 1, 0, 8) == EM_SUCCESS, destroyReserve);
+    ASSERT_TEST(emGetReservation(em, NULL, NULL, NULL, NULL) == EM_SUCCESS, destroyReserve);
+    ASSERT_TEST(emGetEventsAmount(em) == 2 && strcmp(emGetNextEvent(em), "event1") == 0, destroyReserve);
+
+destroyReserve:
+    dateDestroy(start_date);
+    destroyEventManager(plain);
+    destroyEventManager(em);
+    return result;
+}
+
+static bool testFillTenant(EventManager em, int first_id) {
+    return emAddEventByDiff(em, "event1", 1, first_id) == EM_SUCCESS
+        && emAddEventByDiff(em, "event2", 3, first_id + 1) == EM_SUCCESS
+        && emAddEventByDiff(em, "event3", 2, first_id + 2) == EM_SUCCESS
+        && emAddMember(em, "member1", 1) == EM_SUCCESS
+        && emAddMember(em, "member2", 2) == EM_SUCCESS
+        && emAddMemberToEvent(em, 1, first_id) == EM_SUCCESS
+        && emAddMemberToEvent(em, 2, first_id) == EM_SUCCESS
+        && emAddMemberToEvent(em, 2, first_id + 1) == EM_SUCCESS
+        && emRemoveEvent(em, first_id + 2) == EM_SUCCESS;
+}
+
+bool testEventManagerContext() {
+    bool result = true;
+
+    Date start_date = dateCreate(1,12,2020);
+    EventManagerContext context = createEventManagerContext();
+    EventManager plain = createEventManager(start_date);
+    EventManager first = NULL;
+    EventManager second = NULL;
+    TestBuffer expected = { "", 0 };
+    TestBuffer actual = { "", 0 };
+    EventManagerSink expected_sink = { testBufferWrite, &expected };
+    EventManagerSink actual_sink = { testBufferWrite, &actual };
+
+    ASSERT_TEST(context != NULL, destroyContext);
+    ASSERT_TEST(createEventManagerInContext(NULL, start_date, EM_OPTION_NONE) == NULL, destroyContext);
+    ASSERT_TEST(createEventManagerInContext(context, NULL, EM_OPTION_NONE) == NULL, destroyContext);
+    ASSERT_TEST(createEventManagerInContext(context, start_date, EM_OPTION_THREAD_SAFE) == NULL, destroyContext);
+    first = createEventManagerInContext(context, start_date, EM_OPTION_NONE);
+    second = createEventManagerInContext(context, start_date, EM_OPTION_NONE);
+    ASSERT_TEST(first != NULL && second != NULL, destroyContext);
+
+    // Managers of one context share names but nothing else
+    ASSERT_TEST(testFillTenant(plain, 1) && testFillTenant(first, 1) && testFillTenant(second, 10), destroyContext);
+    ASSERT_TEST(emWriteAllEvents(plain, expected_sink) == EM_SUCCESS, destroyContext);
+    ASSERT_TEST(emWriteResponsibleMembers(plain, expected_sink) == EM_SUCCESS, destroyContext);
+    ASSERT_TEST(emWriteAllEvents(first, actual_sink) == EM_SUCCESS, destroyContext);
+    ASSERT_TEST(emWriteResponsibleMembers(first, actual_sink) == EM_SUCCESS, destroyContext);
+    ASSERT_TEST(strcmp(expected.data, actual.data) == 0, destroyContext);
+    ASSERT_TEST(emGetEventsAmount(second) == 2 && emRemoveEvent(second, 1) == EM_EVENT_NOT_EXISTS, destroyContext);
+
+    // The memory of a destroyed manager is reused by the next one
+    destroyEventManager(first);
+    first = createEventManagerInContext(context, start_date, EM_OPTION_NONE);
+    ASSERT_TEST(first != NULL && testFillTenant(first, 1), destroyContext);
+    actual.length = 0;
+    ASSERT_TEST(emWriteAllEvents(first, actual_sink) == EM_SUCCESS, destroyContext);
+    ASSERT_TEST(emWriteResponsibleMembers(first, actual_sink) == EM_SUCCESS, destroyContext);
+    ASSERT_TEST(strcmp(expected.data, actual.data) == 0, destroyContext);
+    ASSERT_TEST(emReserve(second, 4, 4, 4, 64) == EM_SUCCESS, destroyContext);
+    ASSERT_TEST(emTick(second, 2) == EM_SUCCESS && strcmp(emGetNextEvent(second), "event2") == 0, destroyContext);
+
+destroyContext:
+    dateDestroy(start_date);
+    destroyEventManager(plain);
+    destroyEventManager(first);
+    destroyEventManager(second);
+    destroyEventManagerContext(context);
+    return result;
+}
+
+#define EPOCH_READERS 3
+#define EPOCH_ROUNDS 300
+#define EPOCH_HELD 8
+
+typedef struct {
+    EventManager em;
+    bool failed;
+} TestEpochReader;
+
+#ifndef _WIN32
+static void* testEpochReader(void* context) {
+    TestEpochReader* reader = context;
+    const char* held[EPOCH_HELD] = { NULL };
+    for (int i = 0; i < 20 * EPOCH_ROUNDS; i++) {
+        // The next event may expire, move or be removed meanwhile, but the names read before stay valid
+        const char* next = emGetNextEvent(reader->em);
+        reader->failed |= next != NULL && strncmp(next, "epoch", 5) != 0;
+        held[i % EPOCH_HELD] = next;
+        for (int j = 0; j < EPOCH_HELD; j++) {
+            reader->failed |= held[j] != NULL && strncmp(held[j], "epoch", 5) != 0;
+        }
+        int amount = emGetEventsAmount(reader->em);
+        reader->failed |= amount < 0 || amount > EPOCH_ROUNDS;
+    }
+    return NULL;
+}
+#endif
+
+bool testEpochReaders() {
+    bool result = true;
+
+    Date start_date = dateCreate(1,12,2020);
+    Date later = dateCreate(1,1,2030);
+    EventManager em = createEventManagerWithOptions(start_date, EM_OPTION_THREAD_SAFE);
+
+#ifdef _WIN32
+    ASSERT_TEST(em == NULL, destroyEpochReaders);
+#else
+    TestEpochReader readers[EPOCH_READERS];
+    pthread_t threads[EPOCH_READERS];
+    char name[32];
+
+    ASSERT_TEST(em != NULL && later != NULL, destroyEpochReaders);
+    ASSERT_TEST(emAddMember(em, "epoch member", 1) == EM_SUCCESS, destroyEpochReaders);
+    for (int i = 0; i < EPOCH_READERS; i++) {
+        readers[i] = (TestEpochReader){ em, false };
+        pthread_create(&threads[i], NULL, testEpochReader, &readers[i]);
+    }
+    // Every event is moved away, removed or expires while the readers may be holding it, and rollbacks remove members
+    for (int i = 0; i < EPOCH_ROUNDS; i++) {
+        sprintf(name, "epoch%d", i);
+        ASSERT_TEST(emAddEventByDiff(em, name, 2 + i % 3, i) == EM_SUCCESS, joinEpochReaders);
+        ASSERT_TEST(emAddMemberToEvent(em, 1, i) == EM_SUCCESS, joinEpochReaders);
+        if (i % 3 == 1) {
+            ASSERT_TEST(emChangeEventDate(em, i - 1, later) == EM_SUCCESS, joinEpochReaders);
+        }
+        if (i % 3 == 2) {
+            ASSERT_TEST(emRemoveEvent(em, i - 2) == EM_SUCCESS, joinEpochReaders);
+        }
+        if (i % 10 == 9) {
+            ASSERT_TEST(emTick(em, 1) == EM_SUCCESS, joinEpochReaders);
+        }
+        if (i % 10 == 4) {
+            ASSERT_TEST(emBegin(em) == EM_SUCCESS, joinEpochReaders);
+            ASSERT_TEST(emAddMember(em, "epoch rolled back", 2) == EM_SUCCESS, joinEpochReaders);
+            ASSERT_TEST(emRollback(em) == EM_SUCCESS, joinEpochReaders);
+        }
+    }
+
+joinEpochReaders:
+    for (int i = 0; i < EPOCH_READERS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    for (int i = 0; i < EPOCH_READERS; i++) {
+        ASSERT_TEST(!readers[i].failed, destroyEpochReaders);
+    }
+#endif
+
+destroyEpochReaders:
+    dateDestroy(start_date);
+    dateDestroy(later);
+    destroyEventManager(em);
+    return result;
+}
+
 bool (*tests[]) (void) = {
         testEventManagerCreateDestroy,
         testAddEventByDiffAndSize,
-        testEMTick
+        testEMTick,
+        testArenaMode,
+        testAddEventsBulk,
+        testGetTopResponsibleMembers,
+        testWriteToSink,
+        testSnapshot,
+        testJournalReplay,
+        testImportCsv,
+        testExportChangesSince,
+        testParallelExport,
+        testExportAsync,
+        testEventsInRange,
+        testThreadSafeStress,
+        testShardedEventManager,
+        testAsyncEventManager,
+        testExpirationHandler,
+        testScheduler,
+        testTransactions,
+        testReserve,
+        testEventManagerContext,
+        testEpochReaders
 };
 
 const char* testNames[] = {
         "testEventManagerCreateDestroy",
         "testAddEventByDiffAndSize",
-        "testEMTick"
+        "testEMTick",
+        "testArenaMode",
+        "testAddEventsBulk",
+        "testGetTopResponsibleMembers",
+        "testWriteToSink",
+        "testSnapshot",
+        "testJournalReplay",
+        "testImportCsv",
+        "testExportChangesSince",
+        "testParallelExport",
+        "testExportAsync",
+        "testEventsInRange",
+        "testThreadSafeStress",
+        "testShardedEventManager",
+        "testAsyncEventManager",
+        "testExpirationHandler",
+        "testScheduler",
+        "testTransactions",
+        "testReserve",
+        "testEventManagerContext",
+        "testEpochReaders"
 };
 
 int main(int argc, char *argv[]) {
@@ -0,0 +1,144 @@
+#include "file_map.h"
+#include "stdbool.h"
+#include "stdlib.h"
+#include "stdio.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+struct FileMap_t
+{
+	char* data;
+	size_t size;
+};
+
+#ifdef _WIN32
+
+static bool fileMapLoad(FileMap map, const char* path)
+{
+	FILE* file = fopen(path, "rb");
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	bool result = fseek(file, 0, SEEK_END) == 0;
+	long size = result ? ftell(file) : -1;
+	result = size >= 0 && fseek(file, 0, SEEK_SET) == 0;
+	if (result && size > 0)
+	{
+		map->data = malloc(size);
+		result = map->data != NULL && fread(map->data, 1, size, file) == (size_t)size;
+		if (!result)
+		{
+			free(map->data);
+			map->data = NULL;
+		}
+	}
+	map->size = result ? (size_t)size : 0;
+
+	fclose(file);
+	return result;
+}
+
+static void fileMapUnload(FileMap map)
+{
+	free(map->data);
+}
+
+#else
+
+static bool fileMapLoad(FileMap map, const char* path)
+{
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	struct stat status;
+	bool result = fstat(fd, &status) == 0;
+	if (result && status.st_size > 0)
+	{
+		void* data = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		result = data != MAP_FAILED;
+		if (result)
+		{
+			map->data = data;
+			map->size = status.st_size;
+		}
+	}
+
+	// The mapping stays valid after the descriptor is closed
+	close(fd);
+	return result;
+}
+
+static void fileMapUnload(FileMap map)
+{
+	if (map->data != NULL)
+	{
+		munmap(map->data, map->size);
+	}
+}
+
+#endif
+
+FileMap fileMapOpen(const char* path)
+{
+	if (path == NULL)
+	{
+		return NULL;
+	}
+
+	FileMap map = malloc(sizeof(*map));
+	if (map == NULL)
+	{
+		return NULL;
+	}
+
+	map->data = NULL;
+	map->size = 0;
+	if (!fileMapLoad(map, path))
+	{
+		free(map);
+		return NULL;
+	}
+
+	return map;
+}
+
+void fileMapClose(FileMap map)
+{
+	if (map == NULL)
+	{
+		return;
+	}
+
+	fileMapUnload(map);
+	free(map);
+}
+
+const char* fileMapGetData(FileMap map)
+{
+	if (map == NULL)
+	{
+		return NULL;
+	}
+
+	return map->data;
+}
+
+size_t fileMapGetSize(FileMap map)
+{
+	if (map == NULL)
+	{
+		return 0;
+	}
+
+	return map->size;
+}
@@ -0,0 +1,58 @@
+#ifndef FILE_MAP_H
+#define FILE_MAP_H
+
+#include <stddef.h>
+
+/**
+* Read-Only File Map
+*
+* Gives access to the whole contents of a file as one block of memory.
+* Where mmap(2) is available the file is mapped, so pages are only read from disk when they are touched
+* and no copy is made; elsewhere the file is read into a heap buffer.
+*
+* The following functions are available:
+*   fileMapOpen		- Maps a file to memory
+*   fileMapClose	- Unmaps a file
+*   fileMapGetData	- Returns the contents of a mapped file
+*   fileMapGetSize	- Returns the size of a mapped file in bytes
+*/
+
+/** Type for defining the file map */
+typedef struct FileMap_t* FileMap;
+
+/**
+* fileMapOpen: Maps a file to memory for reading.
+*
+* @param path - The path of the file.
+* @return
+* 	NULL - if a NULL was sent, the file could not be opened or an allocation failed.
+* 	A new FileMap in case of success.
+*/
+FileMap fileMapOpen(const char* path);
+
+/**
+* fileMapClose: Unmaps a file. The data returned by fileMapGetData is no longer valid afterwards.
+*
+* @param map - Target file map. If map is NULL nothing will be done
+*/
+void fileMapClose(FileMap map);
+
+/**
+* fileMapGetData: Returns the contents of a mapped file.
+*
+* @return
+* 	NULL if a NULL was sent or the file is empty.
+* 	The first byte of the file otherwise.
+*/
+const char* fileMapGetData(FileMap map);
+
+/**
+* fileMapGetSize: Returns the size of a mapped file.
+*
+* @return
+* 	0 if a NULL was sent or the file is empty.
+* 	The size of the file in bytes otherwise.
+*/
+size_t fileMapGetSize(FileMap map);
+
+#endif /* FILE_MAP_H */
@@ -0,0 +1,234 @@
+#include "hash_table.h"
+#include "stdlib.h"
+#include "string.h"
+
+#define HASH_TABLE_INITIAL_CAPACITY 16
+#define HASH_TABLE_MAX_LOAD_PERCENT 75
+
+typedef struct HashBucket_t
+{
+	HashElement element;
+	unsigned int hash;
+} HashBucket;
+
+struct HashTable_t
+{
+	HashBucket* buckets;
+	unsigned int capacity;
+	unsigned int size;
+	Arena arena;
+	HashElementFunction hashElement;
+	EqualHashElements equalElements;
+};
+
+static HashBucket* allocateBuckets(Arena arena, unsigned int capacity)
+{
+	HashBucket* buckets = arenaAlloc(arena, capacity * sizeof(*buckets));
+	if (buckets != NULL)
+	{
+		memset(buckets, 0, capacity * sizeof(*buckets));
+	}
+	return buckets;
+}
+
+static unsigned int getBucketIndex(HashBucket* buckets, unsigned int capacity, unsigned int hash,
+	HashElement key, EqualHashElements equal)
+{
+	unsigned int index = hash & (capacity - 1);
+	while (buckets[index].element != NULL && (buckets[index].hash != hash || !equal(buckets[index].element, key)))
+	{
+		index = (index + 1) & (capacity - 1);
+	}
+
+	return index;
+}
+
+static bool hashTableResize(HashTable table, unsigned int capacity)
+{
+	HashBucket* buckets = allocateBuckets(table->arena, capacity);
+	if (buckets == NULL)
+	{
+		return false;
+	}
+
+	for (unsigned int i = 0; i < table->capacity; i++)
+	{
+		if (table->buckets[i].element != NULL)
+		{
+			// Elements of the old table are all distinct, so only an empty bucket is searched for
+			unsigned int index = table->buckets[i].hash & (capacity - 1);
+			while (buckets[index].element != NULL)
+			{
+				index = (index + 1) & (capacity - 1);
+			}
+			buckets[index] = table->buckets[i];
+		}
+	}
+
+	arenaRelease(table->arena, table->buckets, table->capacity * sizeof(*table->buckets));
+	table->buckets = buckets;
+	table->capacity = capacity;
+
+	return true;
+}
+
+HashTable hashTableCreate(HashElementFunction hash_element, EqualHashElements equal_elements)
+{
+	return hashTableCreateInArena(NULL, hash_element, equal_elements);
+}
+
+HashTable hashTableCreateInArena(Arena arena, HashElementFunction hash_element, EqualHashElements equal_elements)
+{
+	if (hash_element == NULL || equal_elements == NULL)
+	{
+		return NULL;
+	}
+
+	HashTable table = arenaAlloc(arena, sizeof(*table));
+	if (table == NULL)
+	{
+		return NULL;
+	}
+
+	table->buckets = NULL;
+	table->capacity = 0;
+	table->size = 0;
+	table->arena = arena;
+	table->hashElement = hash_element;
+	table->equalElements = equal_elements;
+
+	return table;
+}
+
+void hashTableDestroy(HashTable table)
+{
+	if (table == NULL)
+	{
+		return;
+	}
+
+	arenaRelease(table->arena, table->buckets, table->capacity * sizeof(*table->buckets));
+	arenaRelease(table->arena, table, sizeof(*table));
+}
+
+int hashTableGetSize(HashTable table)
+{
+	if (table == NULL)
+	{
+		return -1;
+	}
+
+	return table->size;
+}
+
+HashElement hashTableFind(HashTable table, HashElement key)
+{
+	if (table == NULL || key == NULL)
+	{
+		return NULL;
+	}
+
+	if (table->size == 0)
+	{
+		return NULL;
+	}
+
+	unsigned int hash = table->hashElement(key);
+	return table->buckets[getBucketIndex(table->buckets, table->capacity, hash, key, table->equalElements)].element;
+}
+
+HashTableResult hashTableInsert(HashTable table, HashElement element)
+{
+	if (table == NULL || element == NULL)
+	{
+		return HT_NULL_ARGUMENT;
+	}
+
+	if (table->capacity == 0 && !hashTableResize(table, HASH_TABLE_INITIAL_CAPACITY))
+	{
+		return HT_OUT_OF_MEMORY;
+	}
+
+	unsigned int hash = table->hashElement(element);
+	unsigned int index = getBucketIndex(table->buckets, table->capacity, hash, element, table->equalElements);
+	if (table->buckets[index].element != NULL)
+	{
+		return HT_ELEMENT_ALREADY_EXISTS;
+	}
+
+	if ((table->size + 1) * 100 > table->capacity * HASH_TABLE_MAX_LOAD_PERCENT)
+	{
+		if (!hashTableResize(table, table->capacity * 2))
+		{
+			return HT_OUT_OF_MEMORY;
+		}
+		index = getBucketIndex(table->buckets, table->capacity, hash, element, table->equalElements);
+	}
+
+	table->buckets[index].element = element;
+	table->buckets[index].hash = hash;
+	table->size++;
+
+	return HT_SUCCESS;
+}
+
+HashTableResult hashTableReserve(HashTable table, int count)
+{
+	if (table == NULL)
+	{
+		return HT_NULL_ARGUMENT;
+	}
+
+	unsigned int capacity = table->capacity == 0 ? HASH_TABLE_INITIAL_CAPACITY : table->capacity;
+	while ((unsigned long long)count * 100 > (unsigned long long)capacity * HASH_TABLE_MAX_LOAD_PERCENT)
+	{
+		capacity *= 2;
+	}
+
+	if (capacity != table->capacity && !hashTableResize(table, capacity))
+	{
+		return HT_OUT_OF_MEMORY;
+	}
+
+	return HT_SUCCESS;
+}
+
+HashTableResult hashTableRemove(HashTable table, HashElement key)
+{
+	if (table == NULL || key == NULL)
+	{
+		return HT_NULL_ARGUMENT;
+	}
+
+	if (table->size == 0)
+	{
+		return HT_ELEMENT_DOES_NOT_EXIST;
+	}
+
+	unsigned int hash = table->hashElement(key);
+	unsigned int index = getBucketIndex(table->buckets, table->capacity, hash, key, table->equalElements);
+	if (table->buckets[index].element == NULL)
+	{
+		return HT_ELEMENT_DOES_NOT_EXIST;
+	}
+
+	// Backward shift deletion: move later buckets of the probe sequence into the hole, so no tombstones are needed
+	unsigned int mask = table->capacity - 1;
+	unsigned int hole = index;
+	unsigned int next = (hole + 1) & mask;
+	while (table->buckets[next].element != NULL)
+	{
+		unsigned int home = table->buckets[next].hash & mask;
+		if (((next - home) & mask) >= ((next - hole) & mask))
+		{
+			table->buckets[hole] = table->buckets[next];
+			hole = next;
+		}
+		next = (next + 1) & mask;
+	}
+
+	table->buckets[hole].element = NULL;
+	table->size--;
+
+	return HT_SUCCESS;
+}
@@ -0,0 +1,135 @@
+#ifndef HASH_TABLE_H
+#define HASH_TABLE_H
+
+#include <stdbool.h>
+#include "arena.h"
+
+/**
+* Generic Hash Table
+*
+* Implements a set of elements indexed by a user supplied hash function.
+* The table only stores references to the elements: elements are neither copied nor freed by it,
+* so an element must stay alive while it is inside the table.
+* Lookups are done with a key element, which only needs the fields used by the hash and equal functions.
+* An empty table takes no buckets until its first insert, so many small tables stay cheap.
+*
+* The following functions are available:
+*   hashTableCreate		    - Creates a new empty hash table
+*   hashTableCreateInArena	    - Creates a new empty hash table whose buckets are allocated in an arena
+*   hashTableDestroy		    - Deletes an existing hash table and frees its buckets
+*   hashTableGetSize		    - Returns the number of elements in the hash table
+*   hashTableFind		    - Returns the element equal to a key element
+*   hashTableInsert		    - Inserts an element to the hash table
+*   hashTableRemove		    - Removes the element equal to a key element
+*   hashTableReserve		    - Grows the hash table ahead of a known number of inserts
+*/
+
+/** Type for defining the hash table */
+typedef struct HashTable_t* HashTable;
+
+/** Type used for returning error codes from hash table functions */
+typedef enum HashTableResult_t {
+    HT_SUCCESS,
+    HT_OUT_OF_MEMORY,
+    HT_NULL_ARGUMENT,
+    HT_ELEMENT_ALREADY_EXISTS,
+    HT_ELEMENT_DOES_NOT_EXIST
+} HashTableResult;
+
+/** Data element data type for hash table container */
+typedef void* HashElement;
+
+/** Type of function used by the hash table to hash an element */
+typedef unsigned int(*HashElementFunction)(HashElement);
+
+/**
+* Type of function used by the hash table to identify equal elements.
+* This function should return:
+* 		true if they're equal;
+*		false otherwise;
+*/
+typedef bool(*EqualHashElements)(HashElement, HashElement);
+
+/**
+* hashTableCreate: Allocates a new empty hash table.
+*
+* @param hash_element - Function pointer to be used for hashing elements.
+* @param equal_elements - Function pointer to be used for comparing elements. Elements that are equal
+*		must have the same hash.
+* @return
+* 	NULL - if one of the parameters is NULL or allocations failed.
+* 	A new hash table in case of success.
+*/
+HashTable hashTableCreate(HashElementFunction hash_element, EqualHashElements equal_elements);
+
+/**
+* hashTableCreateInArena: Allocates a new empty hash table, exactly like hashTableCreate, except that
+* the table and its buckets are allocated in the given arena.
+*
+* @param arena - The arena to allocate from. If arena is NULL the heap is used, as in hashTableCreate.
+* @return
+* 	NULL - if one of the function parameters is NULL or allocations failed.
+* 	A new hash table in case of success.
+*/
+HashTable hashTableCreateInArena(Arena arena, HashElementFunction hash_element, EqualHashElements equal_elements);
+
+/**
+* hashTableDestroy: Deallocates an existing hash table. The elements are not freed.
+*
+* @param table - Target hash table to be deallocated. If table is NULL nothing will be done
+*/
+void hashTableDestroy(HashTable table);
+
+/**
+* hashTableGetSize: Returns the number of elements in a hash table
+*
+* @return
+* 	-1 if a NULL pointer was sent.
+* 	Otherwise the number of elements in the hash table.
+*/
+int hashTableGetSize(HashTable table);
+
+/**
+* hashTableFind: Returns the element of the hash table which is equal to the key element.
+*
+* @param table - The hash table to search in
+* @param key - The key element to look for. Will be compared using the equal function.
+* @return
+* 	NULL - if one or more of the inputs is null, or if no equal element was found.
+* 	The element of the hash table otherwise.
+*/
+HashElement hashTableFind(HashTable table, HashElement key);
+
+/**
+* hashTableInsert: Inserts an element to the hash table. The element itself is stored, not a copy.
+*
+* @return
+* 	HT_NULL_ARGUMENT if a NULL was sent as one of the parameters
+* 	HT_ELEMENT_ALREADY_EXISTS if an equal element is already in the hash table
+* 	HT_OUT_OF_MEMORY if the hash table had to grow and an allocation failed
+* 	HT_SUCCESS the element had been inserted successfully
+*/
+HashTableResult hashTableInsert(HashTable table, HashElement element);
+
+/**
+* hashTableRemove: Removes the element which is equal to the key element from the hash table.
+*
+* @return
+* 	HT_NULL_ARGUMENT if a NULL was sent as one of the parameters
+* 	HT_ELEMENT_DOES_NOT_EXIST if no equal element is in the hash table
+* 	HT_SUCCESS the element had been removed successfully
+*/
+HashTableResult hashTableRemove(HashTable table, HashElement key);
+
+/**
+* hashTableReserve: Grows the hash table so it can hold count elements without growing again.
+* Reserving before a large batch of inserts saves the rehashing of every intermediate size.
+*
+* @return
+* 	HT_NULL_ARGUMENT if a NULL was sent
+* 	HT_OUT_OF_MEMORY if an allocation failed, in which case the hash table is not changed
+* 	HT_SUCCESS otherwise
+*/
+HashTableResult hashTableReserve(HashTable table, int count);
+
+#endif /* HASH_TABLE_H */
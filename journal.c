@@ -0,0 +1,293 @@
+#include "journal.h"
+#include "file_map.h"
+#include "stddef.h"
+#include "stdlib.h"
+#include "string.h"
+#include "errno.h"
+
+#ifdef _WIN32
+#include <io.h>
+#define open _open
+#define write _write
+#define close _close
+#define fsync _commit
+#define ftruncate _chsize
+#else
+#include <unistd.h>
+#endif
+#include <fcntl.h>
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+// "EMJL" when read in little endian byte order
+#define JOURNAL_MAGIC 0x4C4A4D45u
+#define JOURNAL_VERSION 1
+#define JOURNAL_BUFFER_SIZE (64 * 1024)
+
+typedef struct JournalHeader_t
+{
+	uint32_t magic;
+	uint32_t version;
+} JournalHeader;
+
+/*
+* Layout of a record in the file, followed by the NUL terminated name when size is larger than the layout.
+* The checksum covers everything after itself. Records are not aligned, so they are copied before use.
+*/
+typedef struct JournalEntry_t
+{
+	uint32_t size;
+	uint32_t checksum;
+	uint64_t sequence;
+	int32_t type;
+	int32_t first;
+	int32_t second;
+} JournalEntry;
+
+#define JOURNAL_CHECKED_OFFSET (2 * sizeof(uint32_t))
+#define JOURNAL_ENTRY_SIZE (JOURNAL_CHECKED_OFFSET + sizeof(uint64_t) + 3 * sizeof(int32_t))
+
+struct Journal_t
+{
+	int fd;
+	char* buffer;
+	int used;
+	bool failed;
+};
+
+static uint32_t journalChecksum(const char* data, size_t length)
+{
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < length; i++)
+	{
+		hash = (hash ^ (unsigned char)data[i]) * 16777619u;
+	}
+
+	return hash;
+}
+
+static bool journalWriteAll(Journal journal, const char* data, int length)
+{
+	while (length > 0 && !journal->failed)
+	{
+		int written = write(journal->fd, data, length);
+		if (written < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			journal->failed = true;
+			break;
+		}
+		data += written;
+		length -= written;
+	}
+
+	return !journal->failed;
+}
+
+static bool journalFlush(Journal journal)
+{
+	bool result = journalWriteAll(journal, journal->buffer, journal->used);
+	journal->used = 0;
+	return result;
+}
+
+// Returns the size of the file up to the end of its last complete record, or 0 if there is no valid header
+static size_t journalReadRecords(const char* data, size_t size, JournalRecordVisitor visitor, void* context)
+{
+	JournalHeader header;
+	if (size < sizeof(header))
+	{
+		return 0;
+	}
+	memcpy(&header, data, sizeof(header));
+	if (header.magic != JOURNAL_MAGIC || header.version != JOURNAL_VERSION)
+	{
+		return 0;
+	}
+
+	size_t offset = sizeof(header);
+	while (size - offset >= JOURNAL_ENTRY_SIZE)
+	{
+		JournalEntry entry;
+		memcpy(&entry, data + offset, JOURNAL_ENTRY_SIZE);
+		const char* name = data + offset + JOURNAL_ENTRY_SIZE;
+		size_t nameSize = entry.size - JOURNAL_ENTRY_SIZE;
+		if (entry.size < JOURNAL_ENTRY_SIZE || entry.size > size - offset
+			|| (nameSize > 0 && name[nameSize - 1] != '\0')
+			|| journalChecksum(data + offset + JOURNAL_CHECKED_OFFSET, entry.size - JOURNAL_CHECKED_OFFSET) != entry.checksum)
+		{
+			break;
+		}
+
+		if (visitor != NULL)
+		{
+			JournalRecord record = { entry.sequence, entry.type, entry.first, entry.second, nameSize > 0 ? name : NULL };
+			if (!visitor(context, &record))
+			{
+				break;
+			}
+		}
+		offset += entry.size;
+	}
+
+	return offset;
+}
+
+Journal journalOpen(const char* path)
+{
+	if (path == NULL)
+	{
+		return NULL;
+	}
+
+	// An existing file is checked first, and anything after its last complete record is cut off
+	size_t validSize = 0;
+	size_t fileSize = 0;
+	FileMap map = fileMapOpen(path);
+	if (map != NULL)
+	{
+		fileSize = fileMapGetSize(map);
+		validSize = journalReadRecords(fileMapGetData(map), fileSize, NULL, NULL);
+		fileMapClose(map);
+		if (fileSize > 0 && validSize == 0)
+		{
+			return NULL;
+		}
+	}
+
+	Journal journal = malloc(sizeof(*journal));
+	char* buffer = malloc(JOURNAL_BUFFER_SIZE);
+	int fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_BINARY, 0644);
+	if (journal == NULL || buffer == NULL || fd < 0 || (validSize < fileSize && ftruncate(fd, validSize) != 0))
+	{
+		if (fd >= 0)
+		{
+			close(fd);
+		}
+		free(buffer);
+		free(journal);
+		return NULL;
+	}
+
+	journal->fd = fd;
+	journal->buffer = buffer;
+	journal->used = 0;
+	journal->failed = false;
+
+	if (validSize == 0)
+	{
+		JournalHeader header = { JOURNAL_MAGIC, JOURNAL_VERSION };
+		if (ftruncate(fd, 0) != 0 || !journalWriteAll(journal, (const char*)&header, sizeof(header)))
+		{
+			journalClose(journal);
+			return NULL;
+		}
+	}
+
+	return journal;
+}
+
+bool journalClose(Journal journal)
+{
+	if (journal == NULL)
+	{
+		return false;
+	}
+
+	bool result = journalSync(journal);
+	close(journal->fd);
+	free(journal->buffer);
+	free(journal);
+
+	return result;
+}
+
+bool journalAppend(Journal journal, const JournalRecord* record)
+{
+	if (journal == NULL || record == NULL)
+	{
+		return false;
+	}
+
+	size_t nameSize = record->name == NULL ? 0 : strlen(record->name) + 1;
+	size_t size = JOURNAL_ENTRY_SIZE + nameSize;
+	if (size > (size_t)(JOURNAL_BUFFER_SIZE - journal->used) && !journalFlush(journal))
+	{
+		return false;
+	}
+	if (size > JOURNAL_BUFFER_SIZE)
+	{
+		// A name longer than the buffer cannot be journaled
+		journal->failed = true;
+		return false;
+	}
+
+	char* out = journal->buffer + journal->used;
+	JournalEntry entry = { (uint32_t)size, 0, record->sequence, record->type, record->first, record->second };
+	memcpy(out, &entry, JOURNAL_ENTRY_SIZE);
+	if (nameSize > 0)
+	{
+		memcpy(out + JOURNAL_ENTRY_SIZE, record->name, nameSize);
+	}
+	entry.checksum = journalChecksum(out + JOURNAL_CHECKED_OFFSET, size - JOURNAL_CHECKED_OFFSET);
+	memcpy(out + offsetof(JournalEntry, checksum), &entry.checksum, sizeof(entry.checksum));
+	journal->used += size;
+
+	return !journal->failed;
+}
+
+bool journalSync(Journal journal)
+{
+	if (journal == NULL)
+	{
+		return false;
+	}
+
+	if (journalFlush(journal) && fsync(journal->fd) != 0)
+	{
+		journal->failed = true;
+	}
+
+	return !journal->failed;
+}
+
+bool journalTruncate(Journal journal)
+{
+	if (journal == NULL)
+	{
+		return false;
+	}
+
+	journal->used = 0;
+	if (!journal->failed && (ftruncate(journal->fd, sizeof(JournalHeader)) != 0 || fsync(journal->fd) != 0))
+	{
+		journal->failed = true;
+	}
+
+	return !journal->failed;
+}
+
+bool journalRead(const char* path, JournalRecordVisitor visitor, void* context)
+{
+	if (path == NULL || visitor == NULL)
+	{
+		return false;
+	}
+
+	FileMap map = fileMapOpen(path);
+	if (map == NULL)
+	{
+		return false;
+	}
+
+	size_t size = fileMapGetSize(map);
+	bool result = size == 0 || journalReadRecords(fileMapGetData(map), size, visitor, context) > 0;
+	fileMapClose(map);
+
+	return result;
+}
@@ -0,0 +1,105 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+* Append-Only Journal
+*
+* Records a sequence of small binary records in a file, to be read back in order after a restart.
+* Every record holds a sequence number, a type, two integers and an optional string, and is protected by
+* its own checksum, so a record torn by a crash is detected and ends the journal.
+*
+* Appends are collected in a memory buffer and written in groups: the buffer is written out when it is full,
+* and journalSync writes it and waits for the data to reach the disk, committing every pending record at once.
+*
+* The following functions are available:
+*   journalOpen		- Opens a journal file for appending, creating it if needed
+*   journalClose	- Commits the pending records and closes a journal
+*   journalAppend	- Adds a record to a journal
+*   journalSync		- Commits every pending record to the disk
+*   journalTruncate	- Drops every record of a journal
+*   journalRead		- Reads the records of a journal file in order
+*/
+
+/** Type for defining the journal */
+typedef struct Journal_t* Journal;
+
+/** A single record of a journal */
+typedef struct JournalRecord_t {
+    uint64_t sequence;
+    int type;
+    int first;
+    int second;
+    // NULL if the record has no string
+    const char* name;
+} JournalRecord;
+
+/**
+* Type of function that receives the records read by journalRead.
+* This function should return:
+* 		true to continue with the next record;
+*		false to stop reading;
+*/
+typedef bool(*JournalRecordVisitor)(void* context, const JournalRecord* record);
+
+/**
+* journalOpen: Opens a journal file for appending. A file that does not exist is created, and a torn
+* record at the end of an existing file is cut off, so new records follow the last complete one.
+*
+* @return
+* 	NULL - if a NULL was sent, the file is not a journal, it could not be opened or an allocation failed.
+* 	A new Journal in case of success.
+*/
+Journal journalOpen(const char* path);
+
+/**
+* journalClose: Commits the pending records and closes the journal.
+*
+* @param journal - Target journal. If journal is NULL nothing will be done
+* @return
+* 	false if a NULL was sent or a write failed since the journal was opened.
+* 	true otherwise.
+*/
+bool journalClose(Journal journal);
+
+/**
+* journalAppend: Adds a record to the journal. The record is buffered and reaches the file
+* when the buffer fills up or on the next journalSync.
+*
+* @return
+* 	false if a NULL was sent or a write failed since the journal was opened.
+* 	true otherwise.
+*/
+bool journalAppend(Journal journal, const JournalRecord* record);
+
+/**
+* journalSync: Writes every pending record to the file and waits for them to reach the disk.
+*
+* @return
+* 	false if a NULL was sent or a write failed since the journal was opened.
+* 	true otherwise.
+*/
+bool journalSync(Journal journal);
+
+/**
+* journalTruncate: Drops every record of the journal, both pending and written ones.
+*
+* @return
+* 	false if a NULL was sent or a write failed since the journal was opened.
+* 	true otherwise.
+*/
+bool journalTruncate(Journal journal);
+
+/**
+* journalRead: Reads the records of a journal file in order, up to the first torn record.
+* The name of a record is only valid during the call to visitor.
+*
+* @return
+* 	false if a NULL was sent, the file could not be read or it is not a journal.
+* 	true otherwise, including when visitor stopped the reading.
+*/
+bool journalRead(const char* path, JournalRecordVisitor visitor, void* context);
+
+#endif /* JOURNAL_H */
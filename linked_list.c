@@ -12,11 +12,17 @@ struct LinkedList_t
 {
 	Node head;
 	int size;
+	Arena arena;
 };
 
 LinkedList listCreate()
 {
-	LinkedList linkedList = malloc(sizeof(*linkedList));
+	return listCreateInArena(NULL);
+}
+
+LinkedList listCreateInArena(Arena arena)
+{
+	LinkedList linkedList = arenaAlloc(arena, sizeof(*linkedList));
 	if (linkedList == NULL)
 	{
 		return NULL;
@@ -24,10 +30,31 @@ LinkedList listCreate()
 
 	linkedList->head = NULL;
 	linkedList->size = 0;
+	linkedList->arena = arena;
 
 	return linkedList;
 }
 
+bool listReserveInArena(Arena arena, int lists, int nodes)
+{
+	return arenaReserve(arena, sizeof(struct LinkedList_t), lists) && arenaReserve(arena, sizeof(struct Node_t), nodes);
+}
+
+void listDestroy(LinkedList list)
+{
+	if (list == NULL)
+	{
+		return;
+	}
+
+	while (list->head != NULL)
+	{
+		listRemoveNode(list, list->head);
+	}
+
+	arenaRelease(list->arena, list, sizeof(*list));
+}
+
 int listGetSize(LinkedList list)
 {
 	if (list == NULL)
@@ -65,7 +92,17 @@ void listRemoveNode(LinkedList list, Node node)
 		return;
 	}
 
-	Node current = node;
+	listUnlinkNode(list, node);
+	arenaRelease(list->arena, node, sizeof(*node));
+}
+
+void listUnlinkNode(LinkedList list, Node node)
+{
+	if (list == NULL || node == NULL)
+	{
+		return;
+	}
+
 	if (list->head == node)
 	{
 		list->head = node->next;
@@ -80,14 +117,20 @@ void listRemoveNode(LinkedList list, Node node)
 	{
 		node->next->prev = node->prev;
 	}
-	
-	free(current);
+
+	node->prev = NULL;
+	node->next = NULL;
 	list->size--;
 }
 
-Node listCreateNewNode(NodeData data)
+Node listCreateNewNode(LinkedList list, NodeData data)
 {
-	Node node = malloc(sizeof(*node));
+	if (list == NULL)
+	{
+		return NULL;
+	}
+
+	Node node = arenaAlloc(list->arena, sizeof(*node));
 	if (node == NULL)
 	{
 		return NULL;
@@ -99,6 +142,16 @@ Node listCreateNewNode(NodeData data)
 	return node;
 }
 
+void listDestroyNode(LinkedList list, Node node)
+{
+	if (list == NULL || node == NULL)
+	{
+		return;
+	}
+
+	arenaRelease(list->arena, node, sizeof(*node));
+}
+
 Node listGetNextNode(Node node)
 {
 	if (node == NULL)
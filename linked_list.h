@@ -1,6 +1,8 @@
 #ifndef LINKED_LIST_H
 #define LINKED_LIST_H
 
+#include "arena.h"
+
 /** Type for defining the linked list */
 typedef struct LinkedList_t* LinkedList;
 
@@ -28,6 +30,32 @@ typedef int(*CompareNodes)(Node, Node);
 */
 LinkedList listCreate();
 
+/**
+* listCreateInArena: Allocates a new empty linked list whose list and node
+* memory is taken from the given arena.
+*
+* @param arena - The arena to allocate from. If arena is NULL the heap is used, as in listCreate.
+* @return
+*	NULL - if allocations failed.
+*	A new linked list in case of success.
+*/
+LinkedList listCreateInArena(Arena arena);
+
+/**
+* listReserveInArena: Makes sure lists more lists and nodes more nodes can be created in the arena without taking
+* memory from the heap.
+*
+* @return
+*	false - if allocations failed. If arena is NULL nothing is reserved and true is returned.
+*	true in case of success.
+*/
+bool listReserveInArena(Arena arena, int lists, int nodes);
+
+/**
+* listDestroy: Frees the list and all of its nodes. The data of the nodes is not freed.
+*/
+void listDestroy(LinkedList list);
+
 /**
 * listGetSize: Gets the size of the list.
 *
@@ -61,13 +89,23 @@ NodeData listNodeGetData(Node node);
 void listRemoveNode(LinkedList list, Node node);
 
 /**
-* listCreateNewNode: Instantiates a new node.
+* listUnlinkNode: Takes the node out of the list without freeing it, so it can be inserted again.
+*/
+void listUnlinkNode(LinkedList list, Node node);
+
+/**
+* listCreateNewNode: Instantiates a new node for the list. The node is not inserted.
 *
 * @return
-*	NULL - if memory allocation failed.
+*	NULL - if a parameter is NULL or memory allocation failed.
 *	The new node in case of success.
 */
-Node listCreateNewNode(NodeData data);
+Node listCreateNewNode(LinkedList list, NodeData data);
+
+/**
+* listDestroyNode: Frees a node that was created for the list but never inserted to it.
+*/
+void listDestroyNode(LinkedList list, Node node);
 
 /**
 * listGetNextNode: Gets the next node in the list.
@@ -0,0 +1,366 @@
+#include "../priority_queue.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+* Priority queue microbenchmarks. Prints one JSON document with a result for every operation, priority distribution
+* and queue size, so that runs of different commits or backends can be compared by a script.
+* Run with no arguments for sizes from 10^3 to 10^7, or with the largest size to measure.
+*
+* Every queue is filled with pqInsertAll, then these are measured in turn on it:
+*   pqGetFirst       - The first element, again and again
+*   pqContains       - Elements picked at random among those in the queue
+*   pqInsert         - New elements with priorities from the same distribution, which are taken out again untimed
+*   pqChangePriority - Elements picked at random, given a new priority from the same distribution
+*   pqCopy           - Copies of the whole queue, which are destroyed untimed
+*   pqRemoveElement  - Elements picked at random, up to half of the queue
+*   pqRemove         - The first element, up to half of the queue
+*
+* Every operation is repeated in doubling batches until PQ_BENCHMARK_BUDGET seconds were spent on it, so the O(n)
+* operations run only a few times on the largest queues.
+* Elements and priorities are ints, copied by reference, so the allocations counted are the queue's own. They are
+* counted only where glibc lets malloc be replaced, and reported as null elsewhere.
+*/
+
+#define PQ_BENCHMARK_MAX_SIZE 10000000
+#define PQ_BENCHMARK_MIN_SIZE 1000
+#define PQ_BENCHMARK_BUDGET 0.02
+#define PQ_BENCHMARK_MAX_OPS (1 << 20)
+// The number of different priorities in the many-ties distribution
+#define PQ_BENCHMARK_TIES 16
+
+typedef enum {
+    DISTRIBUTION_RANDOM,
+    DISTRIBUTION_ASCENDING,
+    DISTRIBUTION_DESCENDING,
+    DISTRIBUTION_TIES,
+    NUMBER_DISTRIBUTIONS
+} BenchmarkDistribution;
+
+static const char* distributionNames[NUMBER_DISTRIBUTIONS] = {
+        "random",
+        "ascending",
+        "descending",
+        "ties"
+};
+
+#ifdef __GLIBC__
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* pointer, size_t size);
+
+static long benchmarkAllocations;
+
+void* malloc(size_t size) {
+    benchmarkAllocations++;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    benchmarkAllocations++;
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) {
+    benchmarkAllocations++;
+    return __libc_realloc(pointer, size);
+}
+
+#define BENCHMARK_COUNTS_ALLOCATIONS true
+#else
+static long benchmarkAllocations;
+#define BENCHMARK_COUNTS_ALLOCATIONS false
+#endif
+
+/** A queue of size ints, with room for the elements and priorities the measurements add */
+typedef struct {
+    PriorityQueue queue;
+    BenchmarkDistribution distribution;
+    int size;
+    // ids[i] is element i, which is in the queue with the priority current[i] points to
+    int* ids;
+    int** current;
+    // Priorities of the elements, followed by the priorities given by inserts and changes
+    int* priorities;
+    int used_priorities;
+    // The elements in random order, for picking existing elements without repeating one
+    int* order;
+    int next_id;
+    PriorityQueue* copies;
+    unsigned int seed;
+} BenchmarkQueue;
+
+typedef void (*BenchmarkOperation)(BenchmarkQueue* bench, int first, int count);
+
+static double benchmarkNow() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static unsigned int benchmarkRandom(BenchmarkQueue* bench) {
+    // xorshift, so the priorities do not depend on the quality of rand()
+    bench->seed ^= bench->seed << 13;
+    bench->seed ^= bench->seed >> 17;
+    bench->seed ^= bench->seed << 5;
+    return bench->seed;
+}
+
+static PQElement benchmarkCopyInt(PQElement value) {
+    return value;
+}
+
+static void benchmarkFreeInt(PQElement value) {
+    (void)value;
+}
+
+static bool benchmarkEqualInts(PQElement first, PQElement second) {
+    return *(int*)first == *(int*)second;
+}
+
+// Larger ints come first
+static int benchmarkCompareInts(PQElementPriority first, PQElementPriority second) {
+    int left = *(int*)first;
+    int right = *(int*)second;
+    return (left > right) - (left < right);
+}
+
+// The priority of the index-th element added to a queue of the distribution
+static int benchmarkNextPriority(BenchmarkQueue* bench, int index) {
+    switch (bench->distribution) {
+        case DISTRIBUTION_RANDOM:
+            return (int)(benchmarkRandom(bench) >> 1);
+        case DISTRIBUTION_ASCENDING:
+            return index;
+        case DISTRIBUTION_DESCENDING:
+            return -index;
+        default:
+            return (int)(benchmarkRandom(bench) % PQ_BENCHMARK_TIES);
+    }
+}
+
+static int* benchmarkNewPriority(BenchmarkQueue* bench) {
+    int index = bench->used_priorities++;
+    bench->priorities[index] = benchmarkNextPriority(bench, index);
+    return &bench->priorities[index];
+}
+
+static void benchmarkDestroyQueue(BenchmarkQueue* bench) {
+    pqDestroy(bench->queue);
+    free(bench->ids);
+    free(bench->current);
+    free(bench->priorities);
+    free(bench->order);
+    free(bench->copies);
+}
+
+static bool benchmarkCreateQueue(BenchmarkQueue* bench, BenchmarkDistribution distribution, int size) {
+    memset(bench, 0, sizeof(*bench));
+    bench->distribution = distribution;
+    bench->size = size;
+    bench->seed = 2463534242u;
+    int capacity = size + PQ_BENCHMARK_MAX_OPS;
+    bench->ids = malloc(capacity * sizeof(*bench->ids));
+    bench->current = malloc(size * sizeof(*bench->current));
+    // Inserts give their priorities back when they are undone, so only the changes keep theirs
+    bench->priorities = malloc(capacity * sizeof(*bench->priorities));
+    bench->order = malloc(size * sizeof(*bench->order));
+    bench->copies = malloc(PQ_BENCHMARK_MAX_OPS * sizeof(*bench->copies));
+    bench->queue = pqCreate(benchmarkCopyInt, benchmarkFreeInt, benchmarkEqualInts,
+                            benchmarkCopyInt, benchmarkFreeInt, benchmarkCompareInts);
+    PQElement* elements = malloc(size * sizeof(*elements));
+    if (bench->ids == NULL || bench->current == NULL || bench->priorities == NULL || bench->order == NULL
+        || bench->copies == NULL || bench->queue == NULL || elements == NULL) {
+        free(elements);
+        benchmarkDestroyQueue(bench);
+        return false;
+    }
+
+    for (int i = 0; i < capacity; i++) {
+        bench->ids[i] = i;
+    }
+    for (int i = 0; i < size; i++) {
+        elements[i] = &bench->ids[i];
+        bench->current[i] = benchmarkNewPriority(bench);
+        bench->order[i] = i;
+    }
+    for (int i = size - 1; i > 0; i--) {
+        int other = benchmarkRandom(bench) % (i + 1);
+        int swapped = bench->order[i];
+        bench->order[i] = bench->order[other];
+        bench->order[other] = swapped;
+    }
+    bench->next_id = size;
+
+    PriorityQueueResult result = pqInsertAll(bench->queue, elements, (PQElementPriority*)bench->current, size);
+    free(elements);
+    if (result != PQ_SUCCESS) {
+        benchmarkDestroyQueue(bench);
+        return false;
+    }
+
+    return true;
+}
+
+static void benchmarkGetFirst(BenchmarkQueue* bench, int first, int count) {
+    (void)first;
+    for (int i = 0; i < count; i++) {
+        if (pqGetFirst(bench->queue) == NULL) {
+            fprintf(stderr, "pqGetFirst failed\n");
+        }
+    }
+}
+
+static void benchmarkContains(BenchmarkQueue* bench, int first, int count) {
+    for (int i = first; i < first + count; i++) {
+        if (!pqContains(bench->queue, &bench->ids[bench->order[i % bench->size]])) {
+            fprintf(stderr, "pqContains failed\n");
+        }
+    }
+}
+
+static void benchmarkInsert(BenchmarkQueue* bench, int first, int count) {
+    (void)first;
+    for (int i = 0; i < count; i++) {
+        if (pqInsert(bench->queue, &bench->ids[bench->next_id++], benchmarkNewPriority(bench)) != PQ_SUCCESS) {
+            fprintf(stderr, "pqInsert failed\n");
+        }
+    }
+}
+
+static void benchmarkUndoInsert(BenchmarkQueue* bench, int first, int count) {
+    (void)first;
+    for (int i = 0; i < count; i++) {
+        pqRemoveElement(bench->queue, &bench->ids[--bench->next_id]);
+    }
+    bench->used_priorities -= count;
+}
+
+static void benchmarkChangePriority(BenchmarkQueue* bench, int first, int count) {
+    for (int i = first; i < first + count; i++) {
+        int element = bench->order[i % bench->size];
+        int* priority = benchmarkNewPriority(bench);
+        if (pqChangePriority(bench->queue, &bench->ids[element], bench->current[element], priority) != PQ_SUCCESS) {
+            fprintf(stderr, "pqChangePriority failed\n");
+        }
+        bench->current[element] = priority;
+    }
+}
+
+static void benchmarkCopy(BenchmarkQueue* bench, int first, int count) {
+    (void)first;
+    for (int i = 0; i < count; i++) {
+        bench->copies[i] = pqCopy(bench->queue);
+        if (bench->copies[i] == NULL) {
+            fprintf(stderr, "pqCopy failed\n");
+        }
+    }
+}
+
+static void benchmarkUndoCopy(BenchmarkQueue* bench, int first, int count) {
+    (void)first;
+    for (int i = 0; i < count; i++) {
+        pqDestroy(bench->copies[i]);
+    }
+}
+
+static void benchmarkRemoveElement(BenchmarkQueue* bench, int first, int count) {
+    for (int i = first; i < first + count; i++) {
+        if (pqRemoveElement(bench->queue, &bench->ids[bench->order[i]]) != PQ_SUCCESS) {
+            fprintf(stderr, "pqRemoveElement failed\n");
+        }
+    }
+}
+
+static void benchmarkRemove(BenchmarkQueue* bench, int first, int count) {
+    (void)first;
+    for (int i = 0; i < count; i++) {
+        if (pqRemove(bench->queue) != PQ_SUCCESS) {
+            fprintf(stderr, "pqRemove failed\n");
+        }
+    }
+}
+
+static bool benchmarkFirstResult = true;
+
+/*
+* Runs operation in batches of 1, 2, 4 and so on, each followed by undo if it is not NULL, until the budget was
+* spent or max_ops operations ran. Only the batches themselves are timed and counted
+*/
+static void benchmarkMeasure(BenchmarkQueue* bench, const char* name, BenchmarkOperation operation,
+                             BenchmarkOperation undo, int max_ops) {
+    double elapsed = 0;
+    long allocations = 0;
+    int ops = 0;
+    for (int batch = 1; ops < max_ops && elapsed < PQ_BENCHMARK_BUDGET; batch *= 2) {
+        if (batch > max_ops - ops) {
+            batch = max_ops - ops;
+        }
+        long allocations_before = benchmarkAllocations;
+        double start = benchmarkNow();
+        operation(bench, ops, batch);
+        elapsed += benchmarkNow() - start;
+        allocations += benchmarkAllocations - allocations_before;
+        if (undo != NULL) {
+            undo(bench, ops, batch);
+        }
+        ops += batch;
+    }
+
+    printf("%s\n    {\"operation\": \"%s\", \"distribution\": \"%s\", \"size\": %d, \"ops\": %d, \"ns_per_op\": %.1f, ",
+           benchmarkFirstResult ? "" : ",", name, distributionNames[bench->distribution], bench->size, ops,
+           elapsed * 1e9 / ops);
+    if (BENCHMARK_COUNTS_ALLOCATIONS) {
+        printf("\"allocs_per_op\": %.2f}", (double)allocations / ops);
+    } else {
+        printf("\"allocs_per_op\": null}");
+    }
+    fflush(stdout);
+    benchmarkFirstResult = false;
+}
+
+static void benchmarkQueue(BenchmarkDistribution distribution, int size) {
+    BenchmarkQueue bench;
+    if (!benchmarkCreateQueue(&bench, distribution, size)) {
+        fprintf(stderr, "Could not create a queue of %d elements\n", size);
+        return;
+    }
+
+    int all_ops = PQ_BENCHMARK_MAX_OPS;
+    int half_ops = size / 2 < all_ops ? size / 2 : all_ops;
+    benchmarkMeasure(&bench, "pqGetFirst", benchmarkGetFirst, NULL, all_ops);
+    benchmarkMeasure(&bench, "pqContains", benchmarkContains, NULL, all_ops);
+    benchmarkMeasure(&bench, "pqInsert", benchmarkInsert, benchmarkUndoInsert, all_ops);
+    benchmarkMeasure(&bench, "pqChangePriority", benchmarkChangePriority, NULL, all_ops);
+    benchmarkMeasure(&bench, "pqCopy", benchmarkCopy, benchmarkUndoCopy, all_ops);
+    benchmarkMeasure(&bench, "pqRemoveElement", benchmarkRemoveElement, NULL, half_ops);
+    benchmarkMeasure(&bench, "pqRemove", benchmarkRemove, NULL, half_ops);
+    benchmarkDestroyQueue(&bench);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 2) {
+        fprintf(stdout, "Usage: pq_benchmark <largest queue size>\n");
+        return 0;
+    }
+
+    int max_size = PQ_BENCHMARK_MAX_SIZE;
+    if (argc == 2) {
+        max_size = strtol(argv[1], NULL, 10);
+        if (max_size < PQ_BENCHMARK_MIN_SIZE) {
+            fprintf(stderr, "Invalid queue size %d\n", max_size);
+            return 0;
+        }
+    }
+
+    printf("{\"benchmark\": \"priority_queue\", \"results\": [");
+    for (long size = PQ_BENCHMARK_MIN_SIZE; size <= max_size; size *= 10) {
+        for (int distribution = 0; distribution < NUMBER_DISTRIBUTIONS; distribution++) {
+            benchmarkQueue(distribution, size);
+        }
+    }
+    printf("\n]}\n");
+    return 0;
+}
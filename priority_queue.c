@@ -3,10 +3,14 @@
 #include "stdlib.h"
 #include "linked_list.h"
 
+// Batches of pqInsertAll up to this size are sorted in a buffer on the stack
+#define PQ_SMALL_BATCH 16
+
 struct PriorityQueue_t
 {
 	LinkedList combinedElementList;
 	Node iterator;
+	Arena arena;
 	CopyPQElement copyElement;
 	CopyPQElementPriority copyElementPriority;
 	FreePQElement freeElement;
@@ -31,12 +35,12 @@ static void destroyCombinedElement(PriorityQueue queue, CombinedElement combined
 {
 	queue->freeElement(combinedElement->element);
 	queue->freeElementPriority(combinedElement->priority);
-	free(combinedElement);
+	arenaRelease(queue->arena, combinedElement, sizeof(*combinedElement));
 }
 
 static CombinedElement createCombinedElement(PriorityQueue queue, PQElement element, PQElementPriority priority)
 {
-	CombinedElement combinedElement = malloc(sizeof(*combinedElement));
+	CombinedElement combinedElement = arenaAlloc(queue->arena, sizeof(*combinedElement));
 	if (combinedElement == NULL)
 	{
 		return NULL;
@@ -122,23 +126,35 @@ PriorityQueue pqCreate(CopyPQElement copy_element,
 	CopyPQElementPriority copy_priority,
 	FreePQElementPriority free_priority,
 	ComparePQElementPriorities compare_priorities)
+{
+	return pqCreateInArena(NULL, copy_element, free_element, equal_elements, copy_priority, free_priority, compare_priorities);
+}
+
+PriorityQueue pqCreateInArena(Arena arena,
+	CopyPQElement copy_element,
+	FreePQElement free_element,
+	EqualPQElements equal_elements,
+	CopyPQElementPriority copy_priority,
+	FreePQElementPriority free_priority,
+	ComparePQElementPriorities compare_priorities)
 {
 	if (!copy_element || !free_element || !equal_elements || !copy_priority || !free_priority || !compare_priorities)
 	{
 		return NULL;
 	}
 
-	PriorityQueue queue = malloc(sizeof(*queue));
-	LinkedList linkedList = listCreate();
+	PriorityQueue queue = arenaAlloc(arena, sizeof(*queue));
+	LinkedList linkedList = listCreateInArena(arena);
 	if (queue == NULL || linkedList == NULL)
 	{
-		free(queue);
-		free(linkedList);
+		arenaRelease(arena, queue, sizeof(*queue));
+		listDestroy(linkedList);
 		return NULL;
 	}
 
 	queue->combinedElementList = linkedList;
 	queue->iterator = NULL;
+	queue->arena = arena;
 	queue->copyElement = copy_element;
 	queue->copyElementPriority = copy_priority;
 	queue->freeElement = free_element;
@@ -149,6 +165,18 @@ PriorityQueue pqCreate(CopyPQElement copy_element,
 	return queue;
 }
 
+PriorityQueueResult pqReserveInArena(Arena arena, int queues, int elements)
+{
+	if (!arenaReserve(arena, sizeof(struct PriorityQueue_t), queues)
+		|| !arenaReserve(arena, sizeof(struct CombinedElement_t), elements)
+		|| !listReserveInArena(arena, queues, elements))
+	{
+		return PQ_OUT_OF_MEMORY;
+	}
+
+	return PQ_SUCCESS;
+}
+
 void pqDestroy(PriorityQueue queue)
 {
 	if (queue == NULL)
@@ -157,8 +185,8 @@ void pqDestroy(PriorityQueue queue)
 	}
 
 	pqClear(queue);
-	free(queue->combinedElementList);
-	free(queue);
+	listDestroy(queue->combinedElementList);
+	arenaRelease(queue->arena, queue, sizeof(*queue));
 }
 
 PriorityQueueResult pqClear(PriorityQueue queue)
@@ -222,7 +250,7 @@ PriorityQueueResult pqInsert(PriorityQueue queue, PQElement element, PQElementPr
 		return PQ_OUT_OF_MEMORY;
 	}
 	
-	Node newNode = listCreateNewNode(combinedElement);
+	Node newNode = listCreateNewNode(queue->combinedElementList, combinedElement);
 	if (newNode == NULL)
 	{
 		destroyCombinedElement(queue, combinedElement);
@@ -243,6 +271,172 @@ PriorityQueueResult pqInsert(PriorityQueue queue, PQElement element, PQElementPr
 	return PQ_SUCCESS;
 }
 
+static void sortByPriority(PriorityQueue queue, CombinedElement* elements, CombinedElement* buffer, int count)
+{
+	if (count < 2)
+	{
+		return;
+	}
+
+	// Stable merge sort, so elements with equal priorities keep their insertion order
+	int middle = count / 2;
+	sortByPriority(queue, elements, buffer, middle);
+	sortByPriority(queue, elements + middle, buffer, count - middle);
+
+	// Halves that are already in order need no merge, so input that is already sorted takes linear time
+	if (queue->comparePriorities(elements[middle - 1]->priority, elements[middle]->priority) >= 0)
+	{
+		return;
+	}
+
+	int left = 0, right = middle, merged = 0;
+	while (left < middle && right < count)
+	{
+		if (queue->comparePriorities(elements[left]->priority, elements[right]->priority) >= 0)
+		{
+			buffer[merged++] = elements[left++];
+		}
+		else
+		{
+			buffer[merged++] = elements[right++];
+		}
+	}
+	while (left < middle)
+	{
+		buffer[merged++] = elements[left++];
+	}
+	while (right < count)
+	{
+		buffer[merged++] = elements[right++];
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		elements[i] = buffer[i];
+	}
+}
+
+PriorityQueueResult pqInsertAll(PriorityQueue queue, PQElement* elements, PQElementPriority* priorities, int count)
+{
+	if (queue == NULL || elements == NULL || priorities == NULL || count < 0)
+	{
+		return PQ_NULL_ARGUMENT;
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		if (elements[i] == NULL || priorities[i] == NULL)
+		{
+			return PQ_NULL_ARGUMENT;
+		}
+	}
+
+	if (count == 0)
+	{
+		return PQ_SUCCESS;
+	}
+
+	// The first half holds the new elements and the second half is the merge sort buffer, later reused for the nodes
+	CombinedElement smallBuffer[2 * PQ_SMALL_BATCH];
+	CombinedElement* combinedElements = count <= PQ_SMALL_BATCH ? smallBuffer : malloc(2 * count * sizeof(*combinedElements));
+	if (combinedElements == NULL)
+	{
+		return PQ_OUT_OF_MEMORY;
+	}
+	Node* nodes = (Node*)(combinedElements + count);
+
+	int createdElements = 0;
+	while (createdElements < count
+		&& (combinedElements[createdElements] = createCombinedElement(queue, elements[createdElements], priorities[createdElements])) != NULL)
+	{
+		createdElements++;
+	}
+
+	int createdNodes = 0;
+	if (createdElements == count)
+	{
+		sortByPriority(queue, combinedElements, combinedElements + count, count);
+		while (createdNodes < count
+			&& (nodes[createdNodes] = listCreateNewNode(queue->combinedElementList, combinedElements[createdNodes])) != NULL)
+		{
+			createdNodes++;
+		}
+	}
+
+	if (createdNodes < count)
+	{
+		// An allocation failed: release everything that was created and leave the queue untouched
+		for (int i = 0; i < createdNodes; i++)
+		{
+			listDestroyNode(queue->combinedElementList, nodes[i]);
+		}
+		for (int i = 0; i < createdElements; i++)
+		{
+			destroyCombinedElement(queue, combinedElements[i]);
+		}
+		if (combinedElements != smallBuffer)
+		{
+			free(combinedElements);
+		}
+		return PQ_OUT_OF_MEMORY;
+	}
+
+	// Merge the sorted nodes into the list: every new node goes after all nodes with a higher or equal priority
+	Node previousNode = NULL;
+	Node currentNode = listGetFirstNode(queue->combinedElementList);
+	for (int i = 0; i < count; i++)
+	{
+		while (currentNode != NULL && compareNodesByPriority(queue, currentNode, nodes[i]) >= 0)
+		{
+			previousNode = currentNode;
+			currentNode = listGetNextNode(currentNode);
+		}
+
+		if (previousNode == NULL)
+		{
+			listInsertStart(queue->combinedElementList, nodes[i]);
+		}
+		else
+		{
+			listInsertAfter(queue->combinedElementList, previousNode, nodes[i]);
+		}
+		previousNode = nodes[i];
+	}
+
+	if (combinedElements != smallBuffer)
+	{
+		free(combinedElements);
+	}
+	queue->iterator = NULL;
+	return PQ_SUCCESS;
+}
+
+PQPosition pqGetFirstPosition(PriorityQueue queue)
+{
+	if (queue == NULL)
+	{
+		return NULL;
+	}
+
+	// A position is the list node itself, which the queue never exposes otherwise
+	return (PQPosition)listGetFirstNode(queue->combinedElementList);
+}
+
+PQPosition pqGetNextPosition(PQPosition position)
+{
+	return (PQPosition)listGetNextNode((Node)position);
+}
+
+PQElement pqPositionGetElement(PQPosition position)
+{
+	if (position == NULL)
+	{
+		return NULL;
+	}
+
+	return ((CombinedElement)listNodeGetData((Node)position))->element;
+}
+
 PQElement pqGetNext(PriorityQueue queue)
 {
 	if (queue == NULL || queue->iterator == NULL)
@@ -303,21 +497,38 @@ PriorityQueue pqCopy(PriorityQueue queue)
 		return NULL;
 	}
 
-	PriorityQueue copy = pqCreate(queue->copyElement, queue->freeElement, queue->equalElements, 
+	PriorityQueue copy = pqCreateInArena(queue->arena, queue->copyElement, queue->freeElement, queue->equalElements, 
 		queue->copyElementPriority, queue->freeElementPriority, queue->comparePriorities);
 	if (copy == NULL)
 	{
 		return NULL;
 	}
 
-	CombinedElement combinedElement = NULL;
+	// The queue is already in order, so every copied node goes right after the previous one
+	Node lastNode = NULL;
 	LIST_FOREACH(Node, node, queue->combinedElementList) {
-		combinedElement = listNodeGetData(node);
-		if (pqInsert(copy, combinedElement->element, combinedElement->priority) != PQ_SUCCESS)
+		CombinedElement original = listNodeGetData(node);
+		CombinedElement combinedElement = createCombinedElement(copy, original->element, original->priority);
+		Node newNode = combinedElement == NULL ? NULL : listCreateNewNode(copy->combinedElementList, combinedElement);
+		if (newNode == NULL)
 		{
+			if (combinedElement != NULL)
+			{
+				destroyCombinedElement(copy, combinedElement);
+			}
 			pqDestroy(copy);
 			return NULL;
 		}
+
+		if (lastNode == NULL)
+		{
+			listInsertStart(copy->combinedElementList, newNode);
+		}
+		else
+		{
+			listInsertAfter(copy->combinedElementList, lastNode, newNode);
+		}
+		lastNode = newNode;
 	}
 
 	queue->iterator = NULL;
@@ -326,6 +537,37 @@ PriorityQueue pqCopy(PriorityQueue queue)
 	return copy;
 }
 
+PriorityQueueResult pqMoveAfter(PriorityQueue queue, PQElement element, PQElement previous)
+{
+	if (queue == NULL || element == NULL)
+	{
+		return PQ_NULL_ARGUMENT;
+	}
+
+	Node node = getFirstEqualNodeByElement(queue, element);
+	Node previousNode = previous == NULL ? NULL : getFirstEqualNodeByElement(queue, previous);
+	if (node == NULL || (previous != NULL && previousNode == NULL))
+	{
+		return PQ_ELEMENT_DOES_NOT_EXISTS;
+	}
+
+	if (node != previousNode)
+	{
+		listUnlinkNode(queue->combinedElementList, node);
+		if (previousNode == NULL)
+		{
+			listInsertStart(queue->combinedElementList, node);
+		}
+		else
+		{
+			listInsertAfter(queue->combinedElementList, previousNode, node);
+		}
+	}
+
+	queue->iterator = NULL;
+	return PQ_SUCCESS;
+}
+
 PriorityQueueResult pqChangePriority(PriorityQueue queue, PQElement element,
 	PQElementPriority old_priority, PQElementPriority new_priority)
 {
@@ -2,6 +2,7 @@
 #define PRIORITY_QUEUE_H
 
 #include <stdbool.h>
+#include "arena.h"
 
 /**
 * Generic Priority Queue Container
@@ -13,6 +14,8 @@
 *
 * The following functions are available:
 *   pqCreate		    - Creates a new empty priority queue
+*   pqCreateInArena	    - Creates a new empty priority queue whose nodes are allocated in an arena
+*   pqReserveInArena	    - Sets memory of an arena aside for later queues and inserts
 *   pqDestroy		    - Deletes an existing priority queue and frees all resources
 *   pqCopy		        - Copies an existing priority queue
 *   pqGetSize		    - Returns the size of a given priority queue
@@ -20,20 +23,32 @@
 *   pqInsert	        - Insert an element with a given priority to the queue.
 *   				        Duplication in the priority queue is allowed.
 *   				        Iterator value is undefined after this operation.
+*   pqInsertAll	        - Inserts an array of elements with their priorities to the queue in one pass.
+*   				        Iterator value is undefined after this operation.
 *   pqChangePriority  	- Changes priority of an element with specific priority
 *					        Iterator value is undefined after this operation.
+*   pqMoveAfter	        - Moves an element right behind another one without allocating.
+*					        Iterator value is undefined after this operation.
 *   pqRemove		    - Removes the highest priority element in the queue
 *                           Iterator value is undefined after this operation.
 *   pqGetFirst	        - Sets the internal iterator to the first element in the priority queue and returns it
 *   pqGetNext		    - Advances the internal iterator to the next key and returns it.
+*   pqGetFirstPosition   - Returns the position of the first element, without using the internal iterator
+*   pqGetNextPosition    - Returns the position that comes after a given position
+*   pqPositionGetElement - Returns the element at a position
 *	pqClear		        - Clears the contents of the priority queue. Frees all the elements of
 *	 				        the queue using the free function.
 * 	PQ_FOREACH	        - A macro for iterating over the priority queue's elements.
+* 	PQ_FOREACH_POSITION  - A macro for iterating over the priority queue's positions, which leaves
+* 					        the internal iterator alone, so any number of traversals can run at once.
 */
 
 /** Type for defining the priority queue */
 typedef struct PriorityQueue_t* PriorityQueue;
 
+/** Type for defining a position in the priority queue. Positions are invalidated by any change of the queue */
+typedef struct PQPosition_t* PQPosition;
+
 /** Type used for returning error codes from priority queue functions */
 typedef enum PriorityQueueResult_t {
     PQ_SUCCESS,
@@ -108,6 +123,37 @@ PriorityQueue pqCreate(CopyPQElement copy_element,
     FreePQElementPriority free_priority,
     ComparePQElementPriorities compare_priorities);
 
+/**
+* pqCreateInArena: Allocates a new empty priority queue, exactly like pqCreate, except that
+* the queue itself and its internal nodes are allocated in the given arena.
+* Elements and priorities are still created by the copy functions.
+* Copies of the queue made by pqCopy use the same arena.
+*
+* @param arena - The arena to allocate from. If arena is NULL the heap is used, as in pqCreate.
+* @return
+* 	NULL - if one of the function parameters is NULL or allocations failed.
+* 	A new priority queue in case of success.
+*/
+PriorityQueue pqCreateInArena(Arena arena,
+    CopyPQElement copy_element,
+    FreePQElement free_element,
+    EqualPQElements equal_elements,
+    CopyPQElementPriority copy_priority,
+    FreePQElementPriority free_priority,
+    ComparePQElementPriorities compare_priorities);
+
+/**
+* pqReserveInArena: Makes sure queues more priority queues can be created in the arena, and elements more elements
+* inserted into queues of the arena, without taking memory from the heap. The copy functions are not covered.
+* The reservation is shared by every queue of the arena.
+*
+* @param arena - The arena to reserve in. If arena is NULL nothing will be done.
+* @return
+* 	PQ_OUT_OF_MEMORY if an allocation failed.
+* 	PQ_SUCCESS otherwise.
+*/
+PriorityQueueResult pqReserveInArena(Arena arena, int queues, int elements);
+
 /**
 * pqDestroy: Deallocates an existing priority queue. Clears all elements by using the
 * free functions.
@@ -168,6 +214,24 @@ bool pqContains(PriorityQueue queue, PQElement element);
 */
 PriorityQueueResult pqInsert(PriorityQueue queue, PQElement element, PQElementPriority priority);
 
+/**
+*   pqInsertAll: adds an array of elements with their priorities to the queue.
+*   The result is the same as calling pqInsert for every element in array order, but the new
+*   elements are sorted first and merged into the queue in a single pass.
+*   If an allocation fails, none of the elements is inserted.
+*   Iterator's value is undefined after this operation.
+*
+* @param queue - The priority queue for which to add the data elements
+* @param elements - The elements which need to be added. A copy of every element will be inserted.
+* @param priorities - priorities[i] is the priority of elements[i].
+* @param count - The number of elements in the arrays.
+* @return
+* 	PQ_NULL_ARGUMENT if a NULL was sent as one of the parameters or as one of the elements or priorities
+* 	PQ_OUT_OF_MEMORY if an allocation failed
+* 	PQ_SUCCESS the elements had been inserted successfully
+*/
+PriorityQueueResult pqInsertAll(PriorityQueue queue, PQElement* elements, PQElementPriority* priorities, int count);
+
 /**
 *	pqChangePriority: Changes a priority of specific element with a specific priority in the priority queue.
 *           If there are multiple same elements with same priority,
@@ -189,6 +253,23 @@ PriorityQueueResult pqInsert(PriorityQueue queue, PQElement element, PQElementPr
 PriorityQueueResult pqChangePriority(PriorityQueue queue, PQElement element,
     PQElementPriority old_priority, PQElementPriority new_priority);
 
+/**
+*   pqMoveAfter: Moves an element of the queue right behind another element, or to the front of the queue if
+*   previous is NULL, keeping its priority. Nothing is allocated, so the move cannot fail for lack of memory.
+*   The queue is not reordered: the caller must move the element to a place its priority belongs to, like
+*   the place it had before a change that is being undone.
+*   Iterator's value is undefined after this operation.
+*
+* @param queue - The priority queue which holds both elements.
+* @param element - The element to move. If there are multiple same elements, the first one is moved.
+* @param previous - The element to move behind, or NULL.
+* @return
+* 	PQ_NULL_ARGUMENT if a NULL was sent as queue or element.
+* 	PQ_ELEMENT_DOES_NOT_EXISTS if element or previous is not in the queue.
+* 	PQ_SUCCESS the element had been moved successfully.
+*/
+PriorityQueueResult pqMoveAfter(PriorityQueue queue, PQElement element, PQElement previous);
+
 /**
 *   pqRemove: Removes the highest priority element from the priority queue.
 *   If there are multiple elements with the same highest priority, the first inserted element should be removed first.
@@ -245,6 +326,34 @@ PQElement pqGetFirst(PriorityQueue queue);
 */
 PQElement pqGetNext(PriorityQueue queue);
 
+/**
+* pqGetFirstPosition: Returns the position of the first element of the priority queue.
+* Does not read or change the internal iterator, so it is safe while other traversals of the queue run.
+*
+* @return
+* 	NULL if a NULL pointer was sent or the priority queue is empty.
+* 	The first position otherwise.
+*/
+PQPosition pqGetFirstPosition(PriorityQueue queue);
+
+/**
+* pqGetNextPosition: Returns the position of the element which comes right after the given one.
+*
+* @return
+* 	NULL if a NULL pointer was sent or position is the last one.
+* 	The next position otherwise.
+*/
+PQPosition pqGetNextPosition(PQPosition position);
+
+/**
+* pqPositionGetElement: Returns the element at a position.
+*
+* @return
+* 	NULL if a NULL pointer was sent.
+* 	The element otherwise.
+*/
+PQElement pqPositionGetElement(PQPosition position);
+
 /**
 * pqClear: Removes all elements and priorities from target priority queue.
 * The elements are deallocated using the stored free functions.
@@ -265,4 +374,13 @@ PriorityQueueResult pqClear(PriorityQueue queue);
         iterator ;\
         iterator = pqGetNext(queue))
 
+/*!
+* Macro for iterating over the positions of a priority queue without the internal iterator.
+* Declares a new position for the loop.
+*/
+#define PQ_FOREACH_POSITION(position, queue) \
+    for(PQPosition position = pqGetFirstPosition(queue) ; \
+        position ;\
+        position = pqGetNextPosition(position))
+
 #endif /* PRIORITY_QUEUE_H_ */
@@ -0,0 +1,500 @@
+#include "sharded_event_manager.h"
+#include "thread_pool.h"
+#include "stdlib.h"
+#include "string.h"
+#include "limits.h"
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+// Adds and date changes of the same name and date take the same name lock, so two shards cannot both accept them
+#define SEM_NAME_LOCKS 64
+#define SEM_LAST_DAY 30
+#define SEM_LAST_MONTH 12
+
+struct ShardedEventManager_t
+{
+	int shardCount;
+	EventManager* shards;
+	Date currentDate;
+	// Later than any event, the end of the range searched for the next event of a shard
+	Date lastDate;
+	ThreadPool tickPool;
+	// The days and the results of the parallel tick which is running
+	int tickDays;
+	EventManagerResult* tickResults;
+#ifndef _WIN32
+	// Taken for writing by the calls which change every shard, and for reading by all the others
+	pthread_rwlock_t lock;
+	pthread_mutex_t nameLocks[SEM_NAME_LOCKS];
+#endif
+};
+
+/** The event of a shard which comes first, as found by semGetNextEvent */
+typedef struct ShardHead_t
+{
+	const char* name;
+	int day;
+	int month;
+	int year;
+} ShardHead;
+
+/** A name looked for among the events of one date */
+typedef struct NameSearch_t
+{
+	const char* name;
+	bool found;
+} NameSearch;
+
+static void semLockForReading(ShardedEventManager sem)
+{
+#ifndef _WIN32
+	pthread_rwlock_rdlock(&sem->lock);
+#endif
+}
+
+static void semLockForWriting(ShardedEventManager sem)
+{
+#ifndef _WIN32
+	pthread_rwlock_wrlock(&sem->lock);
+#endif
+}
+
+static void semUnlock(ShardedEventManager sem)
+{
+#ifndef _WIN32
+	pthread_rwlock_unlock(&sem->lock);
+#endif
+}
+
+static int semGetNameLock(const char* name, Date date)
+{
+	unsigned int hash = 2166136261u;
+	for (const char* character = name; *character != '\0'; character++)
+	{
+		hash = (hash ^ (unsigned char)*character) * 16777619u;
+	}
+	int day, month, year;
+	dateGet(date, &day, &month, &year);
+	hash ^= (unsigned int)(year * SEM_LAST_MONTH + month) * SEM_LAST_DAY + day;
+
+	return hash % SEM_NAME_LOCKS;
+}
+
+static void semLockName(ShardedEventManager sem, int nameLock)
+{
+#ifndef _WIN32
+	pthread_mutex_lock(&sem->nameLocks[nameLock]);
+#endif
+}
+
+static void semUnlockName(ShardedEventManager sem, int nameLock)
+{
+#ifndef _WIN32
+	pthread_mutex_unlock(&sem->nameLocks[nameLock]);
+#endif
+}
+
+static EventManager semGetShard(ShardedEventManager sem, int event_id)
+{
+	// Fibonacci hashing spreads consecutive ids over all the shards
+	unsigned int hash = (unsigned int)event_id * 2654435761u;
+	return sem->shards[(hash >> 16) % sem->shardCount];
+}
+
+/*
+* A shard which ran out of memory destroyed itself, so the manager is destroyed as well, as an event manager would be.
+* Called after unlocking.
+*/
+static EventManagerResult semFinish(ShardedEventManager sem, EventManager shard, EventManagerResult result)
+{
+	if (result == EM_OUT_OF_MEMORY)
+	{
+		for (int i = 0; i < sem->shardCount; i++)
+		{
+			if (sem->shards[i] == shard)
+			{
+				sem->shards[i] = NULL;
+			}
+		}
+		destroyShardedEventManager(sem);
+	}
+
+	return result;
+}
+
+static bool semFindName(void* context, int event_id, const char* event_name, Date date)
+{
+	(void)event_id;
+	(void)date;
+	NameSearch* search = context;
+	search->found = strcmp(search->name, event_name) == 0;
+	return !search->found;
+}
+
+// Must be called with the name lock of name and date held
+static bool semEventWithNameAndDateExists(ShardedEventManager sem, const char* name, Date date)
+{
+	NameSearch search = { name, false };
+	for (int i = 0; i < sem->shardCount && !search.found; i++)
+	{
+		emGetEventsInRange(sem->shards[i], date, date, semFindName, &search);
+	}
+
+	return search.found;
+}
+
+ShardedEventManager createShardedEventManager(Date date, int shards, int options)
+{
+	if (date == NULL || shards <= 0)
+	{
+		return NULL;
+	}
+
+#ifndef _WIN32
+	options |= EM_OPTION_THREAD_SAFE;
+#endif
+
+	ShardedEventManager sem = malloc(sizeof(*sem));
+	if (sem == NULL)
+	{
+		return NULL;
+	}
+
+	sem->shardCount = shards;
+	sem->shards = calloc(shards, sizeof(*sem->shards));
+	sem->tickResults = malloc(shards * sizeof(*sem->tickResults));
+	sem->currentDate = dateCopy(date);
+	sem->lastDate = dateCreate(SEM_LAST_DAY, SEM_LAST_MONTH, INT_MAX);
+	sem->tickPool = threadPoolCreate(shards);
+	sem->tickDays = 0;
+#ifndef _WIN32
+	pthread_rwlock_init(&sem->lock, NULL);
+	for (int i = 0; i < SEM_NAME_LOCKS; i++)
+	{
+		pthread_mutex_init(&sem->nameLocks[i], NULL);
+	}
+#endif
+
+	bool result = sem->shards != NULL && sem->tickResults != NULL && sem->currentDate != NULL
+		&& sem->lastDate != NULL && sem->tickPool != NULL;
+	for (int i = 0; result && i < shards; i++)
+	{
+		sem->shards[i] = createEventManagerWithOptions(date, options);
+		result = sem->shards[i] != NULL;
+	}
+	if (!result)
+	{
+		destroyShardedEventManager(sem);
+		return NULL;
+	}
+
+	return sem;
+}
+
+void destroyShardedEventManager(ShardedEventManager sem)
+{
+	if (sem == NULL)
+	{
+		return;
+	}
+
+	threadPoolDestroy(sem->tickPool);
+	if (sem->shards != NULL)
+	{
+		for (int i = 0; i < sem->shardCount; i++)
+		{
+			destroyEventManager(sem->shards[i]);
+		}
+	}
+#ifndef _WIN32
+	for (int i = 0; i < SEM_NAME_LOCKS; i++)
+	{
+		pthread_mutex_destroy(&sem->nameLocks[i]);
+	}
+	pthread_rwlock_destroy(&sem->lock);
+#endif
+	dateDestroy(sem->currentDate);
+	dateDestroy(sem->lastDate);
+	free(sem->tickResults);
+	free(sem->shards);
+	free(sem);
+}
+
+// Must be called with the manager locked for reading
+static EventManagerResult semAddEventByDateLocked(ShardedEventManager sem, char* event_name, Date date, int event_id,
+	EventManager* shard)
+{
+	*shard = NULL;
+	if (event_name == NULL || date == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	// The checks come in the order of emAddEventByDate, so the same error is reported
+	if (dateCompare(sem->currentDate, date) > 0)
+	{
+		return EM_INVALID_DATE;
+	}
+
+	if (event_id < 0)
+	{
+		return EM_INVALID_EVENT_ID;
+	}
+
+	int nameLock = semGetNameLock(event_name, date);
+	semLockName(sem, nameLock);
+	EventManagerResult result = EM_EVENT_ALREADY_EXISTS;
+	if (!semEventWithNameAndDateExists(sem, event_name, date))
+	{
+		*shard = semGetShard(sem, event_id);
+		result = emAddEventByDate(*shard, event_name, date, event_id);
+	}
+	semUnlockName(sem, nameLock);
+
+	return result;
+}
+
+EventManagerResult semAddEventByDate(ShardedEventManager sem, char* event_name, Date date, int event_id)
+{
+	if (sem == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	EventManager shard;
+	semLockForReading(sem);
+	EventManagerResult result = semAddEventByDateLocked(sem, event_name, date, event_id, &shard);
+	semUnlock(sem);
+
+	return semFinish(sem, shard, result);
+}
+
+EventManagerResult semAddEventByDiff(ShardedEventManager sem, char* event_name, int days, int event_id)
+{
+	if (sem == NULL || event_name == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	if (days < 0)
+	{
+		return EM_INVALID_DATE;
+	}
+
+	EventManager shard = NULL;
+	// The current date only changes under the lock for writing, so the date is computed under the same lock
+	semLockForReading(sem);
+	Date date = dateCopy(sem->currentDate);
+	EventManagerResult result = EM_OUT_OF_MEMORY;
+	if (date != NULL)
+	{
+		for (int i = 0; i < days; i++)
+		{
+			dateTick(date);
+		}
+		result = semAddEventByDateLocked(sem, event_name, date, event_id, &shard);
+		dateDestroy(date);
+	}
+	semUnlock(sem);
+
+	return semFinish(sem, shard, result);
+}
+
+EventManagerResult semRemoveEvent(ShardedEventManager sem, int event_id)
+{
+	if (sem == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	semLockForReading(sem);
+	EventManager shard = semGetShard(sem, event_id);
+	EventManagerResult result = emRemoveEvent(shard, event_id);
+	semUnlock(sem);
+
+	return semFinish(sem, shard, result);
+}
+
+EventManagerResult semChangeEventDate(ShardedEventManager sem, int event_id, Date new_date)
+{
+	if (sem == NULL || new_date == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	semLockForReading(sem);
+	EventManager shard = semGetShard(sem, event_id);
+	const char* name = emGetEventName(shard, event_id);
+	EventManagerResult result;
+	if (name == NULL || dateCompare(sem->currentDate, new_date) > 0)
+	{
+		// The shard reports the invalid date, the invalid id or the missing event
+		result = emChangeEventDate(shard, event_id, new_date);
+	}
+	else
+	{
+		int nameLock = semGetNameLock(name, new_date);
+		semLockName(sem, nameLock);
+		result = semEventWithNameAndDateExists(sem, name, new_date) ? EM_EVENT_ALREADY_EXISTS
+			: emChangeEventDate(shard, event_id, new_date);
+		semUnlockName(sem, nameLock);
+	}
+	semUnlock(sem);
+
+	return semFinish(sem, shard, result);
+}
+
+EventManagerResult semAddMember(ShardedEventManager sem, char* member_name, int member_id)
+{
+	if (sem == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	// The shards hold the same members, so the first shard decides and the others can only run out of memory
+	semLockForWriting(sem);
+	EventManager shard = sem->shards[0];
+	EventManagerResult result = emAddMember(shard, member_name, member_id);
+	for (int i = 1; i < sem->shardCount && result == EM_SUCCESS; i++)
+	{
+		shard = sem->shards[i];
+		result = emAddMember(shard, member_name, member_id);
+	}
+	semUnlock(sem);
+
+	return semFinish(sem, shard, result);
+}
+
+EventManagerResult semAddMemberToEvent(ShardedEventManager sem, int member_id, int event_id)
+{
+	if (sem == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	semLockForReading(sem);
+	EventManager shard = semGetShard(sem, event_id);
+	EventManagerResult result = emAddMemberToEvent(shard, member_id, event_id);
+	semUnlock(sem);
+
+	return semFinish(sem, shard, result);
+}
+
+EventManagerResult semRemoveMemberFromEvent(ShardedEventManager sem, int member_id, int event_id)
+{
+	if (sem == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	semLockForReading(sem);
+	EventManager shard = semGetShard(sem, event_id);
+	EventManagerResult result = emRemoveMemberFromEvent(shard, member_id, event_id);
+	semUnlock(sem);
+
+	return semFinish(sem, shard, result);
+}
+
+// Runs on a worker of the tick pool. Every shard has its own lock, so the shards expire their events independently
+static void semTickShard(void* context, int index)
+{
+	ShardedEventManager sem = context;
+	sem->tickResults[index] = emTick(sem->shards[index], sem->tickDays);
+}
+
+EventManagerResult semTick(ShardedEventManager sem, int days)
+{
+	if (sem == NULL)
+	{
+		return EM_NULL_ARGUMENT;
+	}
+
+	if (days <= 0)
+	{
+		return EM_INVALID_DATE;
+	}
+
+	semLockForWriting(sem);
+	sem->tickDays = days;
+	threadPoolRun(sem->tickPool, semTickShard, sem, sem->shardCount);
+	for (int i = 0; i < days; i++)
+	{
+		dateTick(sem->currentDate);
+	}
+
+	EventManagerResult result = EM_SUCCESS;
+	for (int i = 0; i < sem->shardCount && result == EM_SUCCESS; i++)
+	{
+		result = sem->tickResults[i];
+	}
+	semUnlock(sem);
+
+	return result;
+}
+
+int semGetEventsAmount(ShardedEventManager sem)
+{
+	if (sem == NULL)
+	{
+		return -1;
+	}
+
+	int amount = 0;
+	semLockForReading(sem);
+	for (int i = 0; i < sem->shardCount; i++)
+	{
+		amount += emGetEventsAmount(sem->shards[i]);
+	}
+	semUnlock(sem);
+
+	return amount;
+}
+
+static bool semGetHead(void* context, int event_id, const char* event_name, Date date)
+{
+	(void)event_id;
+	ShardHead* head = context;
+	head->name = event_name;
+	dateGet(date, &head->day, &head->month, &head->year);
+	return false;
+}
+
+static bool semHeadComesFirst(ShardHead* head, ShardHead* first)
+{
+	if (first->name == NULL || head->year != first->year)
+	{
+		return first->name == NULL || head->year < first->year;
+	}
+	if (head->month != first->month)
+	{
+		return head->month < first->month;
+	}
+
+	return head->day < first->day;
+}
+
+char* semGetNextEvent(ShardedEventManager sem)
+{
+	if (sem == NULL)
+	{
+		return NULL;
+	}
+
+	// Ties go to the lower shard, so the result is the same however the shards are visited
+	ShardHead first = { NULL, 0, 0, 0 };
+	semLockForReading(sem);
+	for (int i = 0; i < sem->shardCount; i++)
+	{
+		ShardHead head = { NULL, 0, 0, 0 };
+		emGetEventsInRange(sem->shards[i], sem->currentDate, sem->lastDate, semGetHead, &head);
+		if (head.name != NULL && semHeadComesFirst(&head, &first))
+		{
+			first = head;
+		}
+	}
+	semUnlock(sem);
+
+	return (char*)first.name;
+}
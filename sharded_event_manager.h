@@ -0,0 +1,106 @@
+#ifndef SHARDED_EVENT_MANAGER_H
+#define SHARDED_EVENT_MANAGER_H
+
+#include "event_manager.h"
+
+/**
+* Sharded Event Manager
+*
+* Spreads the events over several event managers, the shards, by a hash of the event id, so calls for events of
+* different shards run on different cores. Every shard is a thread safe event manager with its own queues and lock.
+* Members are added to every shard, so an event is linked to its members inside its own shard.
+*
+* The functions behave like the event manager functions of the same name, with the same results, except that
+* events of the same date in different shards come in shard order instead of the order they were added in.
+* emTick expires the shards in parallel on a pool with one thread per shard.
+* Where POSIX threads are not available the shards are not locked, and the manager must be used from one thread.
+*
+* The following functions are available:
+*   createShardedEventManager	- Creates a new empty manager with a number of shards
+*   destroyShardedEventManager	- Deletes an existing manager and its shards
+*   semAddEventByDate		- Adds an event at a date
+*   semAddEventByDiff		- Adds an event a number of days from the current date
+*   semRemoveEvent		- Removes an event
+*   semChangeEventDate		- Moves an event to another date
+*   semAddMember		- Adds a member
+*   semAddMemberToEvent		- Makes a member responsible for an event
+*   semRemoveMemberFromEvent	- Removes a member from an event
+*   semTick			- Advances the current date, expiring the shards in parallel
+*   semGetEventsAmount		- Returns the number of events
+*   semGetNextEvent		- Returns the name of the next event
+*/
+
+/** Type for defining the sharded event manager */
+typedef struct ShardedEventManager_t* ShardedEventManager;
+
+/**
+* createShardedEventManager: Allocates a new empty manager whose current date is date.
+*
+* @param shards - The number of shards, at least 1.
+* @param options - Options of createEventManagerWithOptions for every shard. EM_OPTION_THREAD_SAFE is always added
+* 		where it is available.
+* @return
+* 	NULL - if date is NULL, shards is not positive, an allocation failed or a thread could not be started.
+* 	A new ShardedEventManager in case of success.
+*/
+ShardedEventManager createShardedEventManager(Date date, int shards, int options);
+
+/**
+* destroyShardedEventManager: Deallocates an existing manager and its shards. No other call may be running.
+*
+* @param sem - Target manager to be deallocated. If sem is NULL nothing will be done
+*/
+void destroyShardedEventManager(ShardedEventManager sem);
+
+/**
+* semAddEventByDate: Same as emAddEventByDate. Names are checked against the events of every shard.
+* After EM_OUT_OF_MEMORY the manager is destroyed, as with emAddEventByDate.
+*/
+EventManagerResult semAddEventByDate(ShardedEventManager sem, char* event_name, Date date, int event_id);
+
+/**
+* semAddEventByDiff: Same as emAddEventByDiff.
+*/
+EventManagerResult semAddEventByDiff(ShardedEventManager sem, char* event_name, int days, int event_id);
+
+/**
+* semRemoveEvent: Same as emRemoveEvent.
+*/
+EventManagerResult semRemoveEvent(ShardedEventManager sem, int event_id);
+
+/**
+* semChangeEventDate: Same as emChangeEventDate. The new date is checked against the events of every shard.
+*/
+EventManagerResult semChangeEventDate(ShardedEventManager sem, int event_id, Date new_date);
+
+/**
+* semAddMember: Same as emAddMember. The member is added to every shard, while no other call runs.
+*/
+EventManagerResult semAddMember(ShardedEventManager sem, char* member_name, int member_id);
+
+/**
+* semAddMemberToEvent: Same as emAddMemberToEvent.
+*/
+EventManagerResult semAddMemberToEvent(ShardedEventManager sem, int member_id, int event_id);
+
+/**
+* semRemoveMemberFromEvent: Same as emRemoveMemberFromEvent.
+*/
+EventManagerResult semRemoveMemberFromEvent(ShardedEventManager sem, int member_id, int event_id);
+
+/**
+* semTick: Same as emTick. Every shard expires its events on its own thread, and no other call runs meanwhile.
+*/
+EventManagerResult semTick(ShardedEventManager sem, int days);
+
+/**
+* semGetEventsAmount: Same as emGetEventsAmount.
+*/
+int semGetEventsAmount(ShardedEventManager sem);
+
+/**
+* semGetNextEvent: Same as emGetNextEvent. The next events of the shards are compared, and the earliest one wins.
+*/
+char* semGetNextEvent(ShardedEventManager sem);
+
+#endif /* SHARDED_EVENT_MANAGER_H */
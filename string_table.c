@@ -0,0 +1,213 @@
+#include "string_table.h"
+#include "arena.h"
+#include "stdbool.h"
+#include "stdlib.h"
+#include "string.h"
+
+#define STRING_TABLE_INITIAL_CAPACITY 64
+#define STRING_TABLE_MAX_LOAD_PERCENT 70
+#define STRING_TABLE_PAGE_SIZE 4096
+
+typedef struct StringTableEntry_t
+{
+	const char* string;
+	unsigned int hash;
+} StringTableEntry;
+
+struct StringTable_t
+{
+	Arena characters;
+	StringTableEntry* entries;
+	unsigned int capacity;
+	unsigned int size;
+};
+
+static unsigned int hashString(const char* string, size_t length)
+{
+	unsigned int hash = 2166136261u;
+	for (size_t i = 0; i < length; i++)
+	{
+		hash ^= (unsigned char)string[i];
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+static StringTableEntry* stringTableFindSlot(StringTableEntry* entries, unsigned int capacity,
+	const char* string, size_t length, unsigned int hash)
+{
+	unsigned int index = hash & (capacity - 1);
+	while (entries[index].string != NULL)
+	{
+		// The searched string does not have to be terminated, so the stored one must end right after it
+		if (entries[index].hash == hash && memcmp(entries[index].string, string, length) == 0
+			&& entries[index].string[length] == '\0')
+		{
+			break;
+		}
+		index = (index + 1) & (capacity - 1);
+	}
+
+	return &entries[index];
+}
+
+static bool stringTableResize(StringTable table, unsigned int capacity)
+{
+	StringTableEntry* entries = calloc(capacity, sizeof(*entries));
+	if (entries == NULL)
+	{
+		return false;
+	}
+
+	for (unsigned int i = 0; i < table->capacity; i++)
+	{
+		StringTableEntry entry = table->entries[i];
+		if (entry.string != NULL)
+		{
+			// Stored strings are all distinct, so only an empty slot is searched for
+			unsigned int index = entry.hash & (capacity - 1);
+			while (entries[index].string != NULL)
+			{
+				index = (index + 1) & (capacity - 1);
+			}
+			entries[index] = entry;
+		}
+	}
+
+	free(table->entries);
+	table->entries = entries;
+	table->capacity = capacity;
+
+	return true;
+}
+
+StringTable stringTableCreate()
+{
+	StringTable table = malloc(sizeof(*table));
+	Arena characters = arenaCreate(0);
+	StringTableEntry* entries = calloc(STRING_TABLE_INITIAL_CAPACITY, sizeof(*entries));
+	if (table == NULL || characters == NULL || entries == NULL)
+	{
+		free(table);
+		arenaDestroy(characters);
+		free(entries);
+		return NULL;
+	}
+
+	table->characters = characters;
+	table->entries = entries;
+	table->capacity = STRING_TABLE_INITIAL_CAPACITY;
+	table->size = 0;
+
+	return table;
+}
+
+void stringTableDestroy(StringTable table)
+{
+	if (table == NULL)
+	{
+		return;
+	}
+
+	arenaDestroy(table->characters);
+	free(table->entries);
+	free(table);
+}
+
+const char* stringTableIntern(StringTable table, const char* string)
+{
+	if (string == NULL)
+	{
+		return NULL;
+	}
+
+	return stringTableInternLength(table, string, strlen(string));
+}
+
+const char* stringTableInternLength(StringTable table, const char* string, size_t length)
+{
+	if (table == NULL || string == NULL)
+	{
+		return NULL;
+	}
+
+	unsigned int hash = hashString(string, length);
+	StringTableEntry* slot = stringTableFindSlot(table->entries, table->capacity, string, length, hash);
+	if (slot->string != NULL)
+	{
+		return slot->string;
+	}
+
+	if ((table->size + 1) * 100 > table->capacity * STRING_TABLE_MAX_LOAD_PERCENT)
+	{
+		if (!stringTableResize(table, table->capacity * 2))
+		{
+			return NULL;
+		}
+		slot = stringTableFindSlot(table->entries, table->capacity, string, length, hash);
+	}
+
+	char* copy = arenaAlloc(table->characters, length + 1);
+	if (copy == NULL)
+	{
+		return NULL;
+	}
+	memcpy(copy, string, length);
+	copy[length] = '\0';
+
+	slot->string = copy;
+	slot->hash = hash;
+	table->size++;
+
+	return copy;
+}
+
+bool stringTableReserve(StringTable table, int count, size_t bytes)
+{
+	if (table == NULL)
+	{
+		return false;
+	}
+
+	unsigned int capacity = table->capacity;
+	while ((unsigned long long)(table->size + count) * 100 > (unsigned long long)capacity * STRING_TABLE_MAX_LOAD_PERCENT)
+	{
+		capacity *= 2;
+	}
+
+	if (capacity != table->capacity && !stringTableResize(table, capacity))
+	{
+		return false;
+	}
+
+	// calloc leaves fresh pages unmapped until their first write, which would otherwise land on a later intern
+	volatile char* pages = (volatile char*)table->entries;
+	for (size_t i = 0; i < capacity * sizeof(*table->entries); i += STRING_TABLE_PAGE_SIZE)
+	{
+		pages[i] = pages[i];
+	}
+
+	return arenaReserveRoom(table->characters, bytes, count);
+}
+
+const char* stringTableFind(StringTable table, const char* string)
+{
+	if (string == NULL)
+	{
+		return NULL;
+	}
+
+	return stringTableFindLength(table, string, strlen(string));
+}
+
+const char* stringTableFindLength(StringTable table, const char* string, size_t length)
+{
+	if (table == NULL || string == NULL)
+	{
+		return NULL;
+	}
+
+	unsigned int hash = hashString(string, length);
+	return stringTableFindSlot(table->entries, table->capacity, string, length, hash)->string;
+}
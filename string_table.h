@@ -0,0 +1,89 @@
+#ifndef STRING_TABLE_H
+#define STRING_TABLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+* String Intern Table
+*
+* Stores every distinct string once and hands out a stable handle to it.
+* Two handles returned by the same table are equal if and only if the strings are equal,
+* so interned strings can be compared by pointer.
+* The characters are kept in a bump arena owned by the table and stay valid until the table is destroyed.
+*
+* The following functions are available:
+*   stringTableCreate		- Creates a new empty string table
+*   stringTableDestroy		- Deletes an existing string table and every interned string
+*   stringTableIntern		- Returns the handle of a string, storing it if it is new
+*   stringTableInternLength	- Same as stringTableIntern, for a string given by its length
+*   stringTableFind		- Returns the handle of a string only if it was already interned
+*   stringTableFindLength	- Same as stringTableFind, for a string given by its length
+*   stringTableReserve		- Makes room for strings to be interned later
+*/
+
+/** Type for defining the string table */
+typedef struct StringTable_t* StringTable;
+
+/**
+* stringTableCreate: Allocates a new empty string table.
+*
+* @return
+* 	NULL - if allocations failed.
+* 	A new StringTable in case of success.
+*/
+StringTable stringTableCreate();
+
+/**
+* stringTableDestroy: Deallocates an existing string table and every string interned in it.
+*
+* @param table - Target string table to be deallocated. If table is NULL nothing will be done
+*/
+void stringTableDestroy(StringTable table);
+
+/**
+* stringTableIntern: Returns the handle of a string. If the string was not interned yet,
+* a copy of it is stored in the table.
+*
+* @param table - The string table to intern the string in.
+* @param string - The string to intern.
+* @return
+* 	NULL if a NULL was sent or a memory allocation failed.
+* 	The handle of the string otherwise.
+*/
+const char* stringTableIntern(StringTable table, const char* string);
+
+/**
+* stringTableInternLength: Same as stringTableIntern, for the first length characters of string.
+* The characters do not have to be followed by a terminator, so a string can be interned straight
+* from the middle of a larger buffer.
+*/
+const char* stringTableInternLength(StringTable table, const char* string, size_t length);
+
+/**
+* stringTableFind: Returns the handle of a string without interning it.
+*
+* @param table - The string table to search in.
+* @param string - The string to look for.
+* @return
+* 	NULL if a NULL was sent or the string was never interned.
+* 	The handle of the string otherwise.
+*/
+const char* stringTableFind(StringTable table, const char* string);
+
+/**
+* stringTableFindLength: Same as stringTableFind, for the first length characters of string.
+*/
+const char* stringTableFindLength(StringTable table, const char* string, size_t length);
+
+/**
+* stringTableReserve: Makes sure count new strings, bytes long in total with their terminators, can be interned
+* without taking memory from the heap. Strings that were interned already do not use the reservation.
+*
+* @return
+* 	false if a NULL was sent or a memory allocation failed.
+* 	true otherwise.
+*/
+bool stringTableReserve(StringTable table, int count, size_t bytes);
+
+#endif /* STRING_TABLE_H */
@@ -0,0 +1,217 @@
+#include "text_writer.h"
+#include "stdlib.h"
+#include "string.h"
+#include "errno.h"
+#include "stdint.h"
+
+#ifdef _WIN32
+#include <io.h>
+#define write _write
+#else
+#include <unistd.h>
+#endif
+
+#define TEXT_WRITER_DEFAULT_CAPACITY (64 * 1024)
+// Enough for the digits and the sign of any 32 bit integer
+#define INT_MAX_CHARACTERS 11
+
+struct TextWriter_t
+{
+	char* buffer;
+	int capacity;
+	int used;
+	TextWriterOutput output;
+	void* outputContext;
+	bool failed;
+};
+
+static bool writeAll(TextWriter writer, const char* data, int length)
+{
+	if (length > 0 && !writer->failed && !writer->output(writer->outputContext, data, length))
+	{
+		writer->failed = true;
+	}
+
+	return !writer->failed;
+}
+
+bool textWriterFdOutput(void* context, const char* data, int length)
+{
+	int fd = (int)(intptr_t)context;
+	while (length > 0)
+	{
+		int written = write(fd, data, length);
+		if (written < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			return false;
+		}
+		data += written;
+		length -= written;
+	}
+
+	return true;
+}
+
+TextWriter textWriterCreate(int capacity)
+{
+	if (capacity <= 0)
+	{
+		capacity = TEXT_WRITER_DEFAULT_CAPACITY;
+	}
+	// Room for a full integer is always needed
+	if (capacity < INT_MAX_CHARACTERS)
+	{
+		capacity = INT_MAX_CHARACTERS;
+	}
+
+	TextWriter writer = malloc(sizeof(*writer));
+	char* buffer = malloc(capacity);
+	if (writer == NULL || buffer == NULL)
+	{
+		free(writer);
+		free(buffer);
+		return NULL;
+	}
+
+	writer->buffer = buffer;
+	writer->capacity = capacity;
+	writer->used = 0;
+	writer->output = NULL;
+	writer->outputContext = NULL;
+	writer->failed = false;
+
+	return writer;
+}
+
+void textWriterDestroy(TextWriter writer)
+{
+	if (writer == NULL)
+	{
+		return;
+	}
+
+	free(writer->buffer);
+	free(writer);
+}
+
+void textWriterBegin(TextWriter writer, TextWriterOutput output, void* context)
+{
+	if (writer == NULL)
+	{
+		return;
+	}
+
+	writer->used = 0;
+	writer->output = output;
+	writer->outputContext = context;
+	// Without an output function every write fails
+	writer->failed = output == NULL;
+}
+
+bool textWriterEnd(TextWriter writer)
+{
+	if (writer == NULL)
+	{
+		return false;
+	}
+
+	bool result = textWriterFlush(writer);
+	writer->output = NULL;
+	writer->outputContext = NULL;
+
+	return result;
+}
+
+bool textWriterFlush(TextWriter writer)
+{
+	if (writer == NULL)
+	{
+		return false;
+	}
+
+	bool result = writeAll(writer, writer->buffer, writer->used);
+	writer->used = 0;
+	return result;
+}
+
+bool textWriterAppendString(TextWriter writer, const char* string)
+{
+	if (writer == NULL || string == NULL)
+	{
+		return false;
+	}
+
+	int length = strlen(string);
+	if (length > writer->capacity - writer->used)
+	{
+		if (!textWriterFlush(writer))
+		{
+			return false;
+		}
+		// A string that does not fit even in an empty buffer is written directly
+		if (length > writer->capacity)
+		{
+			return writeAll(writer, string, length);
+		}
+	}
+
+	memcpy(writer->buffer + writer->used, string, length);
+	writer->used += length;
+	return true;
+}
+
+bool textWriterAppendChar(TextWriter writer, char character)
+{
+	if (writer == NULL)
+	{
+		return false;
+	}
+
+	if (writer->used == writer->capacity && !textWriterFlush(writer))
+	{
+		return false;
+	}
+
+	writer->buffer[writer->used++] = character;
+	return true;
+}
+
+bool textWriterAppendInt(TextWriter writer, int number)
+{
+	if (writer == NULL)
+	{
+		return false;
+	}
+
+	if (writer->capacity - writer->used < INT_MAX_CHARACTERS && !textWriterFlush(writer))
+	{
+		return false;
+	}
+
+	// Digits are produced from the least significant one into a scratch area, then copied in order
+	char digits[INT_MAX_CHARACTERS];
+	int count = 0;
+	unsigned int magnitude = number < 0 ? 0u - (unsigned int)number : (unsigned int)number;
+	do
+	{
+		digits[count++] = (char)('0' + magnitude % 10);
+		magnitude /= 10;
+	} while (magnitude != 0);
+
+	char* out = writer->buffer + writer->used;
+	if (number < 0)
+	{
+		*out++ = '-';
+	}
+	while (count > 0)
+	{
+		*out++ = digits[--count];
+	}
+
+	writer->used = out - writer->buffer;
+	return true;
+}
@@ -0,0 +1,113 @@
+#ifndef TEXT_WRITER_H
+#define TEXT_WRITER_H
+
+#include <stdbool.h>
+
+/**
+* Buffered Text Writer
+*
+* Formats text into one large buffer and hands it to an output function in big chunks.
+* The buffer is allocated once when the writer is created and is reused for every output,
+* so formatting never allocates.
+*
+* The following functions are available:
+*   textWriterCreate		- Creates a new writer with a buffer of a given size
+*   textWriterDestroy		- Deletes an existing writer
+*   textWriterBegin		- Starts writing to an output function
+*   textWriterEnd		- Flushes the output and reports whether all of it was written
+*   textWriterAppendString	- Appends a string
+*   textWriterAppendChar	- Appends a single character
+*   textWriterAppendInt		- Appends an integer in decimal
+*   textWriterFlush		- Writes out everything that is buffered
+*   textWriterFdOutput		- Output function which writes to a file descriptor
+*/
+
+/** Type for defining the text writer */
+typedef struct TextWriter_t* TextWriter;
+
+/**
+* Type of function that receives the output of a writer.
+* This function should consume all length bytes of data, and return:
+* 		true if they were written;
+*		false otherwise;
+*/
+typedef bool(*TextWriterOutput)(void* context, const char* data, int length);
+
+/**
+* textWriterCreate: Allocates a new writer.
+*
+* @param capacity - The size of the buffer in bytes. If 0 is sent a default size is used.
+* @return
+* 	NULL - if allocation failed.
+* 	A new TextWriter in case of success.
+*/
+TextWriter textWriterCreate(int capacity);
+
+/**
+* textWriterDestroy: Deallocates an existing writer. Buffered text which was not flushed is lost.
+*
+* @param writer - Target writer to be deallocated. If writer is NULL nothing will be done
+*/
+void textWriterDestroy(TextWriter writer);
+
+/**
+* textWriterBegin: Discards anything buffered and directs the output of the writer to an output function.
+*
+* @param output - The function every full buffer is handed to.
+* @param context - Passed to output as is.
+*/
+void textWriterBegin(TextWriter writer, TextWriterOutput output, void* context);
+
+/**
+* textWriterEnd: Flushes the output.
+*
+* @return
+* 	false if a NULL was sent or any write of the output since textWriterBegin failed.
+* 	true otherwise.
+*/
+bool textWriterEnd(TextWriter writer);
+
+/**
+* textWriterAppendString: Appends a string to the output.
+*
+* @return
+* 	false if a NULL was sent or writing a full buffer failed.
+* 	true otherwise.
+*/
+bool textWriterAppendString(TextWriter writer, const char* string);
+
+/**
+* textWriterAppendChar: Appends a single character to the output.
+*
+* @return
+* 	false if a NULL was sent or writing a full buffer failed.
+* 	true otherwise.
+*/
+bool textWriterAppendChar(TextWriter writer, char character);
+
+/**
+* textWriterAppendInt: Appends the decimal representation of an integer to the output.
+*
+* @return
+* 	false if a NULL was sent or writing a full buffer failed.
+* 	true otherwise.
+*/
+bool textWriterAppendInt(TextWriter writer, int number);
+
+/**
+* textWriterFlush: Writes everything that is buffered to the output.
+*
+* @return
+* 	false if a NULL was sent, a previous write failed or writing failed.
+* 	true otherwise.
+*/
+bool textWriterFlush(TextWriter writer);
+
+/**
+* textWriterFdOutput: An output function which writes the data to a file descriptor with write(2).
+*
+* @param context - The file descriptor, cast with (void*)(intptr_t)fd.
+*/
+bool textWriterFdOutput(void* context, const char* data, int length);
+
+#endif /* TEXT_WRITER_H */
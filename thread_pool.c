@@ -0,0 +1,237 @@
+#include "thread_pool.h"
+#include "stdlib.h"
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+struct ThreadPool_t
+{
+	int size;
+	ThreadPoolTask task;
+	void* context;
+	int count;
+	// The next index to hand out, and the number of tasks of the batch which did not return yet
+	int next;
+	int pending;
+#ifndef _WIN32
+	pthread_t* threads;
+	pthread_mutex_t mutex;
+	pthread_cond_t workReady;
+	pthread_cond_t workDone;
+	bool stopping;
+#endif
+};
+
+#ifdef _WIN32
+
+ThreadPool threadPoolCreate(int threads)
+{
+	if (threads <= 0)
+	{
+		return NULL;
+	}
+
+	ThreadPool pool = malloc(sizeof(*pool));
+	if (pool == NULL)
+	{
+		return NULL;
+	}
+
+	pool->size = 0;
+	pool->task = NULL;
+	pool->context = NULL;
+	pool->count = 0;
+	pool->next = 0;
+	pool->pending = 0;
+
+	return pool;
+}
+
+void threadPoolDestroy(ThreadPool pool)
+{
+	free(pool);
+}
+
+bool threadPoolStart(ThreadPool pool, ThreadPoolTask task, void* context, int count)
+{
+	if (pool == NULL || task == NULL)
+	{
+		return false;
+	}
+
+	// Without workers the whole batch runs here, so it is already done when threadPoolWait is called
+	for (int i = 0; i < count; i++)
+	{
+		task(context, i);
+	}
+
+	return true;
+}
+
+void threadPoolWait(ThreadPool pool)
+{
+}
+
+#else
+
+static void* threadPoolWorker(void* argument)
+{
+	ThreadPool pool = argument;
+	pthread_mutex_lock(&pool->mutex);
+	while (true)
+	{
+		while (!pool->stopping && pool->next >= pool->count)
+		{
+			pthread_cond_wait(&pool->workReady, &pool->mutex);
+		}
+		if (pool->stopping)
+		{
+			break;
+		}
+
+		int index = pool->next++;
+		pthread_mutex_unlock(&pool->mutex);
+		pool->task(pool->context, index);
+		pthread_mutex_lock(&pool->mutex);
+
+		if (--pool->pending == 0)
+		{
+			pthread_cond_broadcast(&pool->workDone);
+		}
+	}
+	pthread_mutex_unlock(&pool->mutex);
+
+	return NULL;
+}
+
+static void threadPoolStop(ThreadPool pool, int started)
+{
+	pthread_mutex_lock(&pool->mutex);
+	pool->stopping = true;
+	pthread_cond_broadcast(&pool->workReady);
+	pthread_mutex_unlock(&pool->mutex);
+
+	for (int i = 0; i < started; i++)
+	{
+		pthread_join(pool->threads[i], NULL);
+	}
+}
+
+ThreadPool threadPoolCreate(int threads)
+{
+	if (threads <= 0)
+	{
+		return NULL;
+	}
+
+	ThreadPool pool = malloc(sizeof(*pool));
+	pthread_t* handles = malloc(threads * sizeof(*handles));
+	if (pool == NULL || handles == NULL)
+	{
+		free(pool);
+		free(handles);
+		return NULL;
+	}
+
+	pool->size = threads;
+	pool->task = NULL;
+	pool->context = NULL;
+	pool->count = 0;
+	pool->next = 0;
+	pool->pending = 0;
+	pool->threads = handles;
+	pool->stopping = false;
+	pthread_mutex_init(&pool->mutex, NULL);
+	pthread_cond_init(&pool->workReady, NULL);
+	pthread_cond_init(&pool->workDone, NULL);
+
+	for (int i = 0; i < threads; i++)
+	{
+		if (pthread_create(&pool->threads[i], NULL, threadPoolWorker, pool) != 0)
+		{
+			pool->size = i;
+			threadPoolDestroy(pool);
+			return NULL;
+		}
+	}
+
+	return pool;
+}
+
+void threadPoolDestroy(ThreadPool pool)
+{
+	if (pool == NULL)
+	{
+		return;
+	}
+
+	threadPoolWait(pool);
+	threadPoolStop(pool, pool->size);
+	pthread_cond_destroy(&pool->workDone);
+	pthread_cond_destroy(&pool->workReady);
+	pthread_mutex_destroy(&pool->mutex);
+	free(pool->threads);
+	free(pool);
+}
+
+bool threadPoolStart(ThreadPool pool, ThreadPoolTask task, void* context, int count)
+{
+	if (pool == NULL || task == NULL)
+	{
+		return false;
+	}
+
+	pthread_mutex_lock(&pool->mutex);
+	bool idle = pool->pending == 0;
+	if (idle && count > 0)
+	{
+		pool->task = task;
+		pool->context = context;
+		pool->count = count;
+		pool->next = 0;
+		pool->pending = count;
+		pthread_cond_broadcast(&pool->workReady);
+	}
+	pthread_mutex_unlock(&pool->mutex);
+
+	return idle;
+}
+
+void threadPoolWait(ThreadPool pool)
+{
+	if (pool == NULL)
+	{
+		return;
+	}
+
+	pthread_mutex_lock(&pool->mutex);
+	while (pool->pending > 0)
+	{
+		pthread_cond_wait(&pool->workDone, &pool->mutex);
+	}
+	pthread_mutex_unlock(&pool->mutex);
+}
+
+#endif
+
+int threadPoolGetSize(ThreadPool pool)
+{
+	if (pool == NULL)
+	{
+		return -1;
+	}
+
+	return pool->size;
+}
+
+bool threadPoolRun(ThreadPool pool, ThreadPoolTask task, void* context, int count)
+{
+	if (!threadPoolStart(pool, task, context, count))
+	{
+		return false;
+	}
+
+	threadPoolWait(pool);
+	return true;
+}
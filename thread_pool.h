@@ -0,0 +1,79 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stdbool.h>
+
+/**
+* Worker Thread Pool
+*
+* Keeps a fixed number of worker threads alive and runs batches of tasks on them.
+* A batch is one task function which is called once for every index from 0 to count - 1, with the indices
+* handed out to the workers as they become free. Only one batch runs at a time.
+* Where POSIX threads are not available the pool has no workers, and a batch runs on the calling thread.
+*
+* The following functions are available:
+*   threadPoolCreate		- Starts a new pool of worker threads
+*   threadPoolDestroy		- Stops the workers and deletes the pool
+*   threadPoolGetSize		- Returns the number of worker threads
+*   threadPoolStart		- Starts a batch of tasks without waiting for it
+*   threadPoolWait		- Waits until the running batch is done
+*   threadPoolRun		- Runs a batch of tasks and waits for it
+*/
+
+/** Type for defining the thread pool */
+typedef struct ThreadPool_t* ThreadPool;
+
+/** Type of function run by the workers, once for every index of a batch */
+typedef void(*ThreadPoolTask)(void* context, int index);
+
+/**
+* threadPoolCreate: Starts a new pool.
+*
+* @param threads - The number of worker threads, at least 1.
+* @return
+* 	NULL - if threads is not positive, an allocation failed or a thread could not be started.
+* 	A new ThreadPool in case of success.
+*/
+ThreadPool threadPoolCreate(int threads);
+
+/**
+* threadPoolDestroy: Waits for the running batch, stops the workers and deallocates the pool.
+*
+* @param pool - Target pool to be deallocated. If pool is NULL nothing will be done
+*/
+void threadPoolDestroy(ThreadPool pool);
+
+/**
+* threadPoolGetSize: Returns the number of worker threads of a pool.
+*
+* @return
+* 	-1 if a NULL pointer was sent.
+* 	Otherwise the number of workers, which is 0 where threads are not available.
+*/
+int threadPoolGetSize(ThreadPool pool);
+
+/**
+* threadPoolStart: Starts running task(context, index) for every index from 0 to count - 1 and returns
+* without waiting. The calling thread is free to do other work until it calls threadPoolWait.
+*
+* @return
+* 	false if a NULL was sent or a batch is already running.
+* 	true otherwise.
+*/
+bool threadPoolStart(ThreadPool pool, ThreadPoolTask task, void* context, int count);
+
+/**
+* threadPoolWait: Returns once every task of the running batch returned. Returns at once if no batch is running.
+*/
+void threadPoolWait(ThreadPool pool);
+
+/**
+* threadPoolRun: Runs a batch of tasks like threadPoolStart and waits for it to be done.
+*
+* @return
+* 	false if a NULL was sent or a batch is already running.
+* 	true otherwise.
+*/
+bool threadPoolRun(ThreadPool pool, ThreadPoolTask task, void* context, int count);
+
+#endif /* THREAD_POOL_H */
@@ -0,0 +1,647 @@
+#include "../event_manager.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+* Event manager workload generator and trace replay.
+*
+*   workload_benchmark generate <trace file> <operations> [<operation>=<weight> ...] [horizon=<days>] [seed=<n>]
+*       Writes a trace of random operations, picked in proportion to the weights given for them. Every operation of
+*       the trace is valid when it is replayed in order: links join existing events and members, unlinks remove
+*       existing links, dates are changed to days which did not pass yet and events are dated up to horizon days
+*       ahead, so ticks keep expiring them.
+*   workload_benchmark replay <trace file> [arena] [thread_safe]
+*       Reads a trace, recorded or generated, then runs it against a new event manager with the given options and
+*       prints the throughput and a latency line for every kind of operation in it.
+*
+* A trace is a text file of one operation per line, after a start line with the date of the event manager:
+*   start <day> <month> <year>
+*   add_event <event id> <day> <month> <year> <name>
+*   add_member <member id> <name>
+*   link <member id> <event id>
+*   unlink <member id> <event id>
+*   change_date <event id> <day> <month> <year>
+*   tick <days>
+*   export
+* Names have no spaces. Empty lines and lines starting with # are skipped. An export writes all events to a sink
+* which drops them, so its time is the formatting alone.
+*
+* Latencies are kept in histograms of WORKLOAD_HISTOGRAM_SUB_BUCKETS buckets for every power of 2 nanoseconds, so a
+* trace of any length takes the same memory, and a percentile is the upper end of its bucket, at most 1/32 above
+* the exact value. Failed operations are timed like the others and counted apart.
+*/
+
+#define WORKLOAD_HISTOGRAM_SUB_BUCKETS 32
+// Latencies of more than 2^WORKLOAD_HISTOGRAM_MAX_BITS * 64 ns, about 20 hours, all go to the last bucket
+#define WORKLOAD_HISTOGRAM_MAX_BITS 40
+#define WORKLOAD_HISTOGRAM_BUCKETS ((WORKLOAD_HISTOGRAM_MAX_BITS + 2) * WORKLOAD_HISTOGRAM_SUB_BUCKETS)
+#define WORKLOAD_DEFAULT_HORIZON 365
+#define WORKLOAD_MAX_LINE 512
+// How many random picks an operation gets before it gives way to one that makes room for it
+#define WORKLOAD_PICK_ATTEMPTS 64
+
+typedef enum {
+    WORKLOAD_ADD_EVENT,
+    WORKLOAD_ADD_MEMBER,
+    WORKLOAD_LINK,
+    WORKLOAD_UNLINK,
+    WORKLOAD_CHANGE_DATE,
+    WORKLOAD_TICK,
+    WORKLOAD_EXPORT,
+    NUMBER_WORKLOAD_OPERATIONS
+} WorkloadOperation;
+
+static const char* workloadOperationNames[NUMBER_WORKLOAD_OPERATIONS] = {
+        "add_event",
+        "add_member",
+        "link",
+        "unlink",
+        "change_date",
+        "tick",
+        "export"
+};
+
+// The mix generated when no weight is given, which keeps about a thousand events alive
+static const double workloadDefaultWeights[NUMBER_WORKLOAD_OPERATIONS] = {
+        20, 10, 40, 15, 10, 4, 1
+};
+
+typedef struct {
+    int id;
+    int day;
+    int* members;
+    int member_count;
+    int member_capacity;
+} WorkloadEvent;
+
+typedef struct {
+    FILE* trace;
+    unsigned int seed;
+    int horizon;
+    int today;
+    // The day, month and year of every day from the start, as far as events were dated
+    int (*dates)[3];
+    int date_count;
+    int date_capacity;
+    Date next_date;
+    WorkloadEvent* events;
+    int event_count;
+    int event_capacity;
+    long link_count;
+    int member_count;
+    int next_event_id;
+} WorkloadGenerator;
+
+typedef struct {
+    WorkloadOperation operation;
+    int first;
+    int second;
+    Date date;
+    char* name;
+} WorkloadCommand;
+
+typedef struct {
+    long counts[WORKLOAD_HISTOGRAM_BUCKETS];
+    long total;
+    long failed;
+    double max_ns;
+} WorkloadHistogram;
+
+static double workloadNow() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static unsigned int workloadRandom(WorkloadGenerator* generator) {
+    // xorshift, so a seed gives the same trace everywhere
+    generator->seed ^= generator->seed << 13;
+    generator->seed ^= generator->seed >> 17;
+    generator->seed ^= generator->seed << 5;
+    return generator->seed;
+}
+
+static int workloadFindOperation(const char* name, int length) {
+    for (int operation = 0; operation < NUMBER_WORKLOAD_OPERATIONS; operation++) {
+        if ((int)strlen(workloadOperationNames[operation]) == length
+            && strncmp(name, workloadOperationNames[operation], length) == 0) {
+            return operation;
+        }
+    }
+
+    return -1;
+}
+
+static bool workloadPrintDate(WorkloadGenerator* generator, int day) {
+    while (generator->date_count <= day) {
+        if (generator->date_count == generator->date_capacity) {
+            int capacity = generator->date_capacity == 0 ? WORKLOAD_DEFAULT_HORIZON : 2 * generator->date_capacity;
+            int (*dates)[3] = realloc(generator->dates, capacity * sizeof(*dates));
+            if (dates == NULL) {
+                return false;
+            }
+            generator->dates = dates;
+            generator->date_capacity = capacity;
+        }
+        int* date = generator->dates[generator->date_count++];
+        dateGet(generator->next_date, &date[0], &date[1], &date[2]);
+        dateTick(generator->next_date);
+    }
+
+    fprintf(generator->trace, " %d %d %d", generator->dates[day][0], generator->dates[day][1],
+            generator->dates[day][2]);
+    return true;
+}
+
+static bool workloadAddEvent(WorkloadGenerator* generator) {
+    if (generator->event_count == generator->event_capacity) {
+        int capacity = generator->event_capacity == 0 ? 1024 : 2 * generator->event_capacity;
+        WorkloadEvent* events = realloc(generator->events, capacity * sizeof(*events));
+        if (events == NULL) {
+            return false;
+        }
+        generator->events = events;
+        generator->event_capacity = capacity;
+    }
+
+    WorkloadEvent* event = &generator->events[generator->event_count];
+    event->id = generator->next_event_id++;
+    event->day = generator->today + workloadRandom(generator) % generator->horizon;
+    event->members = NULL;
+    event->member_count = 0;
+    event->member_capacity = 0;
+    fprintf(generator->trace, "add_event %d", event->id);
+    if (!workloadPrintDate(generator, event->day)) {
+        return false;
+    }
+    fprintf(generator->trace, " event%d\n", event->id);
+    generator->event_count++;
+    return true;
+}
+
+static bool workloadLinkMember(WorkloadEvent* event, int member_id) {
+    if (event->member_count == event->member_capacity) {
+        int capacity = event->member_capacity == 0 ? 4 : 2 * event->member_capacity;
+        int* members = realloc(event->members, capacity * sizeof(*members));
+        if (members == NULL) {
+            return false;
+        }
+        event->members = members;
+        event->member_capacity = capacity;
+    }
+
+    event->members[event->member_count++] = member_id;
+    return true;
+}
+
+static bool workloadIsLinked(WorkloadEvent* event, int member_id) {
+    for (int i = 0; i < event->member_count; i++) {
+        if (event->members[i] == member_id) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+* Writes one operation of the kind picked, or of the kind that makes room for it when it cannot be done yet: a link
+* without events or free member becomes an add, an unlink without links becomes a link, and so on
+*/
+static bool workloadGenerateOperation(WorkloadGenerator* generator, WorkloadOperation operation) {
+    if (operation == WORKLOAD_UNLINK) {
+        for (int attempt = 0; generator->link_count > 0 && attempt < WORKLOAD_PICK_ATTEMPTS; attempt++) {
+            WorkloadEvent* event = &generator->events[workloadRandom(generator) % generator->event_count];
+            if (event->member_count > 0) {
+                int linked = workloadRandom(generator) % event->member_count;
+                fprintf(generator->trace, "unlink %d %d\n", event->members[linked], event->id);
+                event->members[linked] = event->members[--event->member_count];
+                generator->link_count--;
+                return true;
+            }
+        }
+        operation = WORKLOAD_LINK;
+    }
+
+    if (operation == WORKLOAD_LINK) {
+        for (int attempt = 0; generator->event_count > 0 && generator->member_count > 0
+                              && attempt < WORKLOAD_PICK_ATTEMPTS; attempt++) {
+            WorkloadEvent* event = &generator->events[workloadRandom(generator) % generator->event_count];
+            int member_id = 1 + workloadRandom(generator) % generator->member_count;
+            if (!workloadIsLinked(event, member_id)) {
+                if (!workloadLinkMember(event, member_id)) {
+                    return false;
+                }
+                fprintf(generator->trace, "link %d %d\n", member_id, event->id);
+                generator->link_count++;
+                return true;
+            }
+        }
+        operation = generator->event_count == 0 ? WORKLOAD_ADD_EVENT : WORKLOAD_ADD_MEMBER;
+    }
+
+    // An event must move to another day, so with a horizon of one day no event can move
+    if (operation == WORKLOAD_CHANGE_DATE && (generator->event_count == 0 || generator->horizon == 1)) {
+        operation = WORKLOAD_ADD_EVENT;
+    }
+
+    switch (operation) {
+        case WORKLOAD_ADD_EVENT:
+            return workloadAddEvent(generator);
+        case WORKLOAD_ADD_MEMBER:
+            generator->member_count++;
+            fprintf(generator->trace, "add_member %d member%d\n", generator->member_count, generator->member_count);
+            return true;
+        case WORKLOAD_CHANGE_DATE: {
+            WorkloadEvent* event = &generator->events[workloadRandom(generator) % generator->event_count];
+            int days_ahead = workloadRandom(generator) % generator->horizon;
+            if (generator->today + days_ahead == event->day) {
+                days_ahead = (days_ahead + 1) % generator->horizon;
+            }
+            event->day = generator->today + days_ahead;
+            fprintf(generator->trace, "change_date %d", event->id);
+            if (!workloadPrintDate(generator, event->day)) {
+                return false;
+            }
+            fprintf(generator->trace, "\n");
+            return true;
+        }
+        case WORKLOAD_TICK:
+            // The events of today expire, and every other event is dated later
+            for (int i = generator->event_count - 1; i >= 0; i--) {
+                WorkloadEvent* event = &generator->events[i];
+                if (event->day == generator->today) {
+                    generator->link_count -= event->member_count;
+                    free(event->members);
+                    *event = generator->events[--generator->event_count];
+                }
+            }
+            generator->today++;
+            fprintf(generator->trace, "tick 1\n");
+            return true;
+        default:
+            fprintf(generator->trace, "export\n");
+            return true;
+    }
+}
+
+static int workloadGenerate(int argc, char* argv[]) {
+    if (argc < 4) {
+        fprintf(stdout, "Usage: workload_benchmark generate <trace file> <operations> "
+                        "[<operation>=<weight> ...] [horizon=<days>] [seed=<n>]\n");
+        return 1;
+    }
+
+    WorkloadGenerator generator;
+    memset(&generator, 0, sizeof(generator));
+    generator.seed = 2463534242u;
+    generator.horizon = WORKLOAD_DEFAULT_HORIZON;
+    generator.next_event_id = 1;
+    long operations = strtol(argv[3], NULL, 10);
+    double weights[NUMBER_WORKLOAD_OPERATIONS];
+    bool weighted = false;
+    for (int i = 4; i < argc; i++) {
+        char* value = strchr(argv[i], '=');
+        int operation = value == NULL ? -1 : workloadFindOperation(argv[i], value - argv[i]);
+        if (value != NULL && strncmp(argv[i], "horizon=", 8) == 0) {
+            generator.horizon = strtol(value + 1, NULL, 10);
+        } else if (value != NULL && strncmp(argv[i], "seed=", 5) == 0) {
+            generator.seed = strtoul(value + 1, NULL, 10);
+        } else if (operation >= 0) {
+            if (!weighted) {
+                memset(weights, 0, sizeof(weights));
+                weighted = true;
+            }
+            weights[operation] = strtod(value + 1, NULL);
+        } else {
+            fprintf(stderr, "Invalid argument %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (!weighted) {
+        memcpy(weights, workloadDefaultWeights, sizeof(weights));
+    }
+
+    double total_weight = 0;
+    for (int operation = 0; operation < NUMBER_WORKLOAD_OPERATIONS; operation++) {
+        total_weight += weights[operation] > 0 ? weights[operation] : 0;
+    }
+    if (operations < 0 || generator.horizon <= 0 || generator.seed == 0 || total_weight <= 0) {
+        fprintf(stderr, "Invalid operations, weights, horizon or seed\n");
+        return 1;
+    }
+
+    generator.trace = fopen(argv[2], "w");
+    generator.next_date = dateCreate(1, 1, 2020);
+    if (generator.trace == NULL || generator.next_date == NULL) {
+        fprintf(stderr, "Could not create %s\n", argv[2]);
+        if (generator.trace != NULL) {
+            fclose(generator.trace);
+        }
+        dateDestroy(generator.next_date);
+        return 1;
+    }
+
+    fprintf(generator.trace, "# generated by workload_benchmark, seed %u\nstart 1 1 2020\n", generator.seed);
+    bool generated = true;
+    for (long i = 0; generated && i < operations; i++) {
+        double pick = (workloadRandom(&generator) / 4294967296.0) * total_weight;
+        int operation = 0;
+        while (operation < NUMBER_WORKLOAD_OPERATIONS - 1 && (weights[operation] <= 0 || pick >= weights[operation])) {
+            pick -= weights[operation] > 0 ? weights[operation] : 0;
+            operation++;
+        }
+        generated = workloadGenerateOperation(&generator, operation);
+    }
+
+    for (int i = 0; i < generator.event_count; i++) {
+        free(generator.events[i].members);
+    }
+    free(generator.events);
+    free(generator.dates);
+    dateDestroy(generator.next_date);
+    if (fclose(generator.trace) != 0 || !generated) {
+        fprintf(stderr, "Could not write %s\n", argv[2]);
+        return 1;
+    }
+
+    return 0;
+}
+
+static void workloadDestroyCommands(WorkloadCommand* commands, long count) {
+    for (long i = 0; i < count; i++) {
+        dateDestroy(commands[i].date);
+        free(commands[i].name);
+    }
+    free(commands);
+}
+
+// Parses the operation of one trace line into command, returning false if the line is not valid
+static bool workloadParseCommand(const char* line, WorkloadCommand* command) {
+    int length = strcspn(line, " \t\r\n");
+    int operation = workloadFindOperation(line, length);
+    const char* arguments = line + length;
+    int day = 0, month = 0, year = 0;
+    char name[WORKLOAD_MAX_LINE];
+    memset(command, 0, sizeof(*command));
+    command->operation = operation;
+    switch (operation) {
+        case WORKLOAD_ADD_EVENT:
+            if (sscanf(arguments, "%d %d %d %d %s", &command->first, &day, &month, &year, name) != 5) {
+                return false;
+            }
+            break;
+        case WORKLOAD_ADD_MEMBER:
+            if (sscanf(arguments, "%d %s", &command->first, name) != 2) {
+                return false;
+            }
+            break;
+        case WORKLOAD_LINK:
+        case WORKLOAD_UNLINK:
+            return sscanf(arguments, "%d %d", &command->first, &command->second) == 2;
+        case WORKLOAD_CHANGE_DATE:
+            if (sscanf(arguments, "%d %d %d %d", &command->first, &day, &month, &year) != 4) {
+                return false;
+            }
+            break;
+        case WORKLOAD_TICK:
+            return sscanf(arguments, "%d", &command->first) == 1;
+        case WORKLOAD_EXPORT:
+            return true;
+        default:
+            return false;
+    }
+
+    if (operation != WORKLOAD_ADD_MEMBER) {
+        command->date = dateCreate(day, month, year);
+        if (command->date == NULL) {
+            return false;
+        }
+    }
+    if (operation != WORKLOAD_CHANGE_DATE) {
+        command->name = malloc(strlen(name) + 1);
+        if (command->name == NULL) {
+            dateDestroy(command->date);
+            command->date = NULL;
+            return false;
+        }
+        strcpy(command->name, name);
+    }
+
+    return true;
+}
+
+/*
+* Reads the whole trace before anything is timed. Returns the commands and sets start and count, or returns NULL
+* after saying what is wrong with the trace
+*/
+static WorkloadCommand* workloadReadTrace(const char* path, Date* start, long* count) {
+    FILE* trace = fopen(path, "r");
+    if (trace == NULL) {
+        fprintf(stderr, "Could not open %s\n", path);
+        return NULL;
+    }
+
+    WorkloadCommand* commands = NULL;
+    long capacity = 0;
+    char line[WORKLOAD_MAX_LINE];
+    long line_number = 0;
+    *start = NULL;
+    *count = 0;
+    while (fgets(line, sizeof(line), trace) != NULL) {
+        line_number++;
+        if (line[0] == '#' || line[strspn(line, " \t\r\n")] == '\0') {
+            continue;
+        }
+
+        int day, month, year;
+        if (*start == NULL) {
+            if (sscanf(line, "start %d %d %d", &day, &month, &year) != 3
+                || (*start = dateCreate(day, month, year)) == NULL) {
+                fprintf(stderr, "%s:%ld: expected a start line with a valid date\n", path, line_number);
+                break;
+            }
+            continue;
+        }
+
+        if (*count == capacity) {
+            long new_capacity = capacity == 0 ? 1024 : 2 * capacity;
+            WorkloadCommand* new_commands = realloc(commands, new_capacity * sizeof(*commands));
+            if (new_commands == NULL) {
+                fprintf(stderr, "%s:%ld: out of memory\n", path, line_number);
+                break;
+            }
+            commands = new_commands;
+            capacity = new_capacity;
+        }
+        if (!workloadParseCommand(line, &commands[*count])) {
+            fprintf(stderr, "%s:%ld: invalid operation %s", path, line_number, line);
+            break;
+        }
+        (*count)++;
+    }
+
+    bool failed = !feof(trace) || *start == NULL;
+    fclose(trace);
+    if (failed) {
+        workloadDestroyCommands(commands, *count);
+        dateDestroy(*start);
+        return NULL;
+    }
+
+    return commands;
+}
+
+static bool workloadDropOutput(void* context, const char* data, int length) {
+    (void)context;
+    (void)data;
+    (void)length;
+    return true;
+}
+
+static EventManagerResult workloadApply(EventManager em, WorkloadCommand* command) {
+    EventManagerSink sink = { workloadDropOutput, NULL };
+    switch (command->operation) {
+        case WORKLOAD_ADD_EVENT:
+            return emAddEventByDate(em, command->name, command->date, command->first);
+        case WORKLOAD_ADD_MEMBER:
+            return emAddMember(em, command->name, command->first);
+        case WORKLOAD_LINK:
+            return emAddMemberToEvent(em, command->first, command->second);
+        case WORKLOAD_UNLINK:
+            return emRemoveMemberFromEvent(em, command->first, command->second);
+        case WORKLOAD_CHANGE_DATE:
+            return emChangeEventDate(em, command->first, command->date);
+        case WORKLOAD_TICK:
+            return emTick(em, command->first);
+        default:
+            return emWriteAllEvents(em, sink);
+    }
+}
+
+static void workloadRecord(WorkloadHistogram* histogram, double seconds, bool failed) {
+    double ns = seconds * 1e9;
+    unsigned long long value = ns < 0 ? 0 : (unsigned long long)ns;
+    int bits = 0;
+    while (bits < WORKLOAD_HISTOGRAM_MAX_BITS && (value >> bits) >= 2 * WORKLOAD_HISTOGRAM_SUB_BUCKETS) {
+        bits++;
+    }
+    // Below 2 * WORKLOAD_HISTOGRAM_SUB_BUCKETS every ns has a bucket, above it every bucket is 2^bits ns wide
+    long bucket = bits * WORKLOAD_HISTOGRAM_SUB_BUCKETS + (long)(value >> bits);
+    if (bucket >= WORKLOAD_HISTOGRAM_BUCKETS) {
+        bucket = WORKLOAD_HISTOGRAM_BUCKETS - 1;
+    }
+
+    histogram->counts[bucket]++;
+    histogram->total++;
+    histogram->failed += failed;
+    if (ns > histogram->max_ns) {
+        histogram->max_ns = ns;
+    }
+}
+
+// The upper end of the bucket holding the sample that per_thousand of the samples are not above
+static double workloadPercentile(WorkloadHistogram* histogram, int per_thousand) {
+    long rank = (histogram->total * per_thousand + 999) / 1000;
+    long seen = 0;
+    for (int bucket = 0; bucket < WORKLOAD_HISTOGRAM_BUCKETS; bucket++) {
+        seen += histogram->counts[bucket];
+        if (seen >= rank && seen > 0) {
+            int bits = bucket < 2 * WORKLOAD_HISTOGRAM_SUB_BUCKETS ? 0 : bucket / WORKLOAD_HISTOGRAM_SUB_BUCKETS - 1;
+            long first = bucket < 2 * WORKLOAD_HISTOGRAM_SUB_BUCKETS
+                         ? bucket : (long)(bucket % WORKLOAD_HISTOGRAM_SUB_BUCKETS + WORKLOAD_HISTOGRAM_SUB_BUCKETS);
+            double upper = (double)((first + 1) << bits) - 1;
+            return upper < histogram->max_ns ? upper : histogram->max_ns;
+        }
+    }
+
+    return histogram->max_ns;
+}
+
+static int workloadReplay(int argc, char* argv[]) {
+    if (argc < 3) {
+        fprintf(stdout, "Usage: workload_benchmark replay <trace file> [arena] [thread_safe]\n");
+        return 1;
+    }
+
+    int options = EM_OPTION_NONE;
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "arena") == 0) {
+            options |= EM_OPTION_ARENA;
+        } else if (strcmp(argv[i], "thread_safe") == 0) {
+            options |= EM_OPTION_THREAD_SAFE;
+        } else {
+            fprintf(stderr, "Invalid option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    Date start;
+    long count;
+    WorkloadCommand* commands = workloadReadTrace(argv[2], &start, &count);
+    if (commands == NULL) {
+        return 1;
+    }
+    EventManager em = createEventManagerWithOptions(start, options);
+    dateDestroy(start);
+    WorkloadHistogram* histograms = calloc(NUMBER_WORKLOAD_OPERATIONS, sizeof(*histograms));
+    if (em == NULL || histograms == NULL) {
+        fprintf(stderr, "Could not create the event manager\n");
+        destroyEventManager(em);
+        free(histograms);
+        workloadDestroyCommands(commands, count);
+        return 1;
+    }
+
+    long replayed = 0;
+    bool out_of_memory = false;
+    double replay_start = workloadNow();
+    for (; replayed < count; replayed++) {
+        double start_time = workloadNow();
+        EventManagerResult result = workloadApply(em, &commands[replayed]);
+        double end_time = workloadNow();
+        workloadRecord(&histograms[commands[replayed].operation], end_time - start_time, result != EM_SUCCESS);
+        if (result == EM_OUT_OF_MEMORY) {
+            // The event manager destroyed itself
+            fprintf(stderr, "Out of memory after %ld operations\n", replayed + 1);
+            em = NULL;
+            out_of_memory = true;
+            replayed++;
+            break;
+        }
+    }
+    double seconds = workloadNow() - replay_start;
+
+    printf("replay: trace=%s operations=%ld seconds=%.3f operations_per_second=%.0f events_left=%d\n", argv[2],
+           replayed, seconds, seconds > 0 ? replayed / seconds : 0, emGetEventsAmount(em));
+    for (int operation = 0; operation < NUMBER_WORKLOAD_OPERATIONS; operation++) {
+        WorkloadHistogram* histogram = &histograms[operation];
+        if (histogram->total == 0) {
+            continue;
+        }
+        printf("replay: operation=%s count=%ld failed=%ld p50_ns=%.0f p99_ns=%.0f p999_ns=%.0f max_ns=%.0f\n",
+               workloadOperationNames[operation], histogram->total, histogram->failed,
+               workloadPercentile(histogram, 500), workloadPercentile(histogram, 990),
+               workloadPercentile(histogram, 999), histogram->max_ns);
+    }
+
+    destroyEventManager(em);
+    free(histograms);
+    workloadDestroyCommands(commands, count);
+    return out_of_memory ? 1 : 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc >= 2 && strcmp(argv[1], "generate") == 0) {
+        return workloadGenerate(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "replay") == 0) {
+        return workloadReplay(argc, argv);
+    }
+
+    fprintf(stdout, "Usage: workload_benchmark generate <trace file> <operations> [<operation>=<weight> ...] "
+                    "[horizon=<days>] [seed=<n>]\n"
+                    "       workload_benchmark replay <trace file> [arena] [thread_safe]\n");
+    return 0;
+}